@@ -0,0 +1,271 @@
+/*
+  ==============================================================================
+
+    AudioExport.cpp
+    Created: 18 Oct 2026 1:24:51pm
+
+  ==============================================================================
+*/
+
+#include "AudioExport.h"
+#include "AudioKernels.h"
+
+//==============================================================================
+bool writeAudioFile (const File&           file,
+                     const float* const*   channels,
+                     const int             numChannels,
+                     const int             numSamples,
+                     const double          sampleRate,
+                     const AudioFileFormat format,
+                     const int             flacCompression,
+                     int64*                bytesWritten)
+{
+    if (numChannels <= 0 || numSamples <= 0)
+        return false;
+
+    WavAudioFormat wavFormat;
+    FlacAudioFormat flacFormat;
+    AudioFormat* audioFormat = &wavFormat;
+    int bitsPerSample = 16;
+    int qualityOption = 0;
+
+    switch (format)
+    {
+        case AudioFileFormat::wav16:      bitsPerSample = 16; break;
+        case AudioFileFormat::wav24:      bitsPerSample = 24; break;
+        case AudioFileFormat::wav32Float: bitsPerSample = 32; break;
+        case AudioFileFormat::flac16:
+        case AudioFileFormat::flac24:
+            audioFormat = &flacFormat;
+            bitsPerSample = format == AudioFileFormat::flac16 ? 16 : 24;
+            qualityOption = jlimit (0, 8, flacCompression);
+            break;
+    }
+
+    file.deleteFile();
+    ScopedPointer<FileOutputStream> stream (file.createOutputStream());
+
+    if (stream == nullptr)
+    {
+        std::cout << "writeAudioFile error: Couldn't open " <<
+                     file.getFullPathName() << " for writing." << std::endl;
+        return false;
+    }
+
+    ScopedPointer<AudioFormatWriter> writer (audioFormat->createWriterFor (stream,
+                                                                           sampleRate,
+                                                                           (unsigned int) numChannels,
+                                                                           bitsPerSample,
+                                                                           StringPairArray(),
+                                                                           qualityOption));
+    if (writer == nullptr)
+    {
+        std::cout << "writeAudioFile error: Couldn't create a " <<
+                     audioFormat->getFormatName() << " writer." << std::endl;
+        return false;
+    }
+
+    // The writer owns the stream now.
+    stream.release();
+
+    // Some writers walk the channel list until a null pointer.
+    const float* channelList[257] = {};
+    for (int i = 0; i < jmin (numChannels, 256); ++i)
+        channelList[i] = channels[i];
+
+    const bool success = writer->writeFromFloatArrays (channelList, numChannels, numSamples);
+
+    // Deleting the writer flushes the header and closes the file.
+    writer = nullptr;
+
+    if (success && bytesWritten != nullptr)
+        *bytesWritten = file.getSize();
+
+    return success;
+}
+
+//==============================================================================
+bool writeAudioFile (const File&           file,
+                     const RenderStorage&  render,
+                     const AudioFileFormat format,
+                     const int             flacCompression,
+                     int64*                bytesWritten)
+{
+    if (render.channelAudio.getNumChannels() > 0)
+        return writeAudioFile (file,
+                               render.channelAudio.getArrayOfReadPointers(),
+                               render.channelAudio.getNumChannels(),
+                               render.channelAudio.getNumSamples(),
+                               render.sampleRate,
+                               format,
+                               flacCompression,
+                               bytesWritten);
+
+    if (render.precision == AudioPrecision::doublePrecision)
+    {
+        const std::vector<double>& audio = render.processedMonoAudioPreview;
+        std::vector<float> narrowed (audio.size());
+        AudioKernels::convert (narrowed.data(), audio.data(), int (audio.size()));
+
+        const float* data = narrowed.data();
+        return writeAudioFile (file, &data, 1, int (narrowed.size()),
+                               render.sampleRate, format, flacCompression, bytesWritten);
+    }
+
+    const float* data = render.monoAudioFrames.data();
+    return writeAudioFile (file, &data, 1, int (render.monoAudioFrames.size()),
+                           render.sampleRate, format, flacCompression, bytesWritten);
+}
+
+//==============================================================================
+std::vector<int64> writeAudioFiles (const std::vector<const RenderStorage*>& renders,
+                                    const std::vector<std::string>&          paths,
+                                    const AudioFileFormat                    format,
+                                    const int                                flacCompression,
+                                    const int                                numThreads)
+{
+    std::vector<int64> bytesWritten (renders.size(), -1);
+
+    if (renders.size() != paths.size())
+    {
+        std::cout << "writeAudioFiles error: Got " << renders.size() <<
+                     " renders but " << paths.size() << " paths." << std::endl;
+        return bytesWritten;
+    }
+
+    if (renders.empty())
+        return bytesWritten;
+
+    const int threads = numThreads > 0 ? numThreads : SystemStats::getNumCpus();
+    ThreadPool pool (jmin (threads, int (renders.size())));
+
+    std::atomic<size_t> remaining (renders.size());
+    WaitableEvent finished;
+
+    for (size_t i = 0; i < renders.size(); ++i)
+    {
+        pool.addJob ([&, i]
+        {
+            int64 bytes = 0;
+            if (renders[i] != nullptr &&
+                writeAudioFile (File::getCurrentWorkingDirectory().getChildFile (String (paths[i])),
+                                *renders[i],
+                                format,
+                                flacCompression,
+                                &bytes))
+            {
+                bytesWritten[i] = bytes;
+            }
+
+            if (--remaining == 0)
+                finished.signal();
+        });
+    }
+
+    finished.wait();
+    return bytesWritten;
+}
+
+//==============================================================================
+BackgroundAudioWriter::BackgroundAudioWriter (const size_t          maxQueued,
+                                              const AudioFileFormat fileFormat,
+                                              const int             compression) :
+    maxQueuedRenders (jmax<size_t> (1, maxQueued)),
+    format (fileFormat),
+    flacCompression (compression),
+    jobsInFlight (0),
+    shouldExit (false),
+    numWritten (0),
+    numFailed (0)
+{
+    thread = std::thread (&BackgroundAudioWriter::run, this);
+}
+
+//==============================================================================
+BackgroundAudioWriter::~BackgroundAudioWriter()
+{
+    waitUntilFinished();
+    {
+        std::lock_guard<std::mutex> guard (lock);
+        shouldExit = true;
+    }
+    queueChanged.notify_all();
+    thread.join();
+}
+
+//==============================================================================
+void BackgroundAudioWriter::push (RenderResult&& result, const std::string& path)
+{
+    push (std::make_shared<RenderResult> (std::move (result)), path);
+}
+
+//==============================================================================
+void BackgroundAudioWriter::push (std::shared_ptr<RenderResult> result, const std::string& path)
+{
+    if (result == nullptr || ! result->isValid())
+    {
+        ++numFailed;
+        return;
+    }
+
+    std::unique_lock<std::mutex> guard (lock);
+    queueChanged.wait (guard, [this] { return jobs.size() < maxQueuedRenders; });
+    jobs.push_back ({ std::move (result), path });
+    guard.unlock();
+    queueChanged.notify_all();
+}
+
+//==============================================================================
+void BackgroundAudioWriter::waitUntilFinished()
+{
+    std::unique_lock<std::mutex> guard (lock);
+    queueChanged.wait (guard, [this] { return jobs.empty() && jobsInFlight == 0; });
+}
+
+//==============================================================================
+size_t BackgroundAudioWriter::getNumWritten() const
+{
+    return numWritten;
+}
+
+//==============================================================================
+size_t BackgroundAudioWriter::getNumFailed() const
+{
+    return numFailed;
+}
+
+//==============================================================================
+void BackgroundAudioWriter::run()
+{
+    for (;;)
+    {
+        Job job;
+        {
+            std::unique_lock<std::mutex> guard (lock);
+            queueChanged.wait (guard, [this] { return shouldExit || ! jobs.empty(); });
+
+            if (jobs.empty())
+                return;
+
+            job = std::move (jobs.front());
+            jobs.pop_front();
+            ++jobsInFlight;
+        }
+        queueChanged.notify_all();
+
+        const File file (File::getCurrentWorkingDirectory().getChildFile (String (job.path)));
+        if (writeAudioFile (file, **job.result, format, flacCompression))
+            ++numWritten;
+        else
+            ++numFailed;
+
+        // Hand the storage back to its engine's pool as soon as possible.
+        job.result.reset();
+
+        {
+            std::lock_guard<std::mutex> guard (lock);
+            --jobsInFlight;
+        }
+        queueChanged.notify_all();
+    }
+}
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    AudioExport.h
+    Created: 18 Oct 2026 1:24:51pm
+
+  ==============================================================================
+*/
+
+#ifndef AUDIOEXPORT_H_INCLUDED
+#define AUDIOEXPORT_H_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <string>
+#include <thread>
+#include "RenderResult.h"
+
+//==============================================================================
+enum class AudioFileFormat
+{
+    wav16,
+    wav24,
+    wav32Float,
+    flac16,
+    flac24
+};
+
+//==============================================================================
+/** Writes planar float audio to disk through a JUCE AudioFormatWriter. The
+    samples are converted once, in chunks, straight from the caller's buffers.
+    flacCompression is 0 (fastest) to 8 (smallest) and only used for FLAC.
+    On success the size of the written file is stored in bytesWritten.
+*/
+bool writeAudioFile (const File&         file,
+                     const float* const* channels,
+                     const int           numChannels,
+                     const int           numSamples,
+                     const double        sampleRate,
+                     const AudioFileFormat format,
+                     const int           flacCompression = 5,
+                     int64*              bytesWritten = nullptr);
+
+/** Writes a render's retained channels if it has any, otherwise its mono
+    mixdown. Double precision audio is narrowed to float first.
+*/
+bool writeAudioFile (const File&           file,
+                     const RenderStorage&  render,
+                     const AudioFileFormat format,
+                     const int             flacCompression = 5,
+                     int64*                bytesWritten = nullptr);
+
+/** Encodes a batch of renders in parallel on a thread pool, one file per
+    render. The returned vector holds the size in bytes of every written file,
+    or -1 where writing failed. numThreads <= 0 uses one thread per core.
+*/
+std::vector<int64> writeAudioFiles (const std::vector<const RenderStorage*>& renders,
+                                    const std::vector<std::string>&          paths,
+                                    const AudioFileFormat                    format = AudioFileFormat::flac16,
+                                    const int                                flacCompression = 5,
+                                    const int                                numThreads = 0);
+
+//==============================================================================
+/** Takes whole renders off a bounded queue and writes them on its own thread,
+    so rendering can carry on while the previous results are encoded. push()
+    blocks while the queue is full.
+*/
+class BackgroundAudioWriter
+{
+public:
+    BackgroundAudioWriter (const size_t          maxQueuedRenders,
+                           const AudioFileFormat format,
+                           const int             flacCompression = 5);
+
+    ~BackgroundAudioWriter();
+
+    void push (RenderResult&& result, const std::string& path);
+
+    void push (std::shared_ptr<RenderResult> result, const std::string& path);
+
+    void waitUntilFinished();
+
+    size_t getNumWritten() const;
+
+    size_t getNumFailed() const;
+
+private:
+    struct Job
+    {
+        std::shared_ptr<RenderResult> result;
+        std::string                   path;
+    };
+
+    void run();
+
+    const size_t            maxQueuedRenders;
+    const AudioFileFormat   format;
+    const int               flacCompression;
+    std::mutex              lock;
+    std::condition_variable queueChanged;
+    std::deque<Job>         jobs;
+    size_t                  jobsInFlight;
+    bool                    shouldExit;
+    std::atomic<size_t>     numWritten;
+    std::atomic<size_t>     numFailed;
+    std::thread             thread;
+};
+
+#endif  // AUDIOEXPORT_H_INCLUDED
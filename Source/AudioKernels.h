@@ -0,0 +1,236 @@
+/*
+  ==============================================================================
+
+    AudioKernels.h
+    Created: 18 Oct 2026 10:12:04am
+
+  ==============================================================================
+*/
+
+#ifndef AUDIOKERNELS_H_INCLUDED
+#define AUDIOKERNELS_H_INCLUDED
+
+#include "../JuceLibraryCode/JuceHeader.h"
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+using namespace juce;
+
+//==============================================================================
+/** Block kernels for the per-sample post processing of a render: channel
+    mixdown, sum of squares, peak and precision conversion. JUCE's
+    FloatVectorOperations are used where they cover the operation and SSE2
+    kernels fill in the gaps, with plain loops for other architectures.
+*/
+namespace AudioKernels
+{
+    //==========================================================================
+    inline void convert (float* dest, const float* src, int numValues) noexcept
+    {
+        FloatVectorOperations::copy (dest, src, numValues);
+    }
+
+    inline void convert (double* dest, const double* src, int numValues) noexcept
+    {
+        FloatVectorOperations::copy (dest, src, numValues);
+    }
+
+    inline void convert (double* dest, const float* src, int numValues) noexcept
+    {
+        int i = 0;
+       #if JUCE_INTEL
+        for (; i + 4 <= numValues; i += 4)
+        {
+            const __m128 v = _mm_loadu_ps (src + i);
+            _mm_storeu_pd (dest + i,     _mm_cvtps_pd (v));
+            _mm_storeu_pd (dest + i + 2, _mm_cvtps_pd (_mm_movehl_ps (v, v)));
+        }
+       #endif
+        for (; i < numValues; ++i)
+            dest[i] = src[i];
+    }
+
+    inline void convert (float* dest, const double* src, int numValues) noexcept
+    {
+        int i = 0;
+       #if JUCE_INTEL
+        for (; i + 4 <= numValues; i += 4)
+        {
+            const __m128 lo = _mm_cvtpd_ps (_mm_loadu_pd (src + i));
+            const __m128 hi = _mm_cvtpd_ps (_mm_loadu_pd (src + i + 2));
+            _mm_storeu_ps (dest + i, _mm_movelh_ps (lo, hi));
+        }
+       #endif
+        for (; i < numValues; ++i)
+            dest[i] = float (src[i]);
+    }
+
+    //==========================================================================
+    /** dest += src, widening to double on the way. */
+    inline void addConverted (double* dest, const float* src, int numValues) noexcept
+    {
+        int i = 0;
+       #if JUCE_INTEL
+        for (; i + 4 <= numValues; i += 4)
+        {
+            const __m128 v = _mm_loadu_ps (src + i);
+            _mm_storeu_pd (dest + i,     _mm_add_pd (_mm_loadu_pd (dest + i),     _mm_cvtps_pd (v)));
+            _mm_storeu_pd (dest + i + 2, _mm_add_pd (_mm_loadu_pd (dest + i + 2), _mm_cvtps_pd (_mm_movehl_ps (v, v))));
+        }
+       #endif
+        for (; i < numValues; ++i)
+            dest[i] += src[i];
+    }
+
+    //==========================================================================
+    /** Sum of the squared samples, always accumulated in double precision so
+        long renders don't lose their quiet tails.
+    */
+    inline double sumOfSquares (const float* src, int numValues) noexcept
+    {
+        int i = 0;
+        double sum = 0.0;
+       #if JUCE_INTEL
+        __m128d accumulatorA = _mm_setzero_pd();
+        __m128d accumulatorB = _mm_setzero_pd();
+        for (; i + 4 <= numValues; i += 4)
+        {
+            const __m128 v = _mm_loadu_ps (src + i);
+            const __m128d lo = _mm_cvtps_pd (v);
+            const __m128d hi = _mm_cvtps_pd (_mm_movehl_ps (v, v));
+            accumulatorA = _mm_add_pd (accumulatorA, _mm_mul_pd (lo, lo));
+            accumulatorB = _mm_add_pd (accumulatorB, _mm_mul_pd (hi, hi));
+        }
+        double lanes[2];
+        _mm_storeu_pd (lanes, _mm_add_pd (accumulatorA, accumulatorB));
+        sum = lanes[0] + lanes[1];
+       #endif
+        for (; i < numValues; ++i)
+            sum += double (src[i]) * src[i];
+        return sum;
+    }
+
+    inline double sumOfSquares (const double* src, int numValues) noexcept
+    {
+        int i = 0;
+        double sum = 0.0;
+       #if JUCE_INTEL
+        __m128d accumulatorA = _mm_setzero_pd();
+        __m128d accumulatorB = _mm_setzero_pd();
+        for (; i + 4 <= numValues; i += 4)
+        {
+            const __m128d lo = _mm_loadu_pd (src + i);
+            const __m128d hi = _mm_loadu_pd (src + i + 2);
+            accumulatorA = _mm_add_pd (accumulatorA, _mm_mul_pd (lo, lo));
+            accumulatorB = _mm_add_pd (accumulatorB, _mm_mul_pd (hi, hi));
+        }
+        double lanes[2];
+        _mm_storeu_pd (lanes, _mm_add_pd (accumulatorA, accumulatorB));
+        sum = lanes[0] + lanes[1];
+       #endif
+        for (; i < numValues; ++i)
+            sum += src[i] * src[i];
+        return sum;
+    }
+
+    //==========================================================================
+    template <typename SampleType>
+    inline SampleType getPeak (const SampleType* src, int numValues) noexcept
+    {
+        if (numValues <= 0)
+            return SampleType();
+
+        const auto range = FloatVectorOperations::findMinAndMax (src, numValues);
+        return jmax (-range.getStart(), range.getEnd());
+    }
+
+    //==========================================================================
+    /** Averages the channels of a block into one, specialised at compile time
+        for mono and stereo plugins. NumChannels == 0 handles any count.
+    */
+    template <int NumChannels>
+    struct Mixdown
+    {
+        static void process (float* dest, const float* const* src, int numChannels, int numValues) noexcept
+        {
+            FloatVectorOperations::copy (dest, src[0], numValues);
+            for (int channel = 1; channel < numChannels; ++channel)
+                FloatVectorOperations::add (dest, src[channel], numValues);
+            FloatVectorOperations::multiply (dest, 1.0f / numChannels, numValues);
+        }
+
+        static void process (double* dest, const float* const* src, int numChannels, int numValues) noexcept
+        {
+            convert (dest, src[0], numValues);
+            for (int channel = 1; channel < numChannels; ++channel)
+                addConverted (dest, src[channel], numValues);
+            FloatVectorOperations::multiply (dest, 1.0 / numChannels, numValues);
+        }
+    };
+
+    template <>
+    struct Mixdown<1>
+    {
+        template <typename SampleType>
+        static void process (SampleType* dest, const float* const* src, int, int numValues) noexcept
+        {
+            convert (dest, src[0], numValues);
+        }
+    };
+
+    template <>
+    struct Mixdown<2>
+    {
+        static void process (float* dest, const float* const* src, int, int numValues) noexcept
+        {
+            const float* left = src[0];
+            const float* right = src[1];
+            int i = 0;
+           #if JUCE_INTEL
+            const __m128 half = _mm_set1_ps (0.5f);
+            for (; i + 4 <= numValues; i += 4)
+                _mm_storeu_ps (dest + i, _mm_mul_ps (_mm_add_ps (_mm_loadu_ps (left + i),
+                                                                 _mm_loadu_ps (right + i)),
+                                                     half));
+           #endif
+            for (; i < numValues; ++i)
+                dest[i] = (left[i] + right[i]) * 0.5f;
+        }
+
+        static void process (double* dest, const float* const* src, int, int numValues) noexcept
+        {
+            const float* left = src[0];
+            const float* right = src[1];
+            int i = 0;
+           #if JUCE_INTEL
+            const __m128d half = _mm_set1_pd (0.5);
+            for (; i + 4 <= numValues; i += 4)
+            {
+                const __m128 l = _mm_loadu_ps (left + i);
+                const __m128 r = _mm_loadu_ps (right + i);
+                _mm_storeu_pd (dest + i,     _mm_mul_pd (_mm_add_pd (_mm_cvtps_pd (l), _mm_cvtps_pd (r)), half));
+                _mm_storeu_pd (dest + i + 2, _mm_mul_pd (_mm_add_pd (_mm_cvtps_pd (_mm_movehl_ps (l, l)),
+                                                                     _mm_cvtps_pd (_mm_movehl_ps (r, r))), half));
+            }
+           #endif
+            for (; i < numValues; ++i)
+                dest[i] = (double (left[i]) + right[i]) * 0.5;
+        }
+    };
+
+    template <typename SampleType>
+    inline void mixdown (SampleType* dest, const float* const* src, int numChannels, int numValues) noexcept
+    {
+        switch (numChannels)
+        {
+            case 0:  FloatVectorOperations::clear (dest, numValues); break;
+            case 1:  Mixdown<1>::process (dest, src, numChannels, numValues); break;
+            case 2:  Mixdown<2>::process (dest, src, numChannels, numValues); break;
+            default: Mixdown<0>::process (dest, src, numChannels, numValues); break;
+        }
+    }
+}
+
+#endif  // AUDIOKERNELS_H_INCLUDED
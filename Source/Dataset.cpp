@@ -0,0 +1,649 @@
+/*
+  ==============================================================================
+
+    Dataset.cpp
+    Created: 18 Oct 2026 3:10:42pm
+
+  ==============================================================================
+*/
+
+#include "Dataset.h"
+
+#if JUCE_WINDOWS
+ #include <io.h>
+ #include <fcntl.h>
+#else
+ #include <fcntl.h>
+ #include <unistd.h>
+#endif
+
+static const char datasetMagic[8] = { 'R', 'M', 'S', 'H', 'A', 'R', 'D', '1' };
+
+//==============================================================================
+static uint64 alignOffset (const uint64 offset)
+{
+    const uint64 alignment = DatasetShardHeader::alignment;
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+//==============================================================================
+/** True if the column starts on an aligned offset past the header and its
+    numRows rows of valuesPerRow values end inside the file.
+*/
+static bool isColumnInside (const DatasetShardHeader& header, const uint64 offset,
+                            const uint64 numRows, const uint64 valuesPerRow,
+                            const uint64 valueSize)
+{
+    if (offset % DatasetShardHeader::alignment != 0
+         || offset < header.headerSize
+         || offset > header.fileSize)
+        return false;
+
+    // Dividing the space down avoids overflowing on a corrupt shape.
+    const uint64 space = header.fileSize - offset;
+    return numRows == 0 || valuesPerRow == 0
+            || space / valueSize / valuesPerRow >= numRows;
+}
+
+/** Checks a mapped header against the size of its mapping before any of its
+    columns are handed out.
+*/
+static bool isValidShard (const DatasetShardHeader* header, const size_t mappedSize)
+{
+    if (header == nullptr
+         || mappedSize < sizeof (DatasetShardHeader)
+         || memcmp (header->magic, datasetMagic, sizeof (datasetMagic)) != 0
+         || header->version != DatasetShardHeader::currentVersion
+         || header->headerSize != sizeof (DatasetShardHeader)
+         || header->fileSize != mappedSize)
+        return false;
+
+    const uint64 numRecords = header->numRecords;
+    const uint64 mfccRowSize = uint64 (header->numMfccFrames) * header->numMfccCoefficients;
+
+    return isColumnInside (*header, header->recordIdsOffset,        numRecords, 1,                        sizeof (uint64))
+        && isColumnInside (*header, header->parameterIndicesOffset, 1,          header->numParameters,    sizeof (uint32))
+        && isColumnInside (*header, header->patchesOffset,          numRecords, header->numParameters,    sizeof (float))
+        && isColumnInside (*header, header->audioOffset,            numRecords, header->numSamples,       sizeof (float))
+        && isColumnInside (*header, header->mfccOffset,             numRecords, mfccRowSize,              sizeof (float))
+        && isColumnInside (*header, header->rmsOffset,              numRecords, header->numRmsFrames,     sizeof (float));
+}
+
+//==============================================================================
+template<typename T>
+static void copyPadded (float* dest, const T* source, const size_t numSource, const size_t numDest)
+{
+    const size_t numToCopy = jmin (numSource, numDest);
+    AudioKernels::convert (dest, source, int (numToCopy));
+
+    if (numToCopy < numDest)
+        FloatVectorOperations::clear (dest + numToCopy, int (numDest - numToCopy));
+}
+
+static void copyPadded (float* dest, const float* source, const size_t numSource, const size_t numDest)
+{
+    const size_t numToCopy = jmin (numSource, numDest);
+    FloatVectorOperations::copy (dest, source, int (numToCopy));
+
+    if (numToCopy < numDest)
+        FloatVectorOperations::clear (dest + numToCopy, int (numDest - numToCopy));
+}
+
+//==============================================================================
+bool syncFileToDisk (const File& file)
+{
+   #if JUCE_WINDOWS
+    // Directory entries are made durable by NTFS itself.
+    if (file.isDirectory())
+        return true;
+
+    const int fd = _wopen (file.getFullPathName().toWideCharPointer(), _O_RDWR | _O_BINARY);
+    if (fd < 0)
+        return false;
+
+    const bool success = _commit (fd) == 0;
+    _close (fd);
+    return success;
+   #else
+    const int fd = open (file.getFullPathName().toRawUTF8(), file.isDirectory() ? O_RDONLY : O_RDWR);
+    if (fd < 0)
+        return false;
+
+    const bool success = fsync (fd) == 0;
+    close (fd);
+    return success;
+   #endif
+}
+
+//==============================================================================
+DatasetWriter::DatasetWriter (const std::string& directoryPath,
+                              const std::string& filePrefix,
+                              const size_t       shardSize,
+                              const size_t       maxQueued) :
+    directory (File::getCurrentWorkingDirectory().getChildFile (String (directoryPath))),
+    prefix (filePrefix),
+    recordsPerShard (jmax<size_t> (1, shardSize)),
+    maxQueuedRecords (jmax<size_t> (1, maxQueued)),
+    hasShape (false),
+    nextShardNumber (0),
+    recordsInFlight (0),
+    shouldExit (false),
+    numRecordsWritten (0),
+    numShardsWritten (0),
+    numDuplicatesRejected (0)
+{
+    zerostruct (shape);
+
+    if (! directory.createDirectory())
+        std::cout << "DatasetWriter error: Couldn't create " <<
+                     directory.getFullPathName() << "." << std::endl;
+
+    // Temporary files are shards that were being written when a previous
+    // run died, they are incomplete by definition.
+    Array<File> leftovers;
+    directory.findChildFiles (leftovers, File::findFiles, false,
+                              prefix + "-*" + getShardExtension() + ".tmp");
+    for (auto& file : leftovers)
+        if (getShardNumber (file.getFileName().dropLastCharacters (4), prefix) >= 0)
+            file.deleteFile();
+
+    nextShardNumber = findNextShardNumber();
+    thread = std::thread (&DatasetWriter::run, this);
+}
+
+//==============================================================================
+DatasetWriter::~DatasetWriter()
+{
+    flush();
+    {
+        std::lock_guard<std::mutex> guard (lock);
+        shouldExit = true;
+    }
+    queueChanged.notify_all();
+    thread.join();
+}
+
+//==============================================================================
+String DatasetWriter::getShardExtension()
+{
+    return ".rmshard";
+}
+
+int DatasetWriter::getShardNumber (const String& fileName, const String& prefix)
+{
+    const String start = prefix + "-";
+    if (! fileName.startsWith (start) || ! fileName.endsWith (getShardExtension()))
+        return -1;
+
+    const String number = fileName.substring (start.length(), fileName.length() - getShardExtension().length());
+    return number.isNotEmpty() && number.containsOnly ("0123456789") ? number.getIntValue() : -1;
+}
+
+uint64 DatasetWriter::getStoredFingerprint (const RenderStorage& render)
+{
+    const size_t numCoefficients = std::tuple_size<MFCCFeatures::value_type>::value;
+    std::vector<float> frames (render.mfccFeatures.size() * numCoefficients);
+
+    if (! frames.empty())
+        AudioKernels::convert (frames.data(), render.mfccFeatures[0].data(), int (frames.size()));
+
+    return Fingerprint::compute (FeatureSequence<float> (frames.data(), render.mfccFeatures.size(), numCoefficients));
+}
+
+//==============================================================================
+bool DatasetWriter::add (const uint64       recordId,
+                         const PluginPatch& patch,
+                         RenderResult&&     result)
+{
+    return add (recordId, patch, std::make_shared<RenderResult> (std::move (result)));
+}
+
+//==============================================================================
+bool DatasetWriter::add (const uint64                  recordId,
+                         const PluginPatch&            patch,
+                         std::shared_ptr<RenderResult> result)
+{
+    if (result == nullptr || ! result->isValid())
+    {
+        std::cout << "DatasetWriter::add error: Record " << recordId <<
+                     " has no render." << std::endl;
+        return false;
+    }
+
+    std::shared_ptr<DuplicateFilter> filter;
+    {
+        std::lock_guard<std::mutex> guard (lock);
+        filter = duplicateFilter;
+    }
+
+    if (filter != nullptr && ! filter->insertIfUnique (getStoredFingerprint (**result)))
+    {
+        ++numDuplicatesRejected;
+        return false;
+    }
+
+    push ({ recordId, patch, std::move (result), false });
+    return true;
+}
+
+//==============================================================================
+void DatasetWriter::flush()
+{
+    push ({ 0, PluginPatch(), nullptr, true });
+
+    std::unique_lock<std::mutex> guard (lock);
+    queueChanged.wait (guard, [this] { return queue.empty() && recordsInFlight == 0; });
+}
+
+//==============================================================================
+void DatasetWriter::setShardCallback (const ShardCallback& callback)
+{
+    std::lock_guard<std::mutex> guard (lock);
+    shardCallback = callback;
+}
+
+//==============================================================================
+void DatasetWriter::setDuplicateFilter (std::shared_ptr<DuplicateFilter> filter)
+{
+    std::lock_guard<std::mutex> guard (lock);
+    duplicateFilter = std::move (filter);
+}
+
+//==============================================================================
+size_t DatasetWriter::getNumDuplicatesRejected() const
+{
+    return numDuplicatesRejected;
+}
+
+//==============================================================================
+size_t DatasetWriter::getNumRecordsWritten() const
+{
+    return numRecordsWritten;
+}
+
+//==============================================================================
+size_t DatasetWriter::getNumShardsWritten() const
+{
+    return numShardsWritten;
+}
+
+//==============================================================================
+void DatasetWriter::push (Record&& record)
+{
+    std::unique_lock<std::mutex> guard (lock);
+    queueChanged.wait (guard, [this] { return queue.size() < maxQueuedRecords; });
+    queue.push_back (std::move (record));
+    guard.unlock();
+    queueChanged.notify_all();
+}
+
+//==============================================================================
+void DatasetWriter::run()
+{
+    for (;;)
+    {
+        Record record;
+        {
+            std::unique_lock<std::mutex> guard (lock);
+            queueChanged.wait (guard, [this] { return shouldExit || ! queue.empty(); });
+
+            if (queue.empty())
+                return;
+
+            record = std::move (queue.front());
+            queue.pop_front();
+            ++recordsInFlight;
+        }
+        queueChanged.notify_all();
+
+        if (record.isFlush)
+        {
+            if (! recordIds.empty())
+                writeShard();
+        }
+        else
+        {
+            append (record);
+
+            // Hand the storage back to its engine before the slow part.
+            record.result.reset();
+
+            if (recordIds.size() >= recordsPerShard)
+                writeShard();
+        }
+
+        {
+            std::lock_guard<std::mutex> guard (lock);
+            --recordsInFlight;
+        }
+        queueChanged.notify_all();
+    }
+}
+
+//==============================================================================
+void DatasetWriter::append (const Record& record)
+{
+    const RenderStorage& render = **record.result;
+
+    if (! hasShape)
+    {
+        shape.numParameters       = uint32 (record.patch.size());
+        shape.numSamples          = uint32 (render.getNumSamples());
+        shape.numMfccFrames       = uint32 (render.mfccFeatures.size());
+        shape.numMfccCoefficients = 13;
+        shape.numRmsFrames        = uint32 (render.rmsFrames.size());
+        shape.sampleRate          = uint32 (render.sampleRate);
+
+        parameterIndices.clear();
+        for (const auto& parameter : record.patch)
+            parameterIndices.push_back (uint32 (parameter.first));
+
+        hasShape = true;
+    }
+
+    const size_t row = recordIds.size();
+    recordIds.push_back (record.id);
+
+    patches.resize ((row + 1) * shape.numParameters);
+    float* patchRow = patches.data() + row * shape.numParameters;
+    for (size_t i = 0; i < shape.numParameters; ++i)
+        patchRow[i] = i < record.patch.size() ? record.patch[i].second : 0.0f;
+
+    audio.resize ((row + 1) * shape.numSamples);
+    float* audioRow = audio.data() + row * shape.numSamples;
+    if (render.precision == AudioPrecision::doublePrecision)
+        copyPadded (audioRow, render.processedMonoAudioPreview.data(),
+                    render.processedMonoAudioPreview.size(), shape.numSamples);
+    else
+        copyPadded (audioRow, render.monoAudioFrames.data(),
+                    render.monoAudioFrames.size(), shape.numSamples);
+
+    const size_t mfccRowSize = size_t (shape.numMfccFrames) * shape.numMfccCoefficients;
+    mfcc.resize ((row + 1) * mfccRowSize);
+    copyPadded (mfcc.data() + row * mfccRowSize,
+                render.mfccFeatures.empty() ? nullptr : render.mfccFeatures[0].data(),
+                render.mfccFeatures.size() * shape.numMfccCoefficients,
+                mfccRowSize);
+
+    rms.resize ((row + 1) * shape.numRmsFrames);
+    copyPadded (rms.data() + row * shape.numRmsFrames,
+                render.rmsFrames.data(), render.rmsFrames.size(), shape.numRmsFrames);
+}
+
+//==============================================================================
+// Shards are little endian on every machine, nothing to do on the little
+// endian ones.
+static DatasetShardHeader toLittleEndian (DatasetShardHeader header)
+{
+   #if JUCE_BIG_ENDIAN
+    header.version                = ByteOrder::swap (header.version);
+    header.headerSize             = ByteOrder::swap (header.headerSize);
+    header.numRecords             = ByteOrder::swap (header.numRecords);
+    header.numParameters          = ByteOrder::swap (header.numParameters);
+    header.numSamples             = ByteOrder::swap (header.numSamples);
+    header.numMfccFrames          = ByteOrder::swap (header.numMfccFrames);
+    header.numMfccCoefficients    = ByteOrder::swap (header.numMfccCoefficients);
+    header.numRmsFrames           = ByteOrder::swap (header.numRmsFrames);
+    header.sampleRate             = ByteOrder::swap (header.sampleRate);
+    header.recordIdsOffset        = ByteOrder::swap (header.recordIdsOffset);
+    header.parameterIndicesOffset = ByteOrder::swap (header.parameterIndicesOffset);
+    header.patchesOffset          = ByteOrder::swap (header.patchesOffset);
+    header.audioOffset            = ByteOrder::swap (header.audioOffset);
+    header.mfccOffset             = ByteOrder::swap (header.mfccOffset);
+    header.rmsOffset              = ByteOrder::swap (header.rmsOffset);
+    header.fileSize               = ByteOrder::swap (header.fileSize);
+   #endif
+    return header;
+}
+
+static bool writeLittleEndian (OutputStream& stream,
+                               const void*   data,
+                               const size_t  numBytes,
+                               const size_t  valueSize)
+{
+   #if JUCE_BIG_ENDIAN
+    const char* bytes = static_cast<const char*> (data);
+    char swapped[8];
+    for (size_t i = 0; i < numBytes; i += valueSize)
+    {
+        std::reverse_copy (bytes + i, bytes + i + valueSize, swapped);
+        if (! stream.write (swapped, valueSize))
+            return false;
+    }
+    return true;
+   #else
+    ignoreUnused (valueSize);
+    return stream.write (data, numBytes);
+   #endif
+}
+
+//==============================================================================
+bool DatasetWriter::writeShard()
+{
+    DatasetShardHeader header = shape;
+    memcpy (header.magic, datasetMagic, sizeof (header.magic));
+    header.version    = DatasetShardHeader::currentVersion;
+    header.headerSize = uint32 (sizeof (DatasetShardHeader));
+    header.numRecords = recordIds.size();
+
+    struct Column
+    {
+        uint64*     offset;
+        const void* data;
+        size_t      numBytes;
+        size_t      valueSize;
+    };
+
+    const Column columns[] =
+    {
+        { &header.recordIdsOffset,        recordIds.data(),        recordIds.size() * sizeof (uint64),        sizeof (uint64) },
+        { &header.parameterIndicesOffset, parameterIndices.data(), parameterIndices.size() * sizeof (uint32), sizeof (uint32) },
+        { &header.patchesOffset,          patches.data(),          patches.size() * sizeof (float),           sizeof (float) },
+        { &header.audioOffset,            audio.data(),            audio.size() * sizeof (float),             sizeof (float) },
+        { &header.mfccOffset,             mfcc.data(),             mfcc.size() * sizeof (float),              sizeof (float) },
+        { &header.rmsOffset,              rms.data(),              rms.size() * sizeof (float),               sizeof (float) }
+    };
+
+    uint64 position = sizeof (DatasetShardHeader);
+    for (const auto& column : columns)
+    {
+        *column.offset = alignOffset (position);
+        position = *column.offset + column.numBytes;
+    }
+    header.fileSize = position;
+
+    const String name = prefix + "-" + String (nextShardNumber).paddedLeft ('0', 6) + getShardExtension();
+    const File shardFile = directory.getChildFile (name);
+    const File tempFile = directory.getChildFile (name + ".tmp");
+
+    bool success = false;
+    {
+        tempFile.deleteFile();
+        FileOutputStream stream (tempFile);
+
+        if (stream.openedOk())
+        {
+            const DatasetShardHeader storedHeader = toLittleEndian (header);
+            success = stream.write (&storedHeader, sizeof (storedHeader));
+
+            for (const auto& column : columns)
+            {
+                const int64 padding = int64 (*column.offset) - stream.getPosition();
+                success = success && stream.writeRepeatedByte (0, size_t (padding))
+                                  && writeLittleEndian (stream, column.data, column.numBytes, column.valueSize);
+            }
+
+            stream.flush();
+            success = success && stream.getStatus().wasOk();
+        }
+    }
+
+    // The data has to be on disk before the rename, and the rename before
+    // anyone is told about the shard, or a crash could leave a complete
+    // looking shard with garbage in it.
+    if (success)
+        success = syncFileToDisk (tempFile)
+                   && tempFile.moveFileTo (shardFile)
+                   && syncFileToDisk (directory);
+
+    if (! success)
+    {
+        std::cout << "DatasetWriter error: Couldn't write " <<
+                     shardFile.getFullPathName() << ", dropping " <<
+                     recordIds.size() << " records." << std::endl;
+        tempFile.deleteFile();
+    }
+    else
+    {
+        ++nextShardNumber;
+        numRecordsWritten += recordIds.size();
+        ++numShardsWritten;
+
+        ShardCallback callback;
+        {
+            std::lock_guard<std::mutex> guard (lock);
+            callback = shardCallback;
+        }
+        if (callback != nullptr)
+            callback (shardFile, recordIds);
+    }
+
+    // Keep the capacity for the next shard.
+    recordIds.clear();
+    patches.clear();
+    audio.clear();
+    mfcc.clear();
+    rms.clear();
+    return success;
+}
+
+//==============================================================================
+int DatasetWriter::findNextShardNumber() const
+{
+    Array<File> existing;
+    directory.findChildFiles (existing, File::findFiles, false,
+                              prefix + "-*" + getShardExtension());
+
+    int next = 0;
+    for (auto& file : existing)
+        next = jmax (next, getShardNumber (file.getFileName(), prefix) + 1);
+    return next;
+}
+
+//==============================================================================
+DatasetReader::DatasetReader (const std::string& directoryPath,
+                              const std::string& prefix)
+{
+    const File directory (File::getCurrentWorkingDirectory().getChildFile (String (directoryPath)));
+
+    // The shards are handed out as they are mapped, without swapping.
+    if (ByteOrder::isBigEndian())
+    {
+        std::cout << "DatasetReader error: Shards are little endian, " <<
+                     "they can't be read on this machine." << std::endl;
+        return;
+    }
+
+    Array<File> files;
+    directory.findChildFiles (files, File::findFiles, false,
+                              String (prefix) + "*" + DatasetWriter::getShardExtension());
+
+    // The glob also matches writers whose prefix only starts with this one.
+    if (! prefix.empty())
+        files.removeIf ([&prefix] (const File& file)
+        {
+            return DatasetWriter::getShardNumber (file.getFileName(), String (prefix)) < 0;
+        });
+
+    // Shards are numbered, sorting by name keeps them in the order written.
+    std::sort (files.begin(), files.end(), [] (const File& a, const File& b)
+    {
+        return a.getFileName() < b.getFileName();
+    });
+
+    for (auto& file : files)
+    {
+        Shard shard;
+        shard.file = file;
+        shard.map.reset (new MemoryMappedFile (file, MemoryMappedFile::readOnly));
+
+        const size_t mappedSize = shard.map->getSize();
+        shard.header = static_cast<const DatasetShardHeader*> (shard.map->getData());
+
+        if (! isValidShard (shard.header, mappedSize))
+        {
+            std::cout << "DatasetReader error: Skipping " << file.getFullPathName() <<
+                         ", it isn't a complete shard." << std::endl;
+            continue;
+        }
+
+        shards.push_back (std::move (shard));
+    }
+}
+
+//==============================================================================
+size_t DatasetReader::getNumShards() const
+{
+    return shards.size();
+}
+
+//==============================================================================
+uint64 DatasetReader::getNumRecords() const
+{
+    uint64 numRecords = 0;
+    for (const auto& shard : shards)
+        numRecords += shard.header->numRecords;
+    return numRecords;
+}
+
+//==============================================================================
+const DatasetShardHeader& DatasetReader::getHeader (const size_t shard) const
+{
+    jassert (shard < shards.size());
+    return *shards[shard].header;
+}
+
+//==============================================================================
+File DatasetReader::getShardFile (const size_t shard) const
+{
+    jassert (shard < shards.size());
+    return shards[shard].file;
+}
+
+//==============================================================================
+const char* DatasetReader::getData (const size_t shard, const uint64 offset) const
+{
+    jassert (shard < shards.size());
+    return static_cast<const char*> (shards[shard].map->getData()) + offset;
+}
+
+//==============================================================================
+const uint64* DatasetReader::getRecordIds (const size_t shard) const
+{
+    return reinterpret_cast<const uint64*> (getData (shard, getHeader (shard).recordIdsOffset));
+}
+
+const uint32* DatasetReader::getParameterIndices (const size_t shard) const
+{
+    return reinterpret_cast<const uint32*> (getData (shard, getHeader (shard).parameterIndicesOffset));
+}
+
+const float* DatasetReader::getPatches (const size_t shard) const
+{
+    return reinterpret_cast<const float*> (getData (shard, getHeader (shard).patchesOffset));
+}
+
+const float* DatasetReader::getAudio (const size_t shard) const
+{
+    return reinterpret_cast<const float*> (getData (shard, getHeader (shard).audioOffset));
+}
+
+const float* DatasetReader::getMfcc (const size_t shard) const
+{
+    return reinterpret_cast<const float*> (getData (shard, getHeader (shard).mfccOffset));
+}
+
+const float* DatasetReader::getRms (const size_t shard) const
+{
+    return reinterpret_cast<const float*> (getData (shard, getHeader (shard).rmsOffset));
+}
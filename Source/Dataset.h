@@ -0,0 +1,222 @@
+/*
+  ==============================================================================
+
+    Dataset.h
+    Created: 18 Oct 2026 3:10:42pm
+
+  ==============================================================================
+*/
+
+#ifndef DATASET_H_INCLUDED
+#define DATASET_H_INCLUDED
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <thread>
+#include "RenderEngine.h"
+#include "Fingerprint.h"
+
+//==============================================================================
+/** On-disk layout of one shard. Every array is columnar, little endian and
+    starts on a 64 byte boundary so it can be handed out straight from a
+    memory map:
+
+        DatasetShardHeader
+        uint64  recordIds           [numRecords]
+        uint32  parameterIndices    [numParameters]
+        float32 patches             [numRecords, numParameters]
+        float32 audio               [numRecords, numSamples]
+        float32 mfcc                [numRecords, numMfccFrames, 13]
+        float32 rms                 [numRecords, numRmsFrames]
+
+    Renders shorter than the shard's shape are zero padded, longer ones are
+    truncated.
+
+    Big endian machines swap everything into little endian order as they
+    write. The reader hands out the mapped arrays as they are, so it only
+    reads shards on little endian machines.
+*/
+struct DatasetShardHeader
+{
+    static const uint32 currentVersion = 1;
+    static const size_t alignment = 64;
+
+    char   magic[8];
+    uint32 version;
+    uint32 headerSize;
+    uint64 numRecords;
+    uint32 numParameters;
+    uint32 numSamples;
+    uint32 numMfccFrames;
+    uint32 numMfccCoefficients;
+    uint32 numRmsFrames;
+    uint32 sampleRate;
+    uint64 recordIdsOffset;
+    uint64 parameterIndicesOffset;
+    uint64 patchesOffset;
+    uint64 audioOffset;
+    uint64 mfccOffset;
+    uint64 rmsOffset;
+    uint64 fileSize;
+};
+
+//==============================================================================
+/** Accumulates rendered records into fixed-size shards and writes each full
+    shard on a background thread. A shard is written under a temporary name,
+    synced and renamed once complete, so a directory never holds a half
+    written shard.
+
+    The shape of the records is taken from the first one added. Shards are
+    named <prefix>-000000.rmshard upwards, continuing after any shards with the
+    same prefix already in the directory.
+*/
+class DatasetWriter
+{
+public:
+    /** Called on the writer thread after a shard has been renamed into place,
+        with the shard and the ids of the records it holds.
+    */
+    typedef std::function<void (const File&, const std::vector<uint64>&)> ShardCallback;
+
+    DatasetWriter (const std::string& directory,
+                   const std::string& prefix,
+                   const size_t       recordsPerShard,
+                   const size_t       maxQueuedRecords = 256);
+
+    ~DatasetWriter();
+
+    /** Queues a record, blocking while the queue is full. The result's storage
+        goes back to its engine as soon as it has been copied into the shard.
+        Returns false if the record was dropped, because it has no render or
+        the duplicate filter rejected it.
+    */
+    bool add (const uint64       recordId,
+              const PluginPatch& patch,
+              RenderResult&&     result);
+
+    bool add (const uint64                  recordId,
+              const PluginPatch&            patch,
+              std::shared_ptr<RenderResult> result);
+
+    /** Drops every record whose fingerprint is a near duplicate of one added
+        before, before it is queued. The filter may be shared with other
+        writers, or be prefilled from an earlier dataset.
+    */
+    void setDuplicateFilter (std::shared_ptr<DuplicateFilter> filter);
+
+    size_t getNumDuplicatesRejected() const;
+
+    /** Writes out everything queued so far, including a final partial shard. */
+    void flush();
+
+    void setShardCallback (const ShardCallback& callback);
+
+    size_t getNumRecordsWritten() const;
+
+    size_t getNumShardsWritten() const;
+
+    static String getShardExtension();
+
+    /** The number of a shard this prefix's writer wrote, from its file name,
+        or -1 for any other file. Another writer's prefix may start with this
+        one, so only <prefix>-<digits><extension> counts.
+    */
+    static int getShardNumber (const String& fileName, const String& prefix);
+
+    /** The fingerprint of a render's MFCC frames narrowed to floats, the way
+        a shard stores them, so it matches one computed from a DatasetReader.
+    */
+    static uint64 getStoredFingerprint (const RenderStorage& render);
+
+private:
+    struct Record
+    {
+        uint64                        id;
+        PluginPatch                   patch;
+        std::shared_ptr<RenderResult> result;
+        bool                          isFlush;
+    };
+
+    void push (Record&& record);
+    void run();
+    void append (const Record& record);
+    bool writeShard();
+    int  findNextShardNumber() const;
+
+    const File              directory;
+    const String            prefix;
+    const size_t            recordsPerShard;
+    const size_t            maxQueuedRecords;
+
+    // Shard being filled, only touched by the writer thread.
+    DatasetShardHeader      shape;
+    bool                    hasShape;
+    int                     nextShardNumber;
+    std::vector<uint64>     recordIds;
+    std::vector<uint32>     parameterIndices;
+    std::vector<float>      patches;
+    std::vector<float>      audio;
+    std::vector<float>      mfcc;
+    std::vector<float>      rms;
+    ShardCallback           shardCallback;
+    std::shared_ptr<DuplicateFilter> duplicateFilter;
+
+    std::mutex              lock;
+    std::condition_variable queueChanged;
+    std::deque<Record>      queue;
+    size_t                  recordsInFlight;
+    bool                    shouldExit;
+    std::atomic<size_t>     numRecordsWritten;
+    std::atomic<size_t>     numShardsWritten;
+    std::atomic<size_t>     numDuplicatesRejected;
+    std::thread             thread;
+};
+
+//==============================================================================
+/** Memory maps every shard in a directory. The accessors point straight into
+    the maps and stay valid for as long as the reader is alive.
+*/
+class DatasetReader
+{
+public:
+    /** Opens all shards in the directory, or only those a DatasetWriter with
+        this prefix wrote.
+    */
+    DatasetReader (const std::string& directory,
+                   const std::string& prefix = std::string());
+
+    size_t getNumShards() const;
+
+    uint64 getNumRecords() const;
+
+    const DatasetShardHeader& getHeader (const size_t shard) const;
+
+    File getShardFile (const size_t shard) const;
+
+    const uint64* getRecordIds (const size_t shard) const;
+    const uint32* getParameterIndices (const size_t shard) const;
+    const float*  getPatches (const size_t shard) const;
+    const float*  getAudio (const size_t shard) const;
+    const float*  getMfcc (const size_t shard) const;
+    const float*  getRms (const size_t shard) const;
+
+private:
+    struct Shard
+    {
+        File                              file;
+        std::unique_ptr<MemoryMappedFile> map;
+        const DatasetShardHeader*         header;
+    };
+
+    const char* getData (const size_t shard, const uint64 offset) const;
+
+    std::vector<Shard> shards;
+};
+
+//==============================================================================
+/** Forces the file's data, or a directory's entries, out to disk. */
+bool syncFileToDisk (const File& file);
+
+#endif  // DATASET_H_INCLUDED
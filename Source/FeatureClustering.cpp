@@ -0,0 +1,318 @@
+/*
+  ==============================================================================
+
+    FeatureClustering.cpp
+    Created: 18 Oct 2026 11:26:52pm
+
+  ==============================================================================
+*/
+
+#include <numeric>
+#include <random>
+#include "FeatureClustering.h"
+
+//==============================================================================
+int FeatureClustering::findNearest (const float* vector,
+                                    const float* centroids,
+                                    const size_t numClusters,
+                                    const size_t dimensions,
+                                    double&      squaredDistance)
+{
+    int nearest = 0;
+    squaredDistance = std::numeric_limits<double>::max();
+
+    for (size_t cluster = 0; cluster < numClusters; ++cluster)
+    {
+        const double distance = FeatureDistance::squaredDistance (vector, centroids + cluster * dimensions, dimensions);
+        if (distance < squaredDistance)
+        {
+            squaredDistance = distance;
+            nearest = int (cluster);
+        }
+    }
+    return nearest;
+}
+
+//==============================================================================
+// Reads the vectors at the indices into consecutive rows of the buffer.
+static void fetch (const FeatureClustering::VectorSource& source,
+                   const std::vector<size_t>&             indices,
+                   const size_t                           dimensions,
+                   ThreadPool&                            pool,
+                   std::vector<float>&                    vectors)
+{
+    vectors.resize (indices.size() * dimensions);
+    FeatureDistance::parallelFor (pool, indices.size(), [&] (size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+            source (indices[i], vectors.data() + i * dimensions);
+    });
+}
+
+//==============================================================================
+// k-means++: each further centroid is a sample vector drawn with probability
+// proportional to its squared distance from the nearest centroid so far.
+static std::vector<float> seedCentroids (const std::vector<float>& sample,
+                                         const size_t              numClusters,
+                                         const size_t              dimensions,
+                                         ThreadPool&               pool,
+                                         std::mt19937_64&          random)
+{
+    const size_t sampleSize = sample.size() / dimensions;
+    std::vector<float> centroids;
+    centroids.reserve (numClusters * dimensions);
+
+    auto addCentroid = [&] (const size_t index)
+    {
+        centroids.insert (centroids.end(), sample.begin() + long (index * dimensions),
+                          sample.begin() + long ((index + 1) * dimensions));
+    };
+
+    addCentroid (std::uniform_int_distribution<size_t> (0, sampleSize - 1) (random));
+
+    std::vector<double> nearest (sampleSize, std::numeric_limits<double>::max());
+    while (centroids.size() < numClusters * dimensions)
+    {
+        const float* latest = centroids.data() + centroids.size() - dimensions;
+        FeatureDistance::parallelFor (pool, sampleSize, [&] (size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                nearest[i] = jmin (nearest[i], FeatureDistance::squaredDistance (sample.data() + i * dimensions,
+                                                                                  latest, dimensions));
+        });
+
+        const double total = std::accumulate (nearest.begin(), nearest.end(), 0.0);
+
+        // Fewer distinct vectors than clusters, the rest are duplicates.
+        if (total <= 0.0)
+        {
+            addCentroid (std::uniform_int_distribution<size_t> (0, sampleSize - 1) (random));
+            continue;
+        }
+
+        double target = std::uniform_real_distribution<double> (0.0, total) (random);
+        size_t chosen = sampleSize - 1;
+        for (size_t i = 0; i < sampleSize; ++i)
+        {
+            target -= nearest[i];
+            if (target < 0.0)
+            {
+                chosen = i;
+                break;
+            }
+        }
+        addCentroid (chosen);
+    }
+    return centroids;
+}
+
+//==============================================================================
+ClusteringResult FeatureClustering::cluster (const VectorSource&        source,
+                                             const std::vector<uint64>& ids,
+                                             const size_t               dimensions,
+                                             const ClusteringSettings&  settings)
+{
+    ClusteringResult result;
+    result.dimensions = dimensions;
+    result.recordIds = ids;
+
+    const size_t numVectors = ids.size();
+    const size_t numClusters = jmin (numVectors, size_t (jmax (0, settings.numClusters)));
+    const size_t batchSize = size_t (jmax (1, settings.batchSize));
+
+    if (numClusters == 0 || dimensions == 0)
+    {
+        std::cout << "FeatureClustering::cluster error: Needs at least one vector and one cluster." << std::endl;
+        return result;
+    }
+
+    // One pool for the whole run, every iteration fans out over it.
+    ThreadPool pool (FeatureDistance::getNumThreads (settings.numThreads));
+
+    std::mt19937_64 random (settings.seed);
+    std::uniform_int_distribution<size_t> anyVector (0, numVectors - 1);
+    std::vector<size_t> indices;
+    std::vector<float> vectors;
+
+    // Seed from a sample a few batches large, or everything if that is
+    // smaller.
+    const size_t sampleSize = jmin (numVectors, jmax (batchSize * 4, numClusters * 32));
+    for (size_t i = 0; i < sampleSize; ++i)
+        indices.push_back (sampleSize == numVectors ? i : anyVector (random));
+
+    fetch (source, indices, dimensions, pool, vectors);
+    result.centroids = seedCentroids (vectors, numClusters, dimensions, pool, random);
+
+    // Centroid moves are judged against the mean squared distance of the
+    // sample from its mean.
+    std::vector<double> mean (dimensions, 0.0);
+    for (size_t i = 0; i < sampleSize; ++i)
+        for (size_t j = 0; j < dimensions; ++j)
+            mean[j] += vectors[i * dimensions + j] / double (sampleSize);
+
+    double spread = 0.0;
+    for (size_t i = 0; i < sampleSize; ++i)
+        for (size_t j = 0; j < dimensions; ++j)
+            spread += (vectors[i * dimensions + j] - mean[j]) * (vectors[i * dimensions + j] - mean[j]) / double (sampleSize);
+
+    const double threshold = settings.tolerance * spread;
+
+    // Each centroid moves towards the vectors assigned to it with a step of
+    // one over the number it has seen, so it is the running mean of them.
+    std::vector<double> counts (numClusters, 0.0);
+    std::vector<int> assignments (batchSize);
+    std::vector<float> previous;
+
+    for (int iteration = 0; iteration < settings.maxIterations; ++iteration)
+    {
+        indices.resize (batchSize);
+        for (auto& index : indices)
+            index = anyVector (random);
+
+        fetch (source, indices, dimensions, pool, vectors);
+
+        FeatureDistance::parallelFor (pool, batchSize, [&] (size_t begin, size_t end)
+        {
+            double distance;
+            for (size_t i = begin; i < end; ++i)
+                assignments[i] = findNearest (vectors.data() + i * dimensions, result.centroids.data(),
+                                              numClusters, dimensions, distance);
+        });
+
+        previous = result.centroids;
+        for (size_t i = 0; i < batchSize; ++i)
+        {
+            const size_t cluster = size_t (assignments[i]);
+            const double step = 1.0 / ++counts[cluster];
+            float* centroid = result.centroids.data() + cluster * dimensions;
+            const float* vector = vectors.data() + i * dimensions;
+
+            for (size_t j = 0; j < dimensions; ++j)
+                centroid[j] += float (step * (vector[j] - centroid[j]));
+        }
+
+        result.numIterations = iteration + 1;
+
+        double largestMove = 0.0;
+        for (size_t cluster = 0; cluster < numClusters; ++cluster)
+            largestMove = jmax (largestMove, FeatureDistance::squaredDistance (previous.data() + cluster * dimensions,
+                                                                               result.centroids.data() + cluster * dimensions,
+                                                                               dimensions));
+        if (largestMove <= threshold)
+            break;
+    }
+
+    // Assign everything, one vector at a time per thread.
+    result.clusterIds.resize (numVectors);
+    std::mutex inertiaLock;
+
+    FeatureDistance::parallelFor (pool, numVectors, [&] (size_t begin, size_t end)
+    {
+        std::vector<float> vector (dimensions);
+        double inertia = 0.0;
+        double distance;
+
+        for (size_t i = begin; i < end; ++i)
+        {
+            source (i, vector.data());
+            result.clusterIds[i] = findNearest (vector.data(), result.centroids.data(),
+                                                numClusters, dimensions, distance);
+            inertia += distance;
+        }
+
+        std::lock_guard<std::mutex> guard (inertiaLock);
+        result.inertia += inertia;
+    });
+
+    result.clusterSizes.assign (numClusters, 0);
+    for (const int cluster : result.clusterIds)
+        ++result.clusterSizes[size_t (cluster)];
+
+    return result;
+}
+
+//==============================================================================
+ClusteringResult FeatureClustering::cluster (const float*              vectors,
+                                             const uint64*             ids,
+                                             const size_t              numVectors,
+                                             const size_t              dimensions,
+                                             const ClusteringSettings& settings)
+{
+    std::vector<uint64> recordIds (numVectors);
+    for (size_t i = 0; i < numVectors; ++i)
+        recordIds[i] = ids != nullptr ? ids[i] : uint64 (i);
+
+    return cluster ([&] (size_t index, float* vector)
+    {
+        std::copy (vectors + index * dimensions, vectors + (index + 1) * dimensions, vector);
+    }, recordIds, dimensions, settings);
+}
+
+//==============================================================================
+ClusteringResult FeatureClustering::cluster (const DatasetReader&      reader,
+                                             const ClusteringSettings& settings)
+{
+    const size_t numShards = reader.getNumShards();
+    if (numShards == 0)
+    {
+        std::cout << "FeatureClustering::cluster error: The reader has no shards." << std::endl;
+        return ClusteringResult();
+    }
+
+    const uint32 numCoefficients = reader.getHeader (0).numMfccCoefficients;
+    std::vector<uint64> ids;
+    std::vector<size_t> firstRecords;
+
+    for (size_t shard = 0; shard < numShards; ++shard)
+    {
+        const DatasetShardHeader& header = reader.getHeader (shard);
+        if (header.numMfccCoefficients != numCoefficients)
+        {
+            std::cout << "FeatureClustering::cluster error: " << reader.getShardFile (shard).getFullPathName() <<
+                         " has " << header.numMfccCoefficients << " MFCC coefficients, the first shard has " <<
+                         numCoefficients << "." << std::endl;
+            return ClusteringResult();
+        }
+
+        firstRecords.push_back (ids.size());
+        ids.insert (ids.end(), reader.getRecordIds (shard), reader.getRecordIds (shard) + header.numRecords);
+    }
+
+    const size_t dimensions = 2 * size_t (numCoefficients);
+    return cluster ([&] (size_t index, float* vector)
+    {
+        const size_t shard = size_t (std::upper_bound (firstRecords.begin(), firstRecords.end(), index)
+                                      - firstRecords.begin()) - 1;
+        const DatasetShardHeader& header = reader.getHeader (shard);
+        const size_t recordSize = size_t (header.numMfccFrames) * numCoefficients;
+        const FeatureSequence<float> frames (reader.getMfcc (shard) + (index - firstRecords[shard]) * recordSize,
+                                             header.numMfccFrames, numCoefficients);
+
+        const std::vector<float> summary = FeatureDistance::getSummary (frames);
+        std::copy (summary.begin(), summary.end(), vector);
+    }, ids, dimensions, settings);
+}
+
+//==============================================================================
+std::vector<uint64> FeatureClustering::sampleClusters (const ClusteringResult& result,
+                                                       const size_t            perCluster,
+                                                       const uint64            seed)
+{
+    std::vector<std::vector<uint64>> members (result.clusterSizes.size());
+    for (size_t i = 0; i < result.clusterIds.size(); ++i)
+        members[size_t (result.clusterIds[i])].push_back (result.recordIds[i]);
+
+    std::mt19937_64 random (seed);
+    std::vector<uint64> sample;
+
+    for (auto& cluster : members)
+    {
+        // A partial Fisher-Yates shuffle picks the first perCluster.
+        const size_t count = jmin (perCluster, cluster.size());
+        for (size_t i = 0; i < count; ++i)
+            std::swap (cluster[i], cluster[std::uniform_int_distribution<size_t> (i, cluster.size() - 1) (random)]);
+
+        sample.insert (sample.end(), cluster.begin(), cluster.begin() + long (count));
+    }
+    return sample;
+}
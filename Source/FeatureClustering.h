@@ -0,0 +1,97 @@
+/*
+  ==============================================================================
+
+    FeatureClustering.h
+    Created: 18 Oct 2026 11:26:52pm
+
+  ==============================================================================
+*/
+
+#ifndef FEATURECLUSTERING_H_INCLUDED
+#define FEATURECLUSTERING_H_INCLUDED
+
+#include "Dataset.h"
+#include "FeatureDistance.h"
+
+//==============================================================================
+/** Settings of a mini-batch k-means run. Every iteration draws batchSize
+    vectors at random, and the run stops early once no centroid moves by
+    more than tolerance, relative to the spread of the initial sample.
+    Work is spread over numThreads threads, or one per CPU if it is 0.
+*/
+struct ClusteringSettings
+{
+    int    numClusters = 16;
+    int    batchSize = 1024;
+    int    maxIterations = 100;
+    double tolerance = 1e-4;
+    uint64 seed = 0;
+    int    numThreads = 0;
+};
+
+//==============================================================================
+/** Cluster i holds the vectors whose clusterIds entry is i. Centroids are
+    stored one after the other, numClusters x dimensions.
+*/
+struct ClusteringResult
+{
+    size_t              dimensions = 0;
+    std::vector<uint64> recordIds;
+    std::vector<int>    clusterIds;
+    std::vector<float>  centroids;
+    std::vector<uint64> clusterSizes;
+    double              inertia = 0.0;
+    int                 numIterations = 0;
+};
+
+//==============================================================================
+/** Mini-batch k-means (Sculley, "Web-scale k-means clustering") over vectors
+    that are read on demand, so memory stays bounded by the batch size rather
+    than the number of vectors. Centroids start from k-means++ on a sample,
+    and the final assignment streams over every vector once.
+*/
+namespace FeatureClustering
+{
+    /** Writes vector index into the buffer. Called from several threads at
+        once.
+    */
+    typedef std::function<void (size_t, float*)> VectorSource;
+
+    /** Clusters the MFCC summaries of every record of the reader, computed
+        from the memory mapped shards as they are needed.
+    */
+    ClusteringResult cluster (const DatasetReader&      reader,
+                              const ClusteringSettings& settings);
+
+    /** Clusters numVectors vectors stored one after the other. ids may be
+        nullptr, in which case vector i gets id i.
+    */
+    ClusteringResult cluster (const float*              vectors,
+                              const uint64*             ids,
+                              const size_t              numVectors,
+                              const size_t              dimensions,
+                              const ClusteringSettings& settings);
+
+    ClusteringResult cluster (const VectorSource&        source,
+                              const std::vector<uint64>& ids,
+                              const size_t               dimensions,
+                              const ClusteringSettings&  settings);
+
+    /** Up to perCluster record ids drawn at random from every cluster, for
+        a dataset in which every cluster is equally represented.
+    */
+    std::vector<uint64> sampleClusters (const ClusteringResult& result,
+                                        const size_t            perCluster,
+                                        const uint64            seed);
+
+    /** The index of the centroid nearest to the vector, and the squared
+        distance to it.
+    */
+    int findNearest (const float* vector,
+                     const float* centroids,
+                     const size_t numClusters,
+                     const size_t dimensions,
+                     double&      squaredDistance);
+}
+
+#endif  // FEATURECLUSTERING_H_INCLUDED
@@ -0,0 +1,388 @@
+/*
+  ==============================================================================
+
+    FeatureDistance.cpp
+    Created: 18 Oct 2026 9:58:30pm
+
+  ==============================================================================
+*/
+
+#include <atomic>
+#include "FeatureDistance.h"
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+//==============================================================================
+// Frame kernels, accumulated in double precision whatever the features are
+// stored in.
+static inline double squaredDistance (const double* a, const double* b, const size_t numValues) noexcept
+{
+    size_t i = 0;
+    double sum = 0.0;
+   #if JUCE_INTEL
+    __m128d accumulatorA = _mm_setzero_pd();
+    __m128d accumulatorB = _mm_setzero_pd();
+    for (; i + 4 <= numValues; i += 4)
+    {
+        const __m128d lo = _mm_sub_pd (_mm_loadu_pd (a + i),     _mm_loadu_pd (b + i));
+        const __m128d hi = _mm_sub_pd (_mm_loadu_pd (a + i + 2), _mm_loadu_pd (b + i + 2));
+        accumulatorA = _mm_add_pd (accumulatorA, _mm_mul_pd (lo, lo));
+        accumulatorB = _mm_add_pd (accumulatorB, _mm_mul_pd (hi, hi));
+    }
+    double lanes[2];
+    _mm_storeu_pd (lanes, _mm_add_pd (accumulatorA, accumulatorB));
+    sum = lanes[0] + lanes[1];
+   #endif
+    for (; i < numValues; ++i)
+        sum += (a[i] - b[i]) * (a[i] - b[i]);
+    return sum;
+}
+
+static inline double squaredDistance (const float* a, const float* b, const size_t numValues) noexcept
+{
+    size_t i = 0;
+    double sum = 0.0;
+   #if JUCE_INTEL
+    __m128d accumulatorA = _mm_setzero_pd();
+    __m128d accumulatorB = _mm_setzero_pd();
+    for (; i + 4 <= numValues; i += 4)
+    {
+        const __m128 va = _mm_loadu_ps (a + i);
+        const __m128 vb = _mm_loadu_ps (b + i);
+        const __m128d lo = _mm_sub_pd (_mm_cvtps_pd (va), _mm_cvtps_pd (vb));
+        const __m128d hi = _mm_sub_pd (_mm_cvtps_pd (_mm_movehl_ps (va, va)), _mm_cvtps_pd (_mm_movehl_ps (vb, vb)));
+        accumulatorA = _mm_add_pd (accumulatorA, _mm_mul_pd (lo, lo));
+        accumulatorB = _mm_add_pd (accumulatorB, _mm_mul_pd (hi, hi));
+    }
+    double lanes[2];
+    _mm_storeu_pd (lanes, _mm_add_pd (accumulatorA, accumulatorB));
+    sum = lanes[0] + lanes[1];
+   #endif
+    for (; i < numValues; ++i)
+        sum += (double (a[i]) - b[i]) * (double (a[i]) - b[i]);
+    return sum;
+}
+
+//==============================================================================
+// a.b, a.a and b.b in one pass.
+static inline void cosineTerms (const double* a, const double* b, const size_t numValues, double terms[3]) noexcept
+{
+    size_t i = 0;
+    terms[0] = terms[1] = terms[2] = 0.0;
+   #if JUCE_INTEL
+    __m128d dot = _mm_setzero_pd();
+    __m128d normA = _mm_setzero_pd();
+    __m128d normB = _mm_setzero_pd();
+    for (; i + 2 <= numValues; i += 2)
+    {
+        const __m128d va = _mm_loadu_pd (a + i);
+        const __m128d vb = _mm_loadu_pd (b + i);
+        dot   = _mm_add_pd (dot,   _mm_mul_pd (va, vb));
+        normA = _mm_add_pd (normA, _mm_mul_pd (va, va));
+        normB = _mm_add_pd (normB, _mm_mul_pd (vb, vb));
+    }
+    double lanes[2];
+    _mm_storeu_pd (lanes, dot);   terms[0] = lanes[0] + lanes[1];
+    _mm_storeu_pd (lanes, normA); terms[1] = lanes[0] + lanes[1];
+    _mm_storeu_pd (lanes, normB); terms[2] = lanes[0] + lanes[1];
+   #endif
+    for (; i < numValues; ++i)
+    {
+        terms[0] += a[i] * b[i];
+        terms[1] += a[i] * a[i];
+        terms[2] += b[i] * b[i];
+    }
+}
+
+static inline void cosineTerms (const float* a, const float* b, const size_t numValues, double terms[3]) noexcept
+{
+    size_t i = 0;
+    terms[0] = terms[1] = terms[2] = 0.0;
+   #if JUCE_INTEL
+    __m128d dot = _mm_setzero_pd();
+    __m128d normA = _mm_setzero_pd();
+    __m128d normB = _mm_setzero_pd();
+    for (; i + 2 <= numValues; i += 2)
+    {
+        const __m128d va = _mm_setr_pd (a[i], a[i + 1]);
+        const __m128d vb = _mm_setr_pd (b[i], b[i + 1]);
+        dot   = _mm_add_pd (dot,   _mm_mul_pd (va, vb));
+        normA = _mm_add_pd (normA, _mm_mul_pd (va, va));
+        normB = _mm_add_pd (normB, _mm_mul_pd (vb, vb));
+    }
+    double lanes[2];
+    _mm_storeu_pd (lanes, dot);   terms[0] = lanes[0] + lanes[1];
+    _mm_storeu_pd (lanes, normA); terms[1] = lanes[0] + lanes[1];
+    _mm_storeu_pd (lanes, normB); terms[2] = lanes[0] + lanes[1];
+   #endif
+    for (; i < numValues; ++i)
+    {
+        terms[0] += double (a[i]) * b[i];
+        terms[1] += double (a[i]) * a[i];
+        terms[2] += double (b[i]) * b[i];
+    }
+}
+
+//==============================================================================
+template <typename SampleType>
+static double dynamicTimeWarping (const FeatureSequence<SampleType>& a,
+                                  const FeatureSequence<SampleType>& b,
+                                  const size_t                       numCoefficients,
+                                  const int                          band)
+{
+    const size_t n = a.numFrames;
+    const size_t m = b.numFrames;
+    const double infinity = std::numeric_limits<double>::infinity();
+
+    // The band follows the diagonal of the n x m grid. Neighbouring rows
+    // need overlapping windows for a path to exist, which takes at least
+    // (slope - 1) / 2 frames either side.
+    const double slope = n > 1 ? double (m - 1) / double (n - 1) : 0.0;
+    const size_t width = band < 0 || n == 1 ? m
+                                            : size_t (jmax (double (band), std::ceil ((slope - 1.0) / 2.0)));
+
+    std::vector<double> previous (m, infinity);
+    std::vector<double> current (m, infinity);
+    size_t previousLow = 0, previousHigh = 0;
+    size_t staleLow = 0, staleHigh = 0;
+    bool hasStale = false;
+
+    for (size_t i = 0; i < n; ++i)
+    {
+        const double centre = double (i) * slope;
+        const size_t low  = size_t (jmax (0.0, std::floor (centre) - double (width)));
+        const size_t high = size_t (jmin (double (m - 1), std::ceil (centre) + double (width)));
+
+        // current still holds the row before the previous one.
+        if (hasStale)
+            std::fill (current.begin() + long (staleLow), current.begin() + long (staleHigh) + 1, infinity);
+
+        const SampleType* frameA = a.data + i * a.numCoefficients;
+
+        for (size_t j = low; j <= high; ++j)
+        {
+            const double cost = std::sqrt (squaredDistance (frameA, b.data + j * b.numCoefficients, numCoefficients));
+
+            double best;
+            if (i == 0 && j == 0)
+                best = 0.0;
+            else
+            {
+                best = infinity;
+                if (i > 0)
+                    best = jmin (best, previous[j]);
+                if (j > 0)
+                    best = jmin (best, current[j - 1]);
+                if (i > 0 && j > 0)
+                    best = jmin (best, previous[j - 1]);
+            }
+            current[j] = cost + best;
+        }
+
+        staleLow = previousLow;
+        staleHigh = previousHigh;
+        hasStale = i > 0;
+        previousLow = low;
+        previousHigh = high;
+        previous.swap (current);
+    }
+
+    return previous[m - 1] / double (n + m);
+}
+
+//==============================================================================
+int FeatureDistance::getNumThreads (const int numThreads)
+{
+    return numThreads > 0 ? numThreads : SystemStats::getNumCpus();
+}
+
+void FeatureDistance::parallelFor (const size_t                                numItems,
+                                   const int                                   numThreads,
+                                   const std::function<void (size_t, size_t)>& work)
+{
+    const int threads = jmin (getNumThreads (numThreads), int (jmin<size_t> (numItems, 1024)));
+    if (threads <= 1)
+    {
+        work (0, numItems);
+        return;
+    }
+
+    ThreadPool pool (threads);
+    parallelFor (pool, numItems, work);
+}
+
+void FeatureDistance::parallelFor (ThreadPool&                                 pool,
+                                   const size_t                                numItems,
+                                   const std::function<void (size_t, size_t)>& work)
+{
+    const int threads = jmin (pool.getNumThreads(), int (jmin<size_t> (numItems, 1024)));
+    if (threads <= 1)
+    {
+        work (0, numItems);
+        return;
+    }
+
+    // A few chunks per thread even out pairs of very different lengths.
+    const size_t numChunks = jmin (numItems, size_t (threads) * 8);
+    std::atomic<size_t> remaining (numChunks);
+    WaitableEvent finished;
+
+    for (size_t chunk = 0; chunk < numChunks; ++chunk)
+    {
+        const size_t begin = numItems * chunk / numChunks;
+        const size_t end = numItems * (chunk + 1) / numChunks;
+
+        pool.addJob ([&, begin, end]
+        {
+            work (begin, end);
+
+            if (--remaining == 0)
+                finished.signal();
+        });
+    }
+
+    finished.wait();
+}
+
+//==============================================================================
+FeatureSequence<double> FeatureDistance::fromMfcc (const MFCCFeatures& frames)
+{
+    return FeatureSequence<double> (frames.empty() ? nullptr : frames.front().data(),
+                                    frames.size(),
+                                    std::tuple_size<MFCCFeatures::value_type>::value);
+}
+
+//==============================================================================
+template <typename SampleType>
+std::vector<float> FeatureDistance::getSummary (const FeatureSequence<SampleType>& sequence)
+{
+    const size_t numCoefficients = sequence.numCoefficients;
+    std::vector<double> sums (numCoefficients, 0.0);
+    std::vector<double> squares (numCoefficients, 0.0);
+
+    for (size_t frame = 0; frame < sequence.numFrames; ++frame)
+    {
+        const SampleType* values = sequence.data + frame * numCoefficients;
+        for (size_t i = 0; i < numCoefficients; ++i)
+        {
+            sums[i] += values[i];
+            squares[i] += double (values[i]) * values[i];
+        }
+    }
+
+    std::vector<float> summary (numCoefficients * 2, 0.0f);
+    if (sequence.numFrames == 0)
+        return summary;
+
+    const double numFrames = double (sequence.numFrames);
+    for (size_t i = 0; i < numCoefficients; ++i)
+    {
+        const double mean = sums[i] / numFrames;
+        summary[i] = float (mean);
+        summary[numCoefficients + i] = float (std::sqrt (jmax (0.0, squares[i] / numFrames - mean * mean)));
+    }
+    return summary;
+}
+
+//==============================================================================
+double FeatureDistance::squaredDistance (const float* a, const float* b, const size_t numValues) noexcept
+{
+    return ::squaredDistance (a, b, numValues);
+}
+
+//==============================================================================
+template <typename SampleType>
+double FeatureDistance::distance (const FeatureSequence<SampleType>& a,
+                                  const FeatureSequence<SampleType>& b,
+                                  const DistanceMetric               metric,
+                                  const int                          band)
+{
+    const size_t numCoefficients = jmin (a.numCoefficients, b.numCoefficients);
+
+    if (metric == DistanceMetric::dtw)
+        return a.numFrames == 0 || b.numFrames == 0 ? 0.0 : dynamicTimeWarping (a, b, numCoefficients, band);
+
+    const size_t numFrames = jmin (a.numFrames, b.numFrames);
+    if (numFrames == 0)
+        return 0.0;
+
+    double total = 0.0;
+    for (size_t frame = 0; frame < numFrames; ++frame)
+    {
+        const SampleType* frameA = a.data + frame * a.numCoefficients;
+        const SampleType* frameB = b.data + frame * b.numCoefficients;
+
+        if (metric == DistanceMetric::euclidean)
+        {
+            total += std::sqrt (::squaredDistance (frameA, frameB, numCoefficients));
+        }
+        else
+        {
+            double terms[3];
+            cosineTerms (frameA, frameB, numCoefficients, terms);
+
+            // Two silent frames are the same, one silent frame is as far as
+            // an orthogonal one.
+            const double norms = std::sqrt (terms[1] * terms[2]);
+            if (norms > 0.0)
+                total += 1.0 - terms[0] / norms;
+            else if (terms[1] != terms[2])
+                total += 1.0;
+        }
+    }
+    return total / double (numFrames);
+}
+
+//==============================================================================
+template <typename SampleType>
+std::vector<double> FeatureDistance::distances (const FeatureSequence<SampleType>&              target,
+                                                const std::vector<FeatureSequence<SampleType>>& candidates,
+                                                const DistanceMetric                            metric,
+                                                const int                                       band,
+                                                const int                                       numThreads)
+{
+    std::vector<double> result (candidates.size());
+    parallelFor (candidates.size(), numThreads, [&] (size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+            result[i] = distance (target, candidates[i], metric, band);
+    });
+    return result;
+}
+
+//==============================================================================
+template <typename SampleType>
+std::vector<double> FeatureDistance::distanceMatrix (const std::vector<FeatureSequence<SampleType>>& rows,
+                                                     const std::vector<FeatureSequence<SampleType>>& columns,
+                                                     const DistanceMetric                            metric,
+                                                     const int                                       band,
+                                                     const int                                       numThreads)
+{
+    const size_t numColumns = columns.size();
+    std::vector<double> result (rows.size() * numColumns);
+    parallelFor (result.size(), numThreads, [&] (size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+            result[i] = distance (rows[i / numColumns], columns[i % numColumns], metric, band);
+    });
+    return result;
+}
+
+//==============================================================================
+template std::vector<float> FeatureDistance::getSummary (const FeatureSequence<float>&);
+template std::vector<float> FeatureDistance::getSummary (const FeatureSequence<double>&);
+
+template double FeatureDistance::distance (const FeatureSequence<float>&, const FeatureSequence<float>&, const DistanceMetric, const int);
+template double FeatureDistance::distance (const FeatureSequence<double>&, const FeatureSequence<double>&, const DistanceMetric, const int);
+
+template std::vector<double> FeatureDistance::distances (const FeatureSequence<float>&, const std::vector<FeatureSequence<float>>&,
+                                                         const DistanceMetric, const int, const int);
+template std::vector<double> FeatureDistance::distances (const FeatureSequence<double>&, const std::vector<FeatureSequence<double>>&,
+                                                         const DistanceMetric, const int, const int);
+
+template std::vector<double> FeatureDistance::distanceMatrix (const std::vector<FeatureSequence<float>>&, const std::vector<FeatureSequence<float>>&,
+                                                              const DistanceMetric, const int, const int);
+template std::vector<double> FeatureDistance::distanceMatrix (const std::vector<FeatureSequence<double>>&, const std::vector<FeatureSequence<double>>&,
+                                                              const DistanceMetric, const int, const int);
@@ -0,0 +1,110 @@
+/*
+  ==============================================================================
+
+    FeatureDistance.h
+    Created: 18 Oct 2026 9:58:30pm
+
+  ==============================================================================
+*/
+
+#ifndef FEATUREDISTANCE_H_INCLUDED
+#define FEATUREDISTANCE_H_INCLUDED
+
+#include <functional>
+#include "RenderResult.h"
+
+//==============================================================================
+/** Euclidean and cosine compare frame i of one sequence with frame i of the
+    other and average over the frames both have. DTW aligns the sequences
+    first, with Euclidean frame costs, and is normalised by the sum of their
+    lengths.
+*/
+enum class DistanceMetric
+{
+    euclidean,
+    cosine,
+    dtw
+};
+
+//==============================================================================
+/** A view of numFrames frames of numCoefficients values each, stored frame
+    after frame, such as the MFCC frames of a render or one record of a
+    dataset shard. Doesn't own the data.
+*/
+template <typename SampleType>
+struct FeatureSequence
+{
+    FeatureSequence() = default;
+
+    FeatureSequence (const SampleType* frames, size_t frameCount, size_t coefficientCount) :
+        data (frames),
+        numFrames (frameCount),
+        numCoefficients (coefficientCount)
+    { }
+
+    const SampleType* data = nullptr;
+    size_t            numFrames = 0;
+    size_t            numCoefficients = 0;
+};
+
+//==============================================================================
+namespace FeatureDistance
+{
+    FeatureSequence<double> fromMfcc (const MFCCFeatures& frames);
+
+    /** The mean of every coefficient over the frames followed by its
+        standard deviation, a fixed length summary of a sequence of any
+        length.
+    */
+    template <typename SampleType>
+    std::vector<float> getSummary (const FeatureSequence<SampleType>& sequence);
+
+    double squaredDistance (const float* a, const float* b, const size_t numValues) noexcept;
+
+    /** Runs work (begin, end) over chunks of [0, numItems) on numThreads
+        threads, or one per CPU if it is 0, and returns once all are done.
+    */
+    void parallelFor (const size_t                                numItems,
+                      const int                                   numThreads,
+                      const std::function<void (size_t, size_t)>& work);
+
+    /** The same on a pool the caller keeps, so loops that call it many times
+        don't start and stop threads on every call. Work must not call back
+        into the same pool.
+    */
+    void parallelFor (ThreadPool&                                 pool,
+                      const size_t                                numItems,
+                      const std::function<void (size_t, size_t)>& work);
+
+    /** The number of threads parallelFor uses for numThreads. */
+    int getNumThreads (const int numThreads);
+
+    /** DTW paths may only leave the diagonal, stretched to the two lengths,
+        by band frames. A negative band doesn't constrain them.
+    */
+    template <typename SampleType>
+    double distance (const FeatureSequence<SampleType>& a,
+                     const FeatureSequence<SampleType>& b,
+                     const DistanceMetric               metric,
+                     const int                          band = -1);
+
+    /** The distance of every candidate to the target, spread over numThreads
+        threads, or one per CPU if it is 0.
+    */
+    template <typename SampleType>
+    std::vector<double> distances (const FeatureSequence<SampleType>&              target,
+                                   const std::vector<FeatureSequence<SampleType>>& candidates,
+                                   const DistanceMetric                            metric,
+                                   const int                                       band = -1,
+                                   const int                                       numThreads = 0);
+
+    /** rows.size() x columns.size() distances, row after row. */
+    template <typename SampleType>
+    std::vector<double> distanceMatrix (const std::vector<FeatureSequence<SampleType>>& rows,
+                                        const std::vector<FeatureSequence<SampleType>>& columns,
+                                        const DistanceMetric                            metric,
+                                        const int                                       band = -1,
+                                        const int                                       numThreads = 0);
+}
+
+#endif  // FEATUREDISTANCE_H_INCLUDED
@@ -0,0 +1,902 @@
+/*
+  ==============================================================================
+
+    FeatureIndex.cpp
+    Created: 18 Oct 2026 10:41:07pm
+
+  ==============================================================================
+*/
+
+#include <queue>
+#include "FeatureIndex.h"
+#include "Philox.h"
+
+static const char   indexMagic[8] = { 'R', 'M', 'A', 'N', 'N', 'I', 'X', '1' };
+static const size_t nodesPerBlock = 4096;
+static const size_t maxBlocks     = 65536;
+static const int    maxNodeLevel  = 15;
+
+//==============================================================================
+static uint64 alignOffset (const uint64 offset)
+{
+    const uint64 alignment = DatasetShardHeader::alignment;
+    return (offset + alignment - 1) / alignment * alignment;
+}
+
+//==============================================================================
+/** True if the column starts on an aligned offset past the header and its
+    numRows rows of valuesPerRow values end inside the file.
+*/
+static bool isColumnInside (const FeatureIndexHeader& header, const uint64 offset,
+                            const uint64 numRows, const uint64 valuesPerRow,
+                            const uint64 valueSize)
+{
+    if (offset % DatasetShardHeader::alignment != 0
+         || offset < header.headerSize
+         || offset > header.fileSize)
+        return false;
+
+    // Dividing the space down avoids overflowing on a corrupt header.
+    const uint64 space = header.fileSize - offset;
+    return numRows == 0 || valuesPerRow == 0
+            || space / valueSize / valuesPerRow >= numRows;
+}
+
+/** True if a link list holds no more than capacity links, all to nodes that
+    reach at least this level.
+*/
+static bool areLinksValid (const uint32* links, const uint64 capacity, const uint64 numNodes,
+                           const std::function<uint64 (uint32)>& getLevel, const uint64 level)
+{
+    if (links[0] > capacity)
+        return false;
+
+    for (uint32 i = 1; i <= links[0]; ++i)
+        if (links[i] >= numNodes || getLevel (links[i]) < level)
+            return false;
+
+    return true;
+}
+
+/** Checks a mapped index before anything is read through it: the columns
+    lie inside the file, the upper link offset table is consistent and every
+    link leads to a node on its level.
+*/
+static bool isValidIndex (const FeatureIndexHeader* header, const size_t mappedSize)
+{
+    if (header == nullptr
+         || mappedSize < sizeof (FeatureIndexHeader)
+         || memcmp (header->magic, indexMagic, sizeof (indexMagic)) != 0
+         || header->version != FeatureIndexHeader::currentVersion
+         || header->headerSize != sizeof (FeatureIndexHeader)
+         || header->fileSize != mappedSize
+         || header->dimensions == 0
+         || header->maxNeighbours < 2
+         || header->maxNeighbours > uint32 (std::numeric_limits<int>::max() / 2)
+         || header->efConstruction == 0
+         || header->efConstruction > uint32 (std::numeric_limits<int>::max())
+         || header->maxLevel > uint32 (maxNodeLevel)
+         || header->numNodes > nodesPerBlock * maxBlocks)
+        return false;
+
+    const uint64 numNodes = header->numNodes;
+    const uint64 upperSize = uint64 (header->maxNeighbours) + 1;
+    const uint64 levelZeroSize = 2 * uint64 (header->maxNeighbours) + 1;
+
+    if (! isColumnInside (*header, header->idsOffset,              numNodes,     1,                  sizeof (uint64))
+         || ! isColumnInside (*header, header->vectorsOffset,          numNodes,     header->dimensions, sizeof (float))
+         || ! isColumnInside (*header, header->levelZeroLinksOffset,   numNodes,     levelZeroSize,      sizeof (uint32))
+         || ! isColumnInside (*header, header->upperLinkOffsetsOffset, numNodes + 1, 1,                  sizeof (uint64)))
+        return false;
+
+    const char* data = reinterpret_cast<const char*> (header);
+    const uint64* upperOffsets = reinterpret_cast<const uint64*> (data + header->upperLinkOffsetsOffset);
+
+    if (upperOffsets[0] != 0
+         || ! isColumnInside (*header, header->upperLinksOffset, upperOffsets[numNodes], 1, sizeof (uint32)))
+        return false;
+
+    for (uint64 node = 0; node < numNodes; ++node)
+    {
+        if (upperOffsets[node + 1] < upperOffsets[node]
+             || (upperOffsets[node + 1] - upperOffsets[node]) % upperSize != 0
+             || (upperOffsets[node + 1] - upperOffsets[node]) / upperSize > header->maxLevel)
+            return false;
+    }
+
+    if (numNodes == 0)
+        return true;
+
+    const auto getLevel = [&] (const uint32 node)
+    {
+        return (upperOffsets[node + 1] - upperOffsets[node]) / upperSize;
+    };
+
+    if (header->entryPoint >= numNodes || getLevel (uint32 (header->entryPoint)) != header->maxLevel)
+        return false;
+
+    const uint32* levelZeroLinks = reinterpret_cast<const uint32*> (data + header->levelZeroLinksOffset);
+    const uint32* upperLinks = reinterpret_cast<const uint32*> (data + header->upperLinksOffset);
+
+    for (uint64 node = 0; node < numNodes; ++node)
+    {
+        if (! areLinksValid (levelZeroLinks + node * levelZeroSize, levelZeroSize - 1, numNodes, getLevel, 0))
+            return false;
+
+        const uint64 level = getLevel (uint32 (node));
+        for (uint64 upper = 1; upper <= level; ++upper)
+            if (! areLinksValid (upperLinks + upperOffsets[node] + (upper - 1) * upperSize,
+                                 upperSize - 1, numNodes, getLevel, upper))
+                return false;
+    }
+    return true;
+}
+
+//==============================================================================
+struct FeatureIndex::Block
+{
+    Block (const size_t dimensions, const size_t levelZeroSize) :
+        ids (nodesPerBlock),
+        vectors (nodesPerBlock * dimensions),
+        levelZeroLinks (nodesPerBlock * levelZeroSize),
+        upperLinks (nodesPerBlock),
+        locks (new std::mutex[nodesPerBlock])
+    { }
+
+    std::vector<uint64>              ids;
+    std::vector<float>               vectors;
+    std::vector<uint32>              levelZeroLinks;
+    std::vector<std::vector<uint32>> upperLinks;
+    std::unique_ptr<std::mutex[]>    locks;
+};
+
+//==============================================================================
+/** Marks the nodes one search has seen. Clearing is a matter of moving on to
+    the next tag, so a set is reused across searches rather than allocated.
+*/
+class FeatureIndex::VisitedSet
+{
+public:
+    void reset (const size_t numNodes)
+    {
+        if (marks.size() < numNodes)
+            marks.resize (numNodes, 0);
+
+        if (++tag == 0)
+        {
+            std::fill (marks.begin(), marks.end(), 0);
+            tag = 1;
+        }
+    }
+
+    /** Returns false if the node was already seen. */
+    bool insert (const uint32 node)
+    {
+        // Nodes added since the reset.
+        if (node >= marks.size())
+            marks.resize (size_t (node) + 1 + marks.size() / 2, 0);
+
+        if (marks[node] == tag)
+            return false;
+
+        marks[node] = tag;
+        return true;
+    }
+
+private:
+    std::vector<uint32> marks;
+    uint32              tag = 0;
+};
+
+//==============================================================================
+FeatureIndex::FeatureIndex (const size_t dimensionsToUse,
+                            const int    maxNeighboursToUse,
+                            const int    efConstructionToUse,
+                            const uint64 seedToUse) :
+    dimensions (jmax<size_t> (1, dimensionsToUse)),
+    maxNeighbours (size_t (jmax (2, maxNeighboursToUse))),
+    maxLevelZeroNeighbours (2 * maxNeighbours),
+    efConstruction (size_t (jmax (1, efConstructionToUse))),
+    seed (seedToUse),
+    levelScale (1.0 / std::log (double (maxNeighbours))),
+    numNodes (0),
+    entryPoint (0),
+    maxLevel (0),
+    mappedIds (nullptr),
+    mappedVectors (nullptr),
+    mappedLevelZeroLinks (nullptr),
+    mappedUpperLinkOffsets (nullptr),
+    mappedUpperLinks (nullptr)
+{
+    // Never reallocated, so a block pointer can be read while another
+    // thread appends one.
+    blocks.reserve (maxBlocks);
+}
+
+FeatureIndex::~FeatureIndex()
+{
+}
+
+//==============================================================================
+int FeatureIndex::getRandomLevel (const uint64 id) const
+{
+    const Philox::Counter bits = Philox::generate ({{ uint32 (id), uint32 (id >> 32), 0, 0 }},
+                                                   {{ uint32 (seed), uint32 (seed >> 32) }});
+
+    // In (0, 1], so the log is finite.
+    const double uniform = (double (bits[0] >> 8) + 1.0) / 16777216.0;
+    return jmin (maxNodeLevel, int (-std::log (uniform) * levelScale));
+}
+
+//==============================================================================
+const float* FeatureIndex::getVector (const uint32 node) const
+{
+    if (map != nullptr)
+        return mappedVectors + size_t (node) * dimensions;
+
+    return blocks[node / nodesPerBlock]->vectors.data() + (node % nodesPerBlock) * dimensions;
+}
+
+uint64 FeatureIndex::getId (const uint32 node) const
+{
+    if (map != nullptr)
+        return mappedIds[node];
+
+    return blocks[node / nodesPerBlock]->ids[node % nodesPerBlock];
+}
+
+int FeatureIndex::getLevel (const uint32 node) const
+{
+    if (map != nullptr)
+        return int ((mappedUpperLinkOffsets[node + 1] - mappedUpperLinkOffsets[node]) / (maxNeighbours + 1));
+
+    return int (blocks[node / nodesPerBlock]->upperLinks[node % nodesPerBlock].size() / (maxNeighbours + 1));
+}
+
+const uint32* FeatureIndex::getLinks (const uint32 node, const int level) const
+{
+    if (map != nullptr)
+    {
+        if (level == 0)
+            return mappedLevelZeroLinks + size_t (node) * (maxLevelZeroNeighbours + 1);
+
+        return mappedUpperLinks + mappedUpperLinkOffsets[node] + size_t (level - 1) * (maxNeighbours + 1);
+    }
+
+    const Block& block = *blocks[node / nodesPerBlock];
+    const size_t slot = node % nodesPerBlock;
+
+    if (level == 0)
+        return block.levelZeroLinks.data() + slot * (maxLevelZeroNeighbours + 1);
+
+    return block.upperLinks[slot].data() + size_t (level - 1) * (maxNeighbours + 1);
+}
+
+uint32* FeatureIndex::getMutableLinks (const uint32 node, const int level)
+{
+    jassert (map == nullptr);
+    return const_cast<uint32*> (getLinks (node, level));
+}
+
+std::mutex& FeatureIndex::getLock (const uint32 node) const
+{
+    return blocks[node / nodesPerBlock]->locks[node % nodesPerBlock];
+}
+
+void FeatureIndex::copyLinks (const uint32 node, const int level, std::vector<uint32>& links) const
+{
+    if (map != nullptr)
+    {
+        const uint32* list = getLinks (node, level);
+        links.assign (list + 1, list + 1 + list[0]);
+        return;
+    }
+
+    std::lock_guard<std::mutex> guard (getLock (node));
+    const uint32* list = getLinks (node, level);
+    links.assign (list + 1, list + 1 + list[0]);
+}
+
+float FeatureIndex::getDistance (const float* query, const uint32 node) const
+{
+    return float (FeatureDistance::squaredDistance (query, getVector (node), dimensions));
+}
+
+//==============================================================================
+FeatureIndex::VisitedSet* FeatureIndex::acquireVisitedSet() const
+{
+    {
+        std::lock_guard<std::mutex> guard (visitedSetLock);
+        if (! freeVisitedSets.empty())
+        {
+            VisitedSet* set = freeVisitedSets.back().release();
+            freeVisitedSets.pop_back();
+            return set;
+        }
+    }
+    return new VisitedSet();
+}
+
+void FeatureIndex::releaseVisitedSet (VisitedSet* set) const
+{
+    std::lock_guard<std::mutex> guard (visitedSetLock);
+    freeVisitedSets.emplace_back (set);
+}
+
+//==============================================================================
+uint32 FeatureIndex::searchGreedy (const float* query, uint32 entry, const int fromLevel, const int toLevel) const
+{
+    float entryDistance = getDistance (query, entry);
+    std::vector<uint32> links;
+
+    for (int level = fromLevel; level >= toLevel; --level)
+    {
+        for (bool moved = true; moved;)
+        {
+            moved = false;
+            copyLinks (entry, level, links);
+
+            for (const uint32 neighbour : links)
+            {
+                const float distance = getDistance (query, neighbour);
+                if (distance < entryDistance)
+                {
+                    entryDistance = distance;
+                    entry = neighbour;
+                    moved = true;
+                }
+            }
+        }
+    }
+    return entry;
+}
+
+//==============================================================================
+std::vector<FeatureIndex::Candidate> FeatureIndex::searchLevel (const float* query,
+                                                                const uint32 entry,
+                                                                const size_t ef,
+                                                                const int    level) const
+{
+    std::priority_queue<Candidate, std::vector<Candidate>, std::greater<Candidate>> toVisit;
+    std::priority_queue<Candidate> nearest;
+
+    VisitedSet* visited = acquireVisitedSet();
+    visited->reset (numNodes.load());
+    visited->insert (entry);
+
+    const Candidate first = { getDistance (query, entry), entry };
+    toVisit.push (first);
+    nearest.push (first);
+
+    std::vector<uint32> links;
+    while (! toVisit.empty())
+    {
+        const Candidate current = toVisit.top();
+        if (current.distance > nearest.top().distance)
+            break;
+        toVisit.pop();
+
+        copyLinks (current.node, level, links);
+        for (const uint32 neighbour : links)
+        {
+            if (! visited->insert (neighbour))
+                continue;
+
+            const float distance = getDistance (query, neighbour);
+            if (nearest.size() < ef || distance < nearest.top().distance)
+            {
+                const Candidate candidate = { distance, neighbour };
+                toVisit.push (candidate);
+                nearest.push (candidate);
+
+                if (nearest.size() > ef)
+                    nearest.pop();
+            }
+        }
+    }
+
+    releaseVisitedSet (visited);
+
+    std::vector<Candidate> result (nearest.size());
+    for (size_t i = result.size(); i > 0; --i)
+    {
+        result[i - 1] = nearest.top();
+        nearest.pop();
+    }
+    return result;
+}
+
+//==============================================================================
+std::vector<uint32> FeatureIndex::selectNeighbours (const std::vector<Candidate>& candidates,
+                                                    const size_t                  maxLinks) const
+{
+    std::vector<uint32> selected;
+    for (const auto& candidate : candidates)
+    {
+        if (selected.size() >= maxLinks)
+            break;
+
+        bool isDiverse = true;
+        for (const uint32 kept : selected)
+        {
+            if (getDistance (getVector (candidate.node), kept) < candidate.distance)
+            {
+                isDiverse = false;
+                break;
+            }
+        }
+
+        if (isDiverse)
+            selected.push_back (candidate.node);
+    }
+    return selected;
+}
+
+//==============================================================================
+void FeatureIndex::addLink (const uint32 node, const uint32 neighbour, const int level)
+{
+    std::lock_guard<std::mutex> guard (getLock (node));
+
+    uint32* links = getMutableLinks (node, level);
+    const size_t capacity = level == 0 ? maxLevelZeroNeighbours : maxNeighbours;
+
+    if (links[0] < capacity)
+    {
+        links[1 + links[0]] = neighbour;
+        ++links[0];
+        return;
+    }
+
+    // Full, keep the most diverse of the old links and the new one.
+    const float* vector = getVector (node);
+    std::vector<Candidate> candidates;
+    candidates.reserve (capacity + 1);
+
+    for (size_t i = 0; i < capacity; ++i)
+    {
+        const Candidate candidate = { getDistance (vector, links[1 + i]), links[1 + i] };
+        candidates.push_back (candidate);
+    }
+
+    const Candidate added = { getDistance (vector, neighbour), neighbour };
+    candidates.push_back (added);
+    std::sort (candidates.begin(), candidates.end());
+
+    const std::vector<uint32> selected = selectNeighbours (candidates, capacity);
+    links[0] = uint32 (selected.size());
+    std::copy (selected.begin(), selected.end(), links + 1);
+}
+
+//==============================================================================
+uint32 FeatureIndex::allocateNode (const uint64 id, const float* vector, const int level)
+{
+    const uint32 node = numNodes.load();
+    if (node / nodesPerBlock >= blocks.size())
+        blocks.emplace_back (new Block (dimensions, maxLevelZeroNeighbours + 1));
+
+    Block& block = *blocks[node / nodesPerBlock];
+    const size_t slot = node % nodesPerBlock;
+
+    block.ids[slot] = id;
+    std::copy (vector, vector + dimensions, block.vectors.begin() + long (slot * dimensions));
+    block.levelZeroLinks[slot * (maxLevelZeroNeighbours + 1)] = 0;
+    block.upperLinks[slot].assign (size_t (level) * (maxNeighbours + 1), 0);
+
+    nodesById[id] = node;
+    numNodes.store (node + 1);
+    return node;
+}
+
+//==============================================================================
+void FeatureIndex::connect (const uint32 node, const int level, std::unique_lock<std::mutex>& lock)
+{
+    if (node == 0)
+    {
+        entryPoint = node;
+        maxLevel = level;
+        return;
+    }
+
+    const uint32 entry = entryPoint;
+    const int topLevel = maxLevel;
+
+    // A node that becomes the new entry point keeps the lock until it is
+    // linked in, everyone else can go on without it.
+    if (level <= topLevel)
+        lock.unlock();
+
+    const float* vector = getVector (node);
+    uint32 nearest = searchGreedy (vector, entry, topLevel, level + 1);
+
+    for (int l = jmin (level, topLevel); l >= 0; --l)
+    {
+        std::vector<Candidate> candidates = searchLevel (vector, nearest, efConstruction, l);
+
+        // Another thread may already have linked this node in.
+        candidates.erase (std::remove_if (candidates.begin(), candidates.end(),
+                                          [node] (const Candidate& c) { return c.node == node; }),
+                          candidates.end());
+        if (candidates.empty())
+            continue;
+
+        const std::vector<uint32> neighbours = selectNeighbours (candidates, maxNeighbours);
+        {
+            std::lock_guard<std::mutex> guard (getLock (node));
+            uint32* links = getMutableLinks (node, l);
+            const size_t capacity = l == 0 ? maxLevelZeroNeighbours : maxNeighbours;
+
+            for (const uint32 neighbour : neighbours)
+            {
+                if (links[0] >= capacity)
+                    break;
+
+                if (std::find (links + 1, links + 1 + links[0], neighbour) == links + 1 + links[0])
+                    links[1 + links[0]++] = neighbour;
+            }
+        }
+
+        for (const uint32 neighbour : neighbours)
+            addLink (neighbour, node, l);
+
+        nearest = candidates.front().node;
+    }
+
+    if (level > topLevel)
+    {
+        entryPoint = node;
+        maxLevel = level;
+        lock.unlock();
+    }
+}
+
+//==============================================================================
+bool FeatureIndex::add (const uint64 id, const float* vector)
+{
+    if (map != nullptr)
+    {
+        std::cout << "FeatureIndex::add error: The index is memory mapped, " <<
+                     "load it without the memory map to add to it." << std::endl;
+        return false;
+    }
+
+    const int level = getRandomLevel (id);
+
+    std::unique_lock<std::mutex> lock (structureLock);
+    if (nodesById.count (id) != 0)
+        return false;
+
+    if (numNodes.load() >= nodesPerBlock * maxBlocks)
+    {
+        std::cout << "FeatureIndex::add error: The index is full." << std::endl;
+        return false;
+    }
+
+    const uint32 node = allocateNode (id, vector, level);
+    connect (node, level, lock);
+    return true;
+}
+
+bool FeatureIndex::add (const uint64 id, const MFCCFeatures& frames)
+{
+    const size_t summarySize = 2 * std::tuple_size<MFCCFeatures::value_type>::value;
+    if (dimensions != summarySize)
+    {
+        std::cout << "FeatureIndex::add error: MFCC summaries have " << summarySize <<
+                     " dimensions, the index has " << dimensions << "." << std::endl;
+        return false;
+    }
+
+    const std::vector<float> summary = FeatureDistance::getSummary (FeatureDistance::fromMfcc (frames));
+    return add (id, summary.data());
+}
+
+//==============================================================================
+size_t FeatureIndex::addBatch (const uint64* ids,
+                               const float*  vectors,
+                               const size_t  numVectors,
+                               const int     numThreads)
+{
+    std::atomic<size_t> numAdded (0);
+    FeatureDistance::parallelFor (numVectors, numThreads, [&] (size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+            if (add (ids[i], vectors + i * dimensions))
+                ++numAdded;
+    });
+    return numAdded.load();
+}
+
+//==============================================================================
+size_t FeatureIndex::addShards (const DatasetReader& reader,
+                                const int            numThreads)
+{
+    std::atomic<size_t> numAdded (0);
+
+    for (size_t shard = 0; shard < reader.getNumShards(); ++shard)
+    {
+        const DatasetShardHeader& header = reader.getHeader (shard);
+        if (dimensions != 2 * size_t (header.numMfccCoefficients))
+        {
+            std::cout << "FeatureIndex::addShards error: " << reader.getShardFile (shard).getFullPathName() <<
+                         " has " << header.numMfccCoefficients << " MFCC coefficients, the index needs " <<
+                         dimensions / 2 << "." << std::endl;
+            continue;
+        }
+
+        const uint64* recordIds = reader.getRecordIds (shard);
+        const float* mfcc = reader.getMfcc (shard);
+        const size_t recordSize = size_t (header.numMfccFrames) * header.numMfccCoefficients;
+
+        FeatureDistance::parallelFor (size_t (header.numRecords), numThreads, [&] (size_t begin, size_t end)
+        {
+            for (size_t record = begin; record < end; ++record)
+            {
+                const FeatureSequence<float> frames (mfcc + record * recordSize,
+                                                     header.numMfccFrames, header.numMfccCoefficients);
+                if (add (recordIds[record], FeatureDistance::getSummary (frames).data()))
+                    ++numAdded;
+            }
+        });
+    }
+    return numAdded.load();
+}
+
+//==============================================================================
+size_t FeatureIndex::addRenders (RenderPool&                     pool,
+                                 const std::vector<PluginPatch>& patches,
+                                 const RenderSettings&           settings,
+                                 const uint64                    firstId)
+{
+    RenderSettings featureSettings = settings;
+    featureSettings.needsAudio = false;
+
+    std::atomic<size_t> numAdded (0);
+    pool.renderPatches (patches, featureSettings, [&] (size_t index, RenderResult&& result)
+    {
+        if (add (firstId + index, result->mfccFeatures))
+            ++numAdded;
+    });
+    return numAdded.load();
+}
+
+//==============================================================================
+std::vector<FeatureIndex::Neighbour> FeatureIndex::search (const float* query,
+                                                           const size_t k,
+                                                           const int    ef) const
+{
+    std::vector<Neighbour> result;
+    if (numNodes.load() == 0 || k == 0)
+        return result;
+
+    uint32 entry;
+    int topLevel;
+    {
+        std::lock_guard<std::mutex> guard (structureLock);
+        entry = entryPoint;
+        topLevel = maxLevel;
+    }
+
+    const size_t numCandidates = jmax (k, ef > 0 ? size_t (ef) : efConstruction);
+    const uint32 nearest = searchGreedy (query, entry, topLevel, 1);
+    const std::vector<Candidate> candidates = searchLevel (query, nearest, numCandidates, 0);
+
+    for (size_t i = 0; i < jmin (k, candidates.size()); ++i)
+    {
+        const Neighbour neighbour = { getId (candidates[i].node), std::sqrt (candidates[i].distance) };
+        result.push_back (neighbour);
+    }
+    return result;
+}
+
+//==============================================================================
+std::vector<std::vector<FeatureIndex::Neighbour>> FeatureIndex::searchBatch (const float* queries,
+                                                                             const size_t numQueries,
+                                                                             const size_t k,
+                                                                             const int    ef,
+                                                                             const int    numThreads) const
+{
+    std::vector<std::vector<Neighbour>> result (numQueries);
+    FeatureDistance::parallelFor (numQueries, numThreads, [&] (size_t begin, size_t end)
+    {
+        for (size_t i = begin; i < end; ++i)
+            result[i] = search (queries + i * dimensions, k, ef);
+    });
+    return result;
+}
+
+//==============================================================================
+size_t FeatureIndex::size() const
+{
+    return numNodes.load();
+}
+
+size_t FeatureIndex::getDimensions() const
+{
+    return dimensions;
+}
+
+bool FeatureIndex::isReadOnly() const
+{
+    return map != nullptr;
+}
+
+String FeatureIndex::getFileExtension()
+{
+    return ".rmindex";
+}
+
+//==============================================================================
+bool FeatureIndex::save (const std::string& path) const
+{
+    std::lock_guard<std::mutex> guard (structureLock);
+
+    const uint32 count = numNodes.load();
+    const size_t levelZeroSize = maxLevelZeroNeighbours + 1;
+
+    std::vector<uint64> upperLinkOffsets (size_t (count) + 1, 0);
+    for (uint32 node = 0; node < count; ++node)
+        upperLinkOffsets[node + 1] = upperLinkOffsets[node] + uint64 (getLevel (node)) * (maxNeighbours + 1);
+
+    FeatureIndexHeader header;
+    zerostruct (header);
+    memcpy (header.magic, indexMagic, sizeof (header.magic));
+    header.version        = FeatureIndexHeader::currentVersion;
+    header.headerSize     = uint32 (sizeof (FeatureIndexHeader));
+    header.dimensions     = uint32 (dimensions);
+    header.maxNeighbours  = uint32 (maxNeighbours);
+    header.efConstruction = uint32 (efConstruction);
+    header.maxLevel       = uint32 (maxLevel);
+    header.numNodes       = count;
+    header.entryPoint     = entryPoint;
+    header.seed           = seed;
+
+    // Each column is written node by node, so blocks and maps are treated
+    // alike.
+    struct Column
+    {
+        uint64*                                           offset;
+        uint64                                            numBytes;
+        std::function<bool (OutputStream&, uint32)>       writeNode;
+    };
+
+    const Column columns[] =
+    {
+        { &header.idsOffset, uint64 (count) * sizeof (uint64), [this] (OutputStream& stream, uint32 node)
+        {
+            const uint64 id = getId (node);
+            return stream.write (&id, sizeof (id));
+        } },
+        { &header.vectorsOffset, uint64 (count) * dimensions * sizeof (float), [this] (OutputStream& stream, uint32 node)
+        {
+            return stream.write (getVector (node), dimensions * sizeof (float));
+        } },
+        { &header.levelZeroLinksOffset, uint64 (count) * levelZeroSize * sizeof (uint32), [&] (OutputStream& stream, uint32 node)
+        {
+            return stream.write (getLinks (node, 0), levelZeroSize * sizeof (uint32));
+        } },
+        { &header.upperLinkOffsetsOffset, upperLinkOffsets.size() * sizeof (uint64), [&] (OutputStream& stream, uint32 node)
+        {
+            return stream.write (&upperLinkOffsets[node], sizeof (uint64))
+                    && (node + 1 < count || stream.write (&upperLinkOffsets[count], sizeof (uint64)));
+        } },
+        { &header.upperLinksOffset, upperLinkOffsets.back() * sizeof (uint32), [this] (OutputStream& stream, uint32 node)
+        {
+            const int level = getLevel (node);
+            return level == 0 || stream.write (getLinks (node, 1), size_t (level) * (maxNeighbours + 1) * sizeof (uint32));
+        } }
+    };
+
+    uint64 position = sizeof (FeatureIndexHeader);
+    for (const auto& column : columns)
+    {
+        *column.offset = alignOffset (position);
+        position = *column.offset + column.numBytes;
+    }
+    header.fileSize = position;
+
+    const File file (File::getCurrentWorkingDirectory().getChildFile (String (path)));
+    const File tempFile (file.getFullPathName() + ".tmp");
+
+    bool success = false;
+    {
+        tempFile.deleteFile();
+        FileOutputStream stream (tempFile);
+
+        if (stream.openedOk())
+        {
+            success = stream.write (&header, sizeof (header));
+
+            for (const auto& column : columns)
+            {
+                const int64 padding = int64 (*column.offset) - stream.getPosition();
+                success = success && stream.writeRepeatedByte (0, size_t (padding));
+
+                // An empty index still has the final upper link offset.
+                if (count == 0 && column.offset == &header.upperLinkOffsetsOffset)
+                    success = success && stream.write (&upperLinkOffsets[0], sizeof (uint64));
+
+                for (uint32 node = 0; success && node < count; ++node)
+                    success = column.writeNode (stream, node);
+            }
+
+            stream.flush();
+            success = success && stream.getStatus().wasOk();
+        }
+    }
+
+    if (success)
+        success = syncFileToDisk (tempFile)
+                   && tempFile.moveFileTo (file)
+                   && syncFileToDisk (file.getParentDirectory());
+
+    if (! success)
+    {
+        std::cout << "FeatureIndex::save error: Couldn't write " <<
+                     file.getFullPathName() << "." << std::endl;
+        tempFile.deleteFile();
+    }
+    return success;
+}
+
+//==============================================================================
+std::unique_ptr<FeatureIndex> FeatureIndex::load (const std::string& path,
+                                                  const bool         memoryMap)
+{
+    const File file (File::getCurrentWorkingDirectory().getChildFile (String (path)));
+    std::unique_ptr<MemoryMappedFile> fileMap (new MemoryMappedFile (file, MemoryMappedFile::readOnly));
+
+    const size_t mappedSize = fileMap->getSize();
+    const auto* header = static_cast<const FeatureIndexHeader*> (fileMap->getData());
+
+    if (! isValidIndex (header, mappedSize))
+    {
+        std::cout << "FeatureIndex::load error: " << file.getFullPathName() <<
+                     " isn't a complete index." << std::endl;
+        return nullptr;
+    }
+
+    std::unique_ptr<FeatureIndex> index (new FeatureIndex (header->dimensions,
+                                                           int (header->maxNeighbours),
+                                                           int (header->efConstruction),
+                                                           header->seed));
+
+    const char* data = static_cast<const char*> (fileMap->getData());
+    index->mappedIds              = reinterpret_cast<const uint64*> (data + header->idsOffset);
+    index->mappedVectors          = reinterpret_cast<const float*>  (data + header->vectorsOffset);
+    index->mappedLevelZeroLinks   = reinterpret_cast<const uint32*> (data + header->levelZeroLinksOffset);
+    index->mappedUpperLinkOffsets = reinterpret_cast<const uint64*> (data + header->upperLinkOffsetsOffset);
+    index->mappedUpperLinks       = reinterpret_cast<const uint32*> (data + header->upperLinksOffset);
+    index->entryPoint             = uint32 (header->entryPoint);
+    index->maxLevel               = int (header->maxLevel);
+    index->numNodes.store (uint32 (header->numNodes));
+    index->map = std::move (fileMap);
+
+    if (memoryMap)
+        return index;
+
+    // Copy everything into blocks, then let go of the file.
+    std::unique_ptr<FeatureIndex> copy (new FeatureIndex (index->dimensions,
+                                                          int (index->maxNeighbours),
+                                                          int (index->efConstruction),
+                                                          index->seed));
+    const size_t levelZeroSize = index->maxLevelZeroNeighbours + 1;
+
+    for (uint32 node = 0; node < uint32 (header->numNodes); ++node)
+    {
+        const int level = index->getLevel (node);
+        copy->allocateNode (index->getId (node), index->getVector (node), level);
+
+        const uint32* levelZero = index->getLinks (node, 0);
+        std::copy (levelZero, levelZero + levelZeroSize, copy->getMutableLinks (node, 0));
+
+        if (level > 0)
+        {
+            const uint32* upper = index->getLinks (node, 1);
+            std::copy (upper, upper + size_t (level) * (index->maxNeighbours + 1), copy->getMutableLinks (node, 1));
+        }
+    }
+
+    copy->entryPoint = index->entryPoint;
+    copy->maxLevel = index->maxLevel;
+    return copy;
+}
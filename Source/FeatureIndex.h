@@ -0,0 +1,228 @@
+/*
+  ==============================================================================
+
+    FeatureIndex.h
+    Created: 18 Oct 2026 10:41:07pm
+
+  ==============================================================================
+*/
+
+#ifndef FEATUREINDEX_H_INCLUDED
+#define FEATUREINDEX_H_INCLUDED
+
+#include <atomic>
+#include <mutex>
+#include <unordered_map>
+#include "RenderPool.h"
+#include "Dataset.h"
+#include "FeatureDistance.h"
+
+//==============================================================================
+/** On-disk layout of an index, every array aligned like a dataset shard so
+    it can be used straight from a memory map:
+
+        FeatureIndexHeader
+        uint64  ids                 [numNodes]
+        float32 vectors             [numNodes, dimensions]
+        uint32  levelZeroLinks      [numNodes, 1 + 2 * maxNeighbours]
+        uint64  upperLinkOffsets    [numNodes + 1]
+        uint32  upperLinks          [upperLinkOffsets[numNodes]]
+
+    A link list is its length followed by its slots. Node i has
+    (upperLinkOffsets[i + 1] - upperLinkOffsets[i]) / (1 + maxNeighbours)
+    levels above level 0, stored one after the other.
+*/
+struct FeatureIndexHeader
+{
+    static const uint32 currentVersion = 1;
+
+    char   magic[8];
+    uint32 version;
+    uint32 headerSize;
+    uint32 dimensions;
+    uint32 maxNeighbours;
+    uint32 efConstruction;
+    uint32 maxLevel;
+    uint64 numNodes;
+    uint64 entryPoint;
+    uint64 seed;
+    uint64 idsOffset;
+    uint64 vectorsOffset;
+    uint64 levelZeroLinksOffset;
+    uint64 upperLinkOffsetsOffset;
+    uint64 upperLinksOffset;
+    uint64 fileSize;
+};
+
+//==============================================================================
+/** An approximate nearest neighbour index of fixed length feature vectors,
+    such as the MFCC summaries of renders, keyed by record id. It is a
+    hierarchical navigable small world graph (Malkov and Yashunin, 2016)
+    searched by Euclidean distance.
+
+    Adding and searching are safe from any number of threads at once, which
+    is how the batch functions build it. The level of a node is drawn from
+    its id and the seed rather than from a shared generator, so it doesn't
+    depend on which thread adds it.
+
+    An index loaded with a memory map serves searches straight from the
+    file and can't be added to.
+*/
+class FeatureIndex
+{
+public:
+    struct Neighbour
+    {
+        uint64 id;
+        float  distance;
+    };
+
+    /** maxNeighbours is the number of links per node above level 0, twice
+        as many are kept at level 0. Larger values and a larger
+        efConstruction give better recall for a slower build.
+    */
+    FeatureIndex (const size_t dimensions,
+                  const int    maxNeighbours = 16,
+                  const int    efConstruction = 200,
+                  const uint64 seed = 0);
+
+    ~FeatureIndex();
+
+    /** Returns false if the id is already in the index. */
+    bool add (const uint64 id, const float* vector);
+
+    /** Adds the summary of the frames, for an index of
+        2 * 13 dimensional vectors.
+    */
+    bool add (const uint64 id, const MFCCFeatures& frames);
+
+    /** Adds numVectors vectors stored one after the other on numThreads
+        threads, or one per CPU if it is 0. Returns how many were new.
+    */
+    size_t addBatch (const uint64* ids,
+                     const float*  vectors,
+                     const size_t  numVectors,
+                     const int     numThreads = 0);
+
+    /** Adds the MFCC summary of every record of the reader that isn't in the
+        index yet, so it can be called again as more shards are written.
+    */
+    size_t addShards (const DatasetReader& reader,
+                      const int            numThreads = 0);
+
+    /** Renders the patches and adds each render as it arrives, on the thread
+        that rendered it, with ids firstId upwards.
+    */
+    size_t addRenders (RenderPool&                     pool,
+                       const std::vector<PluginPatch>& patches,
+                       const RenderSettings&           settings,
+                       const uint64                    firstId);
+
+    /** The k nearest vectors found, nearest first. ef is the size of the
+        candidate list, at least k; 0 uses max (k, efConstruction).
+    */
+    std::vector<Neighbour> search (const float* query,
+                                   const size_t k,
+                                   const int    ef = 0) const;
+
+    std::vector<std::vector<Neighbour>> searchBatch (const float* queries,
+                                                     const size_t numQueries,
+                                                     const size_t k,
+                                                     const int    ef = 0,
+                                                     const int    numThreads = 0) const;
+
+    size_t size() const;
+
+    size_t getDimensions() const;
+
+    bool isReadOnly() const;
+
+    /** Writes the index under a temporary name and renames it into place.
+        Nothing may be added while it is saved.
+    */
+    bool save (const std::string& path) const;
+
+    /** Returns nullptr if the file isn't a complete index. With memoryMap
+        the index stays backed by the file, otherwise it is read into memory
+        and can be added to.
+    */
+    static std::unique_ptr<FeatureIndex> load (const std::string& path,
+                                               const bool         memoryMap = true);
+
+    static String getFileExtension();
+
+private:
+    class VisitedSet;
+
+    struct Block;
+
+    struct Candidate
+    {
+        float  distance;
+        uint32 node;
+
+        bool operator< (const Candidate& other) const noexcept { return distance < other.distance; }
+        bool operator> (const Candidate& other) const noexcept { return distance > other.distance; }
+    };
+
+    int           getRandomLevel (const uint64 id) const;
+    uint32        allocateNode (const uint64 id, const float* vector, const int level);
+    void          connect (const uint32 node, const int level, std::unique_lock<std::mutex>& lock);
+
+    const float*  getVector (const uint32 node) const;
+    uint64        getId (const uint32 node) const;
+    int           getLevel (const uint32 node) const;
+    const uint32* getLinks (const uint32 node, const int level) const;
+    uint32*       getMutableLinks (const uint32 node, const int level);
+    std::mutex&   getLock (const uint32 node) const;
+    void          copyLinks (const uint32 node, const int level, std::vector<uint32>& links) const;
+    float         getDistance (const float* query, const uint32 node) const;
+
+    uint32 searchGreedy (const float* query, uint32 entry, const int fromLevel, const int toLevel) const;
+
+    /** The ef nearest nodes found at the level, nearest first. */
+    std::vector<Candidate> searchLevel (const float* query,
+                                        const uint32 entry,
+                                        const size_t ef,
+                                        const int    level) const;
+
+    /** Keeps up to maxLinks candidates, skipping any that is nearer to a
+        kept one than to the base, so links spread out in every direction.
+    */
+    std::vector<uint32> selectNeighbours (const std::vector<Candidate>& candidates,
+                                          const size_t                  maxLinks) const;
+
+    void addLink (const uint32 node, const uint32 neighbour, const int level);
+
+    VisitedSet* acquireVisitedSet() const;
+    void        releaseVisitedSet (VisitedSet* set) const;
+
+    const size_t                              dimensions;
+    const size_t                              maxNeighbours;
+    const size_t                              maxLevelZeroNeighbours;
+    const size_t                              efConstruction;
+    const uint64                              seed;
+    const double                              levelScale;
+
+    // Nodes are allocated in fixed size blocks that never move, so readers
+    // don't need the structure lock to reach a node they were given.
+    std::vector<std::unique_ptr<Block>>       blocks;
+    std::unordered_map<uint64, uint32>        nodesById;
+    std::atomic<uint32>                       numNodes;
+    uint32                                    entryPoint;
+    int                                       maxLevel;
+    mutable std::mutex                        structureLock;
+
+    // Set when the index is served from a file.
+    std::unique_ptr<MemoryMappedFile>         map;
+    const uint64*                             mappedIds;
+    const float*                              mappedVectors;
+    const uint32*                             mappedLevelZeroLinks;
+    const uint64*                             mappedUpperLinkOffsets;
+    const uint32*                             mappedUpperLinks;
+
+    mutable std::mutex                        visitedSetLock;
+    mutable std::vector<std::unique_ptr<VisitedSet>> freeVisitedSets;
+};
+
+#endif  // FEATUREINDEX_H_INCLUDED
@@ -0,0 +1,151 @@
+/*
+  ==============================================================================
+
+    Fingerprint.cpp
+    Created: 18 Oct 2026 11:41:15pm
+
+  ==============================================================================
+*/
+
+#include "Fingerprint.h"
+#include "Philox.h"
+
+static const size_t numBits = 64;
+static const size_t numCoefficients = std::tuple_size<MFCCFeatures::value_type>::value;
+static const size_t numDimensions = 2 * numCoefficients - 1;
+
+//==============================================================================
+// Gaussian hyperplane normals from a fixed Philox stream, built once before
+// main so no thread ever sees them half filled.
+static std::vector<float> makeHyperplanes()
+{
+    const Philox::Key key = {{ 0x52454E44, 0x46505231 }};
+    std::vector<float> normals (numBits * numDimensions);
+
+    for (size_t i = 0; i < normals.size(); i += 2)
+    {
+        const Philox::Counter bits = Philox::generate ({{ uint32 (i), 0, 0, 0 }}, key);
+
+        // Box-Muller, the first uniform in (0, 1] so the log is finite.
+        const double radius = std::sqrt (-2.0 * std::log (1.0 - Philox::toUniformFloat (bits[0])));
+        const double angle = 2.0 * MathConstants<double>::pi * Philox::toUniformFloat (bits[1]);
+
+        normals[i] = float (radius * std::cos (angle));
+        if (i + 1 < normals.size())
+            normals[i + 1] = float (radius * std::sin (angle));
+    }
+    return normals;
+}
+
+static const std::vector<float> hyperplanes = makeHyperplanes();
+
+//==============================================================================
+uint64 Fingerprint::compute (const MFCCFeatures& frames)
+{
+    return compute (FeatureDistance::fromMfcc (frames));
+}
+
+template <typename SampleType>
+uint64 Fingerprint::compute (const FeatureSequence<SampleType>& frames)
+{
+    const std::vector<float> summary = FeatureDistance::getSummary (frames);
+    if (summary.size() != 2 * numCoefficients)
+        return 0;
+
+    uint64 fingerprint = 0;
+    for (size_t bit = 0; bit < numBits; ++bit)
+    {
+        const float* normal = hyperplanes.data() + bit * numDimensions;
+
+        double projection = 0.0;
+        for (size_t i = 1; i < summary.size(); ++i)
+            projection += double (normal[i - 1]) * summary[i];
+
+        if (projection >= 0.0)
+            fingerprint |= uint64 (1) << bit;
+    }
+    return fingerprint;
+}
+
+int Fingerprint::getDistance (const uint64 a, const uint64 b) noexcept
+{
+    uint64 bits = a ^ b;
+    bits = bits - ((bits >> 1) & 0x5555555555555555ULL);
+    bits = (bits & 0x3333333333333333ULL) + ((bits >> 2) & 0x3333333333333333ULL);
+    bits = (bits + (bits >> 4)) & 0x0F0F0F0F0F0F0F0FULL;
+    return int ((bits * 0x0101010101010101ULL) >> 56);
+}
+
+template uint64 Fingerprint::compute (const FeatureSequence<float>&);
+template uint64 Fingerprint::compute (const FeatureSequence<double>&);
+
+//==============================================================================
+DuplicateFilter::DuplicateFilter (const int maxDistanceToUse) :
+    maxDistance (jlimit (0, int (numBits) - 1, maxDistanceToUse)),
+    tables (size_t (maxDistance) + 1),
+    numFingerprints (0)
+{
+}
+
+//==============================================================================
+uint64 DuplicateFilter::getBlock (const uint64 fingerprint, const size_t block) const
+{
+    const size_t first = block * numBits / tables.size();
+    const size_t last = (block + 1) * numBits / tables.size();
+    const uint64 mask = last - first == numBits ? ~uint64 (0) : (uint64 (1) << (last - first)) - 1;
+    return (fingerprint >> first) & mask;
+}
+
+bool DuplicateFilter::findNearDuplicate (const uint64 fingerprint) const
+{
+    for (size_t block = 0; block < tables.size(); ++block)
+    {
+        const auto bucket = tables[block].find (getBlock (fingerprint, block));
+        if (bucket == tables[block].end())
+            continue;
+
+        for (const uint64 other : bucket->second)
+            if (Fingerprint::getDistance (fingerprint, other) <= maxDistance)
+                return true;
+    }
+    return false;
+}
+
+//==============================================================================
+bool DuplicateFilter::insertIfUnique (const uint64 fingerprint)
+{
+    std::lock_guard<std::mutex> guard (lock);
+    if (findNearDuplicate (fingerprint))
+        return false;
+
+    for (size_t block = 0; block < tables.size(); ++block)
+        tables[block][getBlock (fingerprint, block)].push_back (fingerprint);
+
+    ++numFingerprints;
+    return true;
+}
+
+bool DuplicateFilter::containsNearDuplicate (const uint64 fingerprint) const
+{
+    std::lock_guard<std::mutex> guard (lock);
+    return findNearDuplicate (fingerprint);
+}
+
+void DuplicateFilter::clear()
+{
+    std::lock_guard<std::mutex> guard (lock);
+    for (auto& table : tables)
+        table.clear();
+    numFingerprints = 0;
+}
+
+size_t DuplicateFilter::size() const
+{
+    std::lock_guard<std::mutex> guard (lock);
+    return numFingerprints;
+}
+
+int DuplicateFilter::getMaxDistance() const
+{
+    return maxDistance;
+}
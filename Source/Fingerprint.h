@@ -0,0 +1,73 @@
+/*
+  ==============================================================================
+
+    Fingerprint.h
+    Created: 18 Oct 2026 11:41:15pm
+
+  ==============================================================================
+*/
+
+#ifndef FINGERPRINT_H_INCLUDED
+#define FINGERPRINT_H_INCLUDED
+
+#include <mutex>
+#include <unordered_map>
+#include "FeatureDistance.h"
+
+//==============================================================================
+/** A 64 bit SimHash (Charikar, 2002) of the MFCC summary of a render: bit i
+    is the side of a fixed random hyperplane the summary lies on. The mean
+    of the first coefficient is left out, it only follows the loudness.
+
+    The fraction of differing bits estimates the angle between two summaries
+    over pi, so renders that sound alike differ in few bits. The hyperplanes
+    never change, fingerprints from different runs and machines compare.
+*/
+namespace Fingerprint
+{
+    uint64 compute (const MFCCFeatures& frames);
+
+    template <typename SampleType>
+    uint64 compute (const FeatureSequence<SampleType>& frames);
+
+    int getDistance (const uint64 a, const uint64 b) noexcept;
+}
+
+//==============================================================================
+/** Remembers the fingerprints of everything let through and rejects any that
+    is within maxDistance bits of one of them. Safe to use from any thread.
+
+    Lookups split the fingerprint into maxDistance + 1 blocks. Two
+    fingerprints that close agree on at least one whole block, so only those
+    sharing a block are compared.
+*/
+class DuplicateFilter
+{
+public:
+    DuplicateFilter (const int maxDistance);
+
+    /** Returns true and remembers the fingerprint if nothing seen so far is
+        within maxDistance of it.
+    */
+    bool insertIfUnique (const uint64 fingerprint);
+
+    bool containsNearDuplicate (const uint64 fingerprint) const;
+
+    void clear();
+
+    size_t size() const;
+
+    int getMaxDistance() const;
+
+private:
+    bool findNearDuplicate (const uint64 fingerprint) const;
+
+    uint64 getBlock (const uint64 fingerprint, const size_t block) const;
+
+    const int                                                  maxDistance;
+    std::vector<std::unordered_map<uint64, std::vector<uint64>>> tables;
+    size_t                                                     numFingerprints;
+    mutable std::mutex                                         lock;
+};
+
+#endif  // FINGERPRINT_H_INCLUDED
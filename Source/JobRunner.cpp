@@ -0,0 +1,420 @@
+/*
+  ==============================================================================
+
+    JobRunner.cpp
+    Created: 18 Oct 2026 4:31:05pm
+
+  ==============================================================================
+*/
+
+#include "JobRunner.h"
+
+//==============================================================================
+JobJournal::JobJournal (const File&  journalFile,
+                        const uint64 numJobs,
+                        const size_t interval) :
+    file (journalFile),
+    syncInterval (jmax<size_t> (1, interval)),
+    completed (size_t (numJobs), false),
+    numCompleted (0),
+    numUnsynced (0)
+{
+    if (! load())
+        std::cout << "JobJournal error: Couldn't open " <<
+                     file.getFullPathName() << "." << std::endl;
+}
+
+//==============================================================================
+JobJournal::~JobJournal()
+{
+    sync();
+}
+
+//==============================================================================
+bool JobJournal::load()
+{
+    MemoryBlock contents;
+    if (file.existsAsFile() && ! file.loadFileAsData (contents))
+        return false;
+
+    // Everything after the last newline is a torn write.
+    const char* data = static_cast<const char*> (contents.getData());
+    int64 validLength = 0;
+    uint64 id = 0;
+    bool hasDigits = false;
+
+    for (size_t i = 0; i < contents.getSize(); ++i)
+    {
+        const char c = data[i];
+        if (c >= '0' && c <= '9')
+        {
+            id = id * 10 + uint64 (c - '0');
+            hasDigits = true;
+        }
+        else if (c == '\n')
+        {
+            if (hasDigits && id < completed.size() && ! completed[size_t (id)])
+            {
+                completed[size_t (id)] = true;
+                ++numCompleted;
+            }
+            validLength = int64 (i + 1);
+            id = 0;
+            hasDigits = false;
+        }
+    }
+
+    stream.reset (new FileOutputStream (file));
+    if (! stream->openedOk())
+    {
+        stream.reset();
+        return false;
+    }
+
+    if (validLength < stream->getPosition())
+    {
+        stream->setPosition (validLength);
+        stream->truncate();
+    }
+    return true;
+}
+
+//==============================================================================
+bool JobJournal::isOpen() const
+{
+    return stream != nullptr;
+}
+
+//==============================================================================
+bool JobJournal::isCompleted (const uint64 id) const
+{
+    std::lock_guard<std::mutex> guard (lock);
+    return id < completed.size() && completed[size_t (id)];
+}
+
+//==============================================================================
+uint64 JobJournal::getNumCompleted() const
+{
+    std::lock_guard<std::mutex> guard (lock);
+    return numCompleted;
+}
+
+//==============================================================================
+void JobJournal::append (const std::vector<uint64>& ids)
+{
+    std::lock_guard<std::mutex> guard (lock);
+
+    for (const uint64 id : ids)
+    {
+        if (id >= completed.size() || completed[size_t (id)])
+            continue;
+
+        completed[size_t (id)] = true;
+        ++numCompleted;
+        ++numUnsynced;
+
+        if (stream != nullptr)
+            *stream << String (id) << "\n";
+    }
+
+    if (numUnsynced >= syncInterval && stream != nullptr)
+    {
+        stream->flush();
+        syncFileToDisk (file);
+        numUnsynced = 0;
+    }
+}
+
+//==============================================================================
+bool JobJournal::sync()
+{
+    std::lock_guard<std::mutex> guard (lock);
+
+    if (stream == nullptr)
+        return false;
+
+    stream->flush();
+    numUnsynced = 0;
+    return stream->getStatus().wasOk() && syncFileToDisk (file);
+}
+
+//==============================================================================
+JobRunner::JobRunner (const JobSpec& jobSpec) :
+    spec (jobSpec),
+    shouldStop (false),
+    numCompleted (0),
+    numRendered (0),
+    numDuplicates (0)
+{
+}
+
+//==============================================================================
+void JobRunner::stop()
+{
+    shouldStop = true;
+}
+
+//==============================================================================
+uint64 JobRunner::getNumCompleted() const
+{
+    return numCompleted;
+}
+
+//==============================================================================
+uint64 JobRunner::getNumRenderedThisRun() const
+{
+    return numRendered;
+}
+
+//==============================================================================
+uint64 JobRunner::getNumDuplicatesThisRun() const
+{
+    return numDuplicates;
+}
+
+//==============================================================================
+std::unique_ptr<PatchSampler> JobRunner::createSampler (const int numParameters) const
+{
+    switch (spec.patchSource)
+    {
+        case PatchSource::sobol:
+            return std::unique_ptr<PatchSampler> (new SobolSampler (numParameters, spec.seed));
+        case PatchSource::latinHypercube:
+            return std::unique_ptr<PatchSampler> (new LatinHypercubeSampler (numParameters, spec.count, spec.seed));
+        case PatchSource::uniform:
+        default:
+            return std::unique_ptr<PatchSampler> (new UniformSampler (numParameters, spec.seed));
+    }
+}
+
+//==============================================================================
+PluginPatch JobRunner::getPatch (const PatchGenerator& generator,
+                                 const PatchSampler&   sampler,
+                                 const uint64          index) const
+{
+    return generator.getPatches (sampler, index, 1).front();
+}
+
+//==============================================================================
+bool JobRunner::checkSpecFile (const File&             directory,
+                               const PatchConstraints& constraints) const
+{
+    // Only what decides the content of the records, the number of engines or
+    // the shard size may change between runs.
+    DynamicObject::Ptr description (new DynamicObject());
+    description->setProperty ("plugin_path", String (spec.pluginPath));
+    description->setProperty ("patch_source", int (spec.patchSource));
+    description->setProperty ("seed", String (spec.seed));
+    description->setProperty ("count", String (spec.count));
+    description->setProperty ("sample_rate", spec.sampleRate);
+    description->setProperty ("buffer_size", spec.bufferSize);
+    description->setProperty ("fft_size", spec.fftSize);
+    description->setProperty ("midi_note", int (spec.render.midiNote));
+    description->setProperty ("midi_velocity", int (spec.render.midiVelocity));
+    description->setProperty ("note_length", spec.render.noteLength);
+    description->setProperty ("render_length", spec.render.renderLength);
+
+    // The constraints themselves rather than their path, editing the file
+    // changes the patches.
+    if (! constraints.isEmpty())
+        description->setProperty ("constraints", JSON::parse (constraints.toJSON()));
+
+    if (spec.duplicateThreshold >= 0)
+        description->setProperty ("duplicate_threshold", spec.duplicateThreshold);
+
+    const String json = JSON::toString (var (description.get()));
+    const File specFile = directory.getChildFile (String (spec.prefix) + ".job.json");
+
+    if (specFile.existsAsFile())
+    {
+        if (specFile.loadFileAsString() == json)
+            return true;
+
+        std::cout << "JobRunner error: " << specFile.getFullPathName() <<
+                     " was written for a different job, refusing to mix the two." << std::endl;
+        return false;
+    }
+
+    const File tempFile = specFile.getSiblingFile (specFile.getFileName() + ".tmp");
+    return tempFile.replaceWithText (json)
+            && syncFileToDisk (tempFile)
+            && tempFile.moveFileTo (specFile)
+            && syncFileToDisk (directory);
+}
+
+//==============================================================================
+bool JobRunner::run()
+{
+    shouldStop = false;
+    numRendered = 0;
+    numDuplicates = 0;
+
+    PatchConstraints constraints;
+    if (! spec.constraintsPath.empty() && ! constraints.load (spec.constraintsPath))
+        return false;
+
+    const File directory (File::getCurrentWorkingDirectory().getChildFile (String (spec.outputDirectory)));
+    if (! directory.createDirectory() || ! checkSpecFile (directory, constraints))
+        return false;
+
+    JobJournal journal (directory.getChildFile (String (spec.prefix) + ".journal"),
+                        spec.count,
+                        size_t (jmax (1, spec.journalSyncInterval)));
+    if (! journal.isOpen())
+        return false;
+
+    std::shared_ptr<DuplicateFilter> duplicates;
+    if (spec.duplicateThreshold >= 0)
+        duplicates = std::make_shared<DuplicateFilter> (spec.duplicateThreshold);
+
+    // The shards are the ground truth. A crash between renaming a shard and
+    // syncing the journal leaves records only the shard knows about. A
+    // resumed job keeps rejecting duplicates of the records already kept.
+    {
+        DatasetReader reader (spec.outputDirectory, spec.prefix);
+        for (size_t shard = 0; shard < reader.getNumShards(); ++shard)
+        {
+            const DatasetShardHeader& header = reader.getHeader (shard);
+            const uint64* ids = reader.getRecordIds (shard);
+            journal.append (std::vector<uint64> (ids, ids + header.numRecords));
+
+            const size_t recordSize = size_t (header.numMfccFrames) * header.numMfccCoefficients;
+            for (uint64 record = 0; duplicates != nullptr && record < header.numRecords; ++record)
+            {
+                const FeatureSequence<float> frames (reader.getMfcc (shard) + record * recordSize,
+                                                     header.numMfccFrames, header.numMfccCoefficients);
+                duplicates->insertIfUnique (Fingerprint::compute (frames));
+            }
+        }
+        journal.sync();
+    }
+
+    numCompleted = journal.getNumCompleted();
+    if (numCompleted == spec.count)
+        return true;
+
+    RenderPool pool (spec.numEngines, spec.sampleRate, spec.bufferSize, spec.fftSize);
+    if (! pool.loadPlugin (spec.pluginPath))
+        return false;
+
+    PatchGenerator generator (pool.getEngine (0));
+    generator.setConstraints (constraints);
+    const std::unique_ptr<PatchSampler> sampler = createSampler (int (generator.getNumParameters()));
+
+    // A rejected duplicate is done, but only once the record it duplicates
+    // is on disk. It is held back until every record kept before it has been
+    // written, a shard that failed to write holds back all that follow.
+    std::mutex duplicatesLock;
+    std::deque<uint64> unwrittenKept;
+    std::deque<std::pair<uint64, uint64>> pendingDuplicates;
+    uint64 numKept = 0;
+    uint64 numKeptWritten = 0;
+    bool lostShard = false;
+
+    const auto takeWrittenDuplicates = [&] (std::vector<uint64>& done)
+    {
+        while (! lostShard && ! pendingDuplicates.empty()
+                && pendingDuplicates.front().first <= numKeptWritten)
+        {
+            done.push_back (pendingDuplicates.front().second);
+            pendingDuplicates.pop_front();
+        }
+    };
+
+    DatasetWriter writer (spec.outputDirectory,
+                          spec.prefix,
+                          size_t (jmax (1, spec.recordsPerShard)));
+    writer.setShardCallback ([&] (const File&, const std::vector<uint64>& ids)
+    {
+        std::vector<uint64> done (ids);
+        {
+            std::lock_guard<std::mutex> guard (duplicatesLock);
+
+            // Shards hold the kept records in the order they were added.
+            lostShard = lostShard || unwrittenKept.empty() || unwrittenKept.front() != ids.front();
+            if (! lostShard)
+            {
+                unwrittenKept.erase (unwrittenKept.begin(), unwrittenKept.begin() + std::ptrdiff_t (ids.size()));
+                numKeptWritten += ids.size();
+            }
+            takeWrittenDuplicates (done);
+        }
+        journal.append (done);
+        numCompleted = journal.getNumCompleted();
+    });
+
+    const size_t batchSize = size_t (pool.getNumEngines()) * 16;
+    std::vector<uint64> ids;
+    std::vector<PluginPatch> patches;
+    std::vector<RenderResult> results;
+    std::vector<uint64> fingerprints;
+    uint64 next = 0;
+
+    while (next < spec.count && ! shouldStop)
+    {
+        ids.clear();
+        patches.clear();
+
+        for (; next < spec.count && ids.size() < batchSize; ++next)
+        {
+            if (journal.isCompleted (next))
+                continue;
+
+            ids.push_back (next);
+            patches.push_back (getPatch (generator, *sampler, next));
+        }
+
+        results.clear();
+        results.resize (ids.size());
+        fingerprints.assign (ids.size(), 0);
+
+        pool.renderPatches (patches, spec.render, [&] (size_t index, RenderResult&& result)
+        {
+            // Fingerprinted from the floats a shard stores, the same data a
+            // resumed job fingerprints the kept records from.
+            if (duplicates != nullptr && result.isValid())
+                fingerprints[index] = DatasetWriter::getStoredFingerprint (*result);
+
+            results[index] = std::move (result);
+            ++numRendered;
+        });
+
+        // Duplicates are decided in record order, whatever order the engines
+        // finished in, so the same twin is kept on every run.
+        for (size_t i = 0; i < ids.size(); ++i)
+        {
+            if (duplicates != nullptr && results[i].isValid()
+                 && ! duplicates->insertIfUnique (fingerprints[i]))
+            {
+                std::lock_guard<std::mutex> guard (duplicatesLock);
+                pendingDuplicates.push_back ({ numKept, ids[i] });
+                ++numDuplicates;
+                continue;
+            }
+
+            // Noted before queueing, the shard may be written before add returns.
+            if (results[i].isValid())
+            {
+                std::lock_guard<std::mutex> guard (duplicatesLock);
+                unwrittenKept.push_back (ids[i]);
+                ++numKept;
+            }
+            writer.add (ids[i], patches[i], std::move (results[i]));
+        }
+    }
+
+    writer.flush();
+
+    // Duplicates of records kept by earlier runs, with nothing kept after.
+    {
+        std::vector<uint64> done;
+        {
+            std::lock_guard<std::mutex> guard (duplicatesLock);
+            takeWrittenDuplicates (done);
+        }
+        journal.append (done);
+    }
+    journal.sync();
+    numCompleted = journal.getNumCompleted();
+    return numCompleted == spec.count;
+}
@@ -0,0 +1,134 @@
+/*
+  ==============================================================================
+
+    JobRunner.h
+    Created: 18 Oct 2026 4:31:05pm
+
+  ==============================================================================
+*/
+
+#ifndef JOBRUNNER_H_INCLUDED
+#define JOBRUNNER_H_INCLUDED
+
+#include "Dataset.h"
+#include "PatchGenerator.h"
+#include "RenderPool.h"
+
+//==============================================================================
+/** Where the patches of a job come from. Patch i only ever depends on the
+    seed and i, so a job can be resumed from any point.
+*/
+enum class PatchSource
+{
+    uniform,
+    sobol,
+    latinHypercube
+};
+
+//==============================================================================
+/** Everything that defines a dataset generation job. The fields that decide
+    which patches are rendered and how are stored next to the data, and a
+    resumed job has to match them.
+*/
+struct JobSpec
+{
+    std::string    pluginPath;
+    PatchSource    patchSource = PatchSource::uniform;
+    uint64         seed = 0;
+    uint64         count = 0;
+    std::string    outputDirectory;
+    std::string    prefix = "data";
+    RenderSettings render;
+    int            numEngines = 1;
+    int            sampleRate = 44100;
+    int            bufferSize = 512;
+    int            fftSize = 512;
+    int            recordsPerShard = 1024;
+    int            journalSyncInterval = 1024;
+    std::string    constraintsPath;
+
+    // Renders whose fingerprint is within this many bits of a kept one are
+    // dropped, and count as done once the kept one is on disk. -1 keeps
+    // everything.
+    int            duplicateThreshold = -1;
+};
+
+//==============================================================================
+/** Append-only record of the completed job ids, one per line. Appends are
+    buffered and only synced to disk every syncInterval ids, a torn last line
+    left by a crash is dropped when the journal is opened again.
+*/
+class JobJournal
+{
+public:
+    JobJournal (const File& file,
+                const uint64 numJobs,
+                const size_t syncInterval);
+
+    ~JobJournal();
+
+    bool isOpen() const;
+
+    bool isCompleted (const uint64 id) const;
+
+    uint64 getNumCompleted() const;
+
+    /** Safe to call from any thread. Ids that are already in the journal or
+        outside [0, numJobs) are ignored.
+    */
+    void append (const std::vector<uint64>& ids);
+
+    bool sync();
+
+private:
+    bool load();
+
+    const File                        file;
+    const size_t                      syncInterval;
+    mutable std::mutex                lock;
+    std::unique_ptr<FileOutputStream> stream;
+    std::vector<bool>                 completed;
+    uint64                            numCompleted;
+    size_t                            numUnsynced;
+};
+
+//==============================================================================
+/** Renders a job into a sharded dataset, journalling every record once the
+    shard holding it is safely on disk. Running the same spec again after a
+    crash skips the completed records and renders exactly the patches that
+    are missing.
+*/
+class JobRunner
+{
+public:
+    JobRunner (const JobSpec& spec);
+
+    /** Returns true once every record of the job is on disk. */
+    bool run();
+
+    /** Asks a running job to stop after the batch it is rendering. */
+    void stop();
+
+    uint64 getNumCompleted() const;
+
+    uint64 getNumRenderedThisRun() const;
+
+    uint64 getNumDuplicatesThisRun() const;
+
+private:
+    std::unique_ptr<PatchSampler> createSampler (const int numParameters) const;
+
+    PluginPatch getPatch (const PatchGenerator& generator,
+                          const PatchSampler&   sampler,
+                          const uint64          index) const;
+
+    bool checkSpecFile (const File& directory, const PatchConstraints& constraints) const;
+
+    const JobSpec       spec;
+    std::atomic<bool>   shouldStop;
+    std::atomic<uint64> numCompleted;
+    std::atomic<uint64> numRendered;
+    std::atomic<uint64> numDuplicates;
+};
+
+#endif  // JOBRUNNER_H_INCLUDED
@@ -71,6 +71,17 @@ void maxiFFT::setup(int _fftSize, int _windowSize, int _hopSize) {
 	fft::genWindow(3, windowSize, window);
 }
 
+void maxiFFT::reset() {
+	//forget everything processed so far, as if setup had just been called
+	memset(buffer, 0, fftSize * sizeof(float));
+	memset(magnitudes, 0, bins * sizeof(float));
+	memset(magnitudesDB, 0, bins * sizeof(float));
+	memset(phases, 0, bins * sizeof(float));
+	*avgPower = 0;
+	pos = windowSize - hopSize;
+	newFFT = 0;
+}
+
 bool maxiFFT::process(float value) {
 	//add value to buffer at current pos
 	buffer[pos++] = value;
@@ -48,6 +48,7 @@ public:
 	};
 	~maxiFFT();
 	void setup(int fftSize, int windowSize, int hopSize);
+	void reset();
 	bool process(float value);
 	float* magsToDB();
 	float *magnitudes, *phases, *magnitudesDB;
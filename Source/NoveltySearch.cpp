@@ -0,0 +1,184 @@
+/*
+  ==============================================================================
+
+    NoveltySearch.cpp
+    Created: 18 Oct 2026 11:52:37pm
+
+  ==============================================================================
+*/
+
+#include <random>
+#include "NoveltySearch.h"
+
+static const size_t summaryDimensions = 2 * std::tuple_size<MFCCFeatures::value_type>::value;
+
+//==============================================================================
+NoveltySearch::NoveltySearch (RenderPool&           pool,
+                              const RenderSettings& settings) :
+    renderPool (pool),
+    renderSettings (settings),
+    generator (pool.getEngine (0)),
+    index (new FeatureIndex (summaryDimensions)),
+    numUniform (0),
+    shouldStop (false)
+{
+    archive = generator.getPatchMatrix ({});
+}
+
+//==============================================================================
+PatchGenerator& NoveltySearch::getGenerator()
+{
+    return generator;
+}
+
+//==============================================================================
+void NoveltySearch::stop()
+{
+    shouldStop = true;
+}
+
+//==============================================================================
+size_t NoveltySearch::getArchiveSize() const
+{
+    return index->size();
+}
+
+void NoveltySearch::clearArchive()
+{
+    index.reset (new FeatureIndex (summaryDimensions));
+    archive.values.clear();
+    archiveSummaries.clear();
+    numUniform = 0;
+}
+
+//==============================================================================
+double NoveltySearch::getNovelty (const float* summary, const size_t k) const
+{
+    const std::vector<FeatureIndex::Neighbour> neighbours = index->search (summary, k);
+    if (neighbours.empty())
+        return std::numeric_limits<double>::max();
+
+    double total = 0.0;
+    for (const auto& neighbour : neighbours)
+        total += neighbour.distance;
+    return total / double (neighbours.size());
+}
+
+double NoveltySearch::getArchivedNovelty (const size_t entry, const size_t k) const
+{
+    const std::vector<FeatureIndex::Neighbour> neighbours =
+        index->search (archiveSummaries.data() + entry * summaryDimensions, k + 1);
+
+    double total = 0.0;
+    size_t count = 0;
+    for (const auto& neighbour : neighbours)
+    {
+        if (neighbour.id == uint64 (entry) || count == k)
+            continue;
+
+        total += neighbour.distance;
+        ++count;
+    }
+    return count > 0 ? total / double (count) : std::numeric_limits<double>::max();
+}
+
+//==============================================================================
+std::vector<PluginPatch> NoveltySearch::run (const size_t           numPatches,
+                                             const NoveltySettings& settings,
+                                             const ResultCallback&  onRendered)
+{
+    shouldStop = false;
+
+    const size_t batchSize = size_t (jmax (1, settings.batchSize));
+    const size_t numNeighbours = size_t (jmax (1, settings.numNeighbours));
+
+    std::mt19937_64 random (settings.seed);
+    std::binomial_distribution<size_t> numExplored (batchSize, jlimit (0.0, 1.0, settings.explorationRate));
+
+    std::vector<PluginPatch> patches;
+    patches.reserve (numPatches);
+
+    // The archive only needs the features, whoever gets the results may
+    // want the audio.
+    RenderSettings batchSettings = renderSettings;
+    batchSettings.needsAudio = onRendered != nullptr;
+
+    std::vector<float> summaries;
+    std::vector<char> isRendered;
+
+    while (patches.size() < numPatches && ! shouldStop)
+    {
+        const size_t count = jmin (batchSize, numPatches - patches.size());
+        const size_t archiveSize = getArchiveSize();
+
+        // Until every render has neighbours to be compared with, the whole
+        // batch is uniform.
+        const size_t numFresh = archiveSize > numNeighbours ? jmin (count, numExplored (random)) : count;
+        PatchMatrix batch = generator.getPatchMatrix (generator.getRandomPatches (settings.seed, numUniform, numFresh));
+        numUniform += numFresh;
+
+        PatchMatrix parents;
+        parents.parameterIndices = archive.parameterIndices;
+        std::uniform_int_distribution<size_t> pickEntry (0, jmax (size_t (1), archiveSize) - 1);
+
+        for (size_t i = numFresh; i < count; ++i)
+        {
+            size_t parent = pickEntry (random);
+            double parentNovelty = getArchivedNovelty (parent, numNeighbours);
+            for (int round = 1; round < settings.tournamentSize; ++round)
+            {
+                const size_t challenger = pickEntry (random);
+                const double novelty = getArchivedNovelty (challenger, numNeighbours);
+                if (novelty > parentNovelty)
+                {
+                    parent = challenger;
+                    parentNovelty = novelty;
+                }
+            }
+            parents.values.insert (parents.values.end(), archive.getRow (parent),
+                                   archive.getRow (parent) + archive.getNumParameters());
+        }
+
+        if (parents.getNumPatches() > 0)
+        {
+            const PatchMatrix children = generator.mutate (parents, parents.getNumPatches(), settings.numMutated,
+                                                           float (settings.mutationStrength), random());
+            batch.values.insert (batch.values.end(), children.values.begin(), children.values.end());
+        }
+
+        const std::vector<PluginPatch> batchPatches = batch.getPatches();
+        summaries.assign (count * summaryDimensions, 0.0f);
+        isRendered.assign (count, 0);
+
+        const size_t firstIndex = patches.size();
+        renderPool.renderPatches (batchPatches, batchSettings, [&] (size_t i, RenderResult&& result)
+        {
+            if (result.isValid() && ! result->mfccFeatures.empty())
+            {
+                const std::vector<float> summary = FeatureDistance::getSummary (FeatureDistance::fromMfcc (result->mfccFeatures));
+                std::copy (summary.begin(), summary.end(), summaries.begin() + long (i * summaryDimensions));
+                isRendered[i] = 1;
+            }
+
+            if (onRendered != nullptr)
+                onRendered (firstIndex + i, batchPatches[i], std::move (result));
+        });
+
+        // Archived in patch order rather than the order the renders finished
+        // in, so the next generation doesn't depend on the engines.
+        for (size_t i = 0; i < count; ++i)
+        {
+            if (! isRendered[i])
+                continue;
+
+            const float* summary = summaries.data() + i * summaryDimensions;
+            index->add (uint64 (getArchiveSize()), summary);
+            archive.values.insert (archive.values.end(), batch.getRow (i), batch.getRow (i) + batch.getNumParameters());
+            archiveSummaries.insert (archiveSummaries.end(), summary, summary + summaryDimensions);
+        }
+
+        patches.insert (patches.end(), batchPatches.begin(), batchPatches.end());
+    }
+
+    return patches;
+}
@@ -0,0 +1,99 @@
+/*
+  ==============================================================================
+
+    NoveltySearch.h
+    Created: 18 Oct 2026 11:52:37pm
+
+  ==============================================================================
+*/
+
+#ifndef NOVELTYSEARCH_H_INCLUDED
+#define NOVELTYSEARCH_H_INCLUDED
+
+#include <atomic>
+#include "RenderPool.h"
+#include "PatchGenerator.h"
+#include "FeatureIndex.h"
+
+//==============================================================================
+/** Settings of a novelty search. Every generation renders batchSize patches,
+    a share explorationRate of them drawn uniformly and the rest mutated from
+    parents picked by tournaments of tournamentSize on their novelty, the mean
+    distance to their numNeighbours nearest renders. Mutation moves numMutated
+    parameters by a Gaussian step of mutationStrength times their range, see
+    PatchGenerator::mutate.
+*/
+struct NoveltySettings
+{
+    int    batchSize = 64;
+    int    numNeighbours = 15;
+    int    tournamentSize = 4;
+    double explorationRate = 0.25;
+    int    numMutated = 2;
+    double mutationStrength = 0.1;
+    uint64 seed = 0;
+};
+
+//==============================================================================
+/** Samples patches where the sound changes, rather than evenly over the
+    parameters. An archive keeps the MFCC summary of every render in a
+    FeatureIndex; patches whose renders lie in sparse regions of feature space
+    are the likeliest parents of the next generation, so renders pile up where
+    small parameter changes give new sounds (Lehman and Stanley, "Abandoning
+    Objectives").
+
+    Generations are rendered as batches on the pool. The archive, and the
+    position in the stream of uniform patches, carry over from one call of
+    run to the next, so a dataset can be grown in steps.
+*/
+class NoveltySearch
+{
+public:
+    /** Called on the rendering thread for every render, with its index in
+        this call of run and the patch it was rendered from.
+    */
+    typedef std::function<void (size_t, const PluginPatch&, RenderResult&&)> ResultCallback;
+
+    NoveltySearch (RenderPool&           pool,
+                   const RenderSettings& settings);
+
+    PatchGenerator& getGenerator();
+
+    /** Renders numPatches patches and returns them in the order they were
+        made. With the same settings and archive the patches are the same,
+        whichever engines render them.
+    */
+    std::vector<PluginPatch> run (const size_t           numPatches,
+                                  const NoveltySettings& settings,
+                                  const ResultCallback&  onRendered = nullptr);
+
+    /** Safe to call from any thread, run returns after the current
+        generation.
+    */
+    void stop();
+
+    /** The mean distance from the summary to its k nearest renders. */
+    double getNovelty (const float* summary, const size_t k) const;
+
+    size_t getArchiveSize() const;
+
+    /** Forgets every render, the next run starts from the first uniform
+        patches again.
+    */
+    void clearArchive();
+
+private:
+    /** The novelty of an archived render, leaving the render itself out. */
+    double getArchivedNovelty (const size_t entry, const size_t k) const;
+
+    RenderPool&                   renderPool;
+    RenderSettings                renderSettings;
+    PatchGenerator                generator;
+    std::unique_ptr<FeatureIndex> index;
+    PatchMatrix                   archive;
+    std::vector<float>            archiveSummaries;
+    uint64                        numUniform;
+    std::atomic<bool>             shouldStop;
+};
+
+#endif  // NOVELTYSEARCH_H_INCLUDED
@@ -0,0 +1,374 @@
+/*
+  ==============================================================================
+
+    PatchConstraints.cpp
+    Created: 18 Oct 2026 7:48:21pm
+
+  ==============================================================================
+*/
+
+#include "PatchConstraints.h"
+
+//==============================================================================
+static double normalCdf (const double x)
+{
+    return 0.5 * std::erfc (-x / std::sqrt (2.0));
+}
+
+//==============================================================================
+// Acklam's rational approximation, polished with one Halley step.
+static double inverseNormalCdf (const double p)
+{
+    static const double a[] = { -3.969683028665376e+01,  2.209460984245205e+02, -2.759285104469687e+02,
+                                 1.383577518672690e+02, -3.066479806614716e+01,  2.506628277459239e+00 };
+    static const double b[] = { -5.447609879822406e+01,  1.615858368580409e+02, -1.556989798598866e+02,
+                                 6.680131188771972e+01, -1.328068155288572e+01 };
+    static const double c[] = { -7.784894002430293e-03, -3.223964580411365e-01, -2.400758277161838e+00,
+                                -2.549732539343734e+00,  4.374664141464968e+00,  2.938163982698783e+00 };
+    static const double d[] = {  7.784695709041462e-03,  3.224671290700398e-01,  2.445134137142996e+00,
+                                 3.754408661907416e+00 };
+
+    const double clamped = jlimit (1.0e-300, 1.0 - 1.0e-16, p);
+    const double lowBreak = 0.02425;
+    double x;
+
+    if (clamped < lowBreak)
+    {
+        const double q = std::sqrt (-2.0 * std::log (clamped));
+        x = (((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+            ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    else if (clamped > 1.0 - lowBreak)
+    {
+        const double q = std::sqrt (-2.0 * std::log (1.0 - clamped));
+        x = -(((((c[0] * q + c[1]) * q + c[2]) * q + c[3]) * q + c[4]) * q + c[5]) /
+             ((((d[0] * q + d[1]) * q + d[2]) * q + d[3]) * q + 1.0);
+    }
+    else
+    {
+        const double q = clamped - 0.5;
+        const double r = q * q;
+        x = (((((a[0] * r + a[1]) * r + a[2]) * r + a[3]) * r + a[4]) * r + a[5]) * q /
+            (((((b[0] * r + b[1]) * r + b[2]) * r + b[3]) * r + b[4]) * r + 1.0);
+    }
+
+    const double error = normalCdf (x) - clamped;
+    const double u = error * std::sqrt (2.0 * MathConstants<double>::pi) * std::exp (x * x / 2.0);
+    return x - u / (1.0 + x * u / 2.0);
+}
+
+//==============================================================================
+void PatchConstraints::setConstraint (const int index, const ParameterConstraint& constraint)
+{
+    constraints[index] = constraint;
+}
+
+//==============================================================================
+void PatchConstraints::removeConstraint (const int index)
+{
+    constraints.erase (index);
+}
+
+//==============================================================================
+void PatchConstraints::clear()
+{
+    constraints.clear();
+}
+
+//==============================================================================
+bool PatchConstraints::isEmpty() const
+{
+    return constraints.empty();
+}
+
+//==============================================================================
+const ParameterConstraint* PatchConstraints::getConstraint (const int index) const
+{
+    const auto found = constraints.find (index);
+    return found != constraints.end() ? &found->second : nullptr;
+}
+
+//==============================================================================
+float PatchConstraints::apply (const int index, const float uniformValue) const
+{
+    const ParameterConstraint* constraint = getConstraint (index);
+    return constraint != nullptr ? applyConstraint (*constraint, uniformValue) : uniformValue;
+}
+
+//==============================================================================
+void PatchConstraints::apply (PluginPatch& patch) const
+{
+    if (constraints.empty())
+        return;
+
+    for (auto& parameter : patch)
+        parameter.second = apply (parameter.first, parameter.second);
+}
+
+//==============================================================================
+float PatchConstraints::applyConstraint (const ParameterConstraint& constraint,
+                                         const float                uniformValue)
+{
+    if (constraint.isFixed)
+        return constraint.fixedValue;
+
+    const double low = jmin (constraint.minimum, constraint.maximum);
+    const double high = jmax (constraint.minimum, constraint.maximum);
+    const double u = jlimit (0.0, 1.0, double (uniformValue));
+    const int numSteps = getNumSteps (constraint);
+
+    auto stepValue = [&] (const int step)
+    {
+        return numSteps < 2 ? low : low + (high - low) * step / (numSteps - 1);
+    };
+
+    double value = low + (high - low) * u;
+
+    switch (constraint.distribution)
+    {
+        case ParameterDistribution::uniform:
+            // Every step gets an equal share, rounding would halve the ends.
+            if (numSteps >= 2)
+                return float (stepValue (jmin (int (u * numSteps), numSteps - 1)));
+            break;
+
+        case ParameterDistribution::normal:
+        {
+            // Truncated to the range by only inverting the part inside it.
+            const double deviation = jmax (1.0e-9, double (constraint.standardDeviation));
+            const double lowCdf = normalCdf ((low - constraint.mean) / deviation);
+            const double highCdf = normalCdf ((high - constraint.mean) / deviation);
+            value = constraint.mean + deviation * inverseNormalCdf (lowCdf + u * (highCdf - lowCdf));
+            break;
+        }
+
+        case ParameterDistribution::logarithmic:
+        {
+            // Log spacing needs a positive lower end.
+            const double floor = jmax (low, jmax (high, 1.0) * 1.0e-6);
+            value = floor * std::pow (high / floor, u);
+            break;
+        }
+
+        case ParameterDistribution::categorical:
+        {
+            if (numSteps < 2)
+                break;
+
+            double total = 0.0;
+            for (int i = 0; i < numSteps; ++i)
+                total += i < int (constraint.weights.size()) ? jmax (0.0f, constraint.weights[size_t (i)]) : 1.0;
+
+            double target = u * total;
+            for (int i = 0; i < numSteps; ++i)
+            {
+                target -= i < int (constraint.weights.size()) ? jmax (0.0f, constraint.weights[size_t (i)]) : 1.0;
+                if (target < 0.0)
+                    return float (stepValue (i));
+            }
+            return float (stepValue (numSteps - 1));
+        }
+    }
+
+    value = jlimit (low, high, value);
+
+    if (numSteps >= 2)
+        value = stepValue (roundToInt ((value - low) / (high - low) * (numSteps - 1)));
+
+    return float (value);
+}
+
+//==============================================================================
+int PatchConstraints::getNumSteps (const ParameterConstraint& constraint)
+{
+    return constraint.distribution == ParameterDistribution::categorical && constraint.numSteps < 2
+            ? int (constraint.weights.size())
+            : constraint.numSteps;
+}
+
+//==============================================================================
+float PatchConstraints::constrain (const int index, const float value) const
+{
+    const ParameterConstraint* constraint = getConstraint (index);
+    if (constraint == nullptr)
+        return jlimit (0.0f, 1.0f, value);
+
+    if (constraint->isFixed)
+        return constraint->fixedValue;
+
+    const Range<float> range = getRange (index);
+    const float stepSize = getStepSize (index);
+    const float clamped = range.clipValue (value);
+
+    if (stepSize <= 0.0f)
+        return clamped;
+
+    return range.getStart() + stepSize * float (roundToInt ((clamped - range.getStart()) / stepSize));
+}
+
+//==============================================================================
+Range<float> PatchConstraints::getRange (const int index) const
+{
+    const ParameterConstraint* constraint = getConstraint (index);
+    if (constraint == nullptr)
+        return Range<float> (0.0f, 1.0f);
+
+    return Range<float>::between (constraint->minimum, constraint->maximum);
+}
+
+//==============================================================================
+float PatchConstraints::getStepSize (const int index) const
+{
+    const ParameterConstraint* constraint = getConstraint (index);
+    if (constraint == nullptr)
+        return 0.0f;
+
+    const int numSteps = getNumSteps (*constraint);
+    return numSteps >= 2 ? getRange (index).getLength() / float (numSteps - 1) : 0.0f;
+}
+
+//==============================================================================
+bool PatchConstraints::isFixed (const int index) const
+{
+    const ParameterConstraint* constraint = getConstraint (index);
+    return constraint != nullptr && constraint->isFixed;
+}
+
+//==============================================================================
+static const char* getDistributionName (const ParameterDistribution distribution)
+{
+    switch (distribution)
+    {
+        case ParameterDistribution::normal:      return "normal";
+        case ParameterDistribution::logarithmic: return "log";
+        case ParameterDistribution::categorical: return "categorical";
+        case ParameterDistribution::uniform:
+        default:                                 return "uniform";
+    }
+}
+
+//==============================================================================
+String PatchConstraints::toJSON() const
+{
+    Array<var> parameters;
+
+    for (const auto& entry : constraints)
+    {
+        const ParameterConstraint& constraint = entry.second;
+        DynamicObject::Ptr object (new DynamicObject());
+
+        object->setProperty ("index", entry.first);
+        object->setProperty ("min", constraint.minimum);
+        object->setProperty ("max", constraint.maximum);
+        object->setProperty ("steps", constraint.numSteps);
+        object->setProperty ("distribution", getDistributionName (constraint.distribution));
+
+        if (constraint.distribution == ParameterDistribution::normal)
+        {
+            object->setProperty ("mean", constraint.mean);
+            object->setProperty ("std", constraint.standardDeviation);
+        }
+
+        if (! constraint.weights.empty())
+        {
+            Array<var> weights;
+            for (const float weight : constraint.weights)
+                weights.add (weight);
+            object->setProperty ("weights", weights);
+        }
+
+        if (constraint.isFixed)
+            object->setProperty ("fixed", constraint.fixedValue);
+
+        parameters.add (var (object.get()));
+    }
+
+    DynamicObject::Ptr root (new DynamicObject());
+    root->setProperty ("parameters", parameters);
+    return JSON::toString (var (root.get()));
+}
+
+//==============================================================================
+bool PatchConstraints::fromJSON (const String& json)
+{
+    var root;
+    const Result result = JSON::parse (json, root);
+    const Array<var>* parameters = root["parameters"].getArray();
+
+    if (result.failed() || parameters == nullptr)
+    {
+        std::cout << "PatchConstraints error: Couldn't parse the constraints. " <<
+                     result.getErrorMessage() << std::endl;
+        return false;
+    }
+
+    std::map<int, ParameterConstraint> parsed;
+
+    for (const var& object : *parameters)
+    {
+        if (! object.hasProperty ("index"))
+        {
+            std::cout << "PatchConstraints error: A constraint has no index." << std::endl;
+            return false;
+        }
+
+        ParameterConstraint constraint;
+        constraint.minimum = float (object.getProperty ("min", 0.0));
+        constraint.maximum = float (object.getProperty ("max", 1.0));
+        constraint.numSteps = int (object.getProperty ("steps", 0));
+        constraint.mean = float (object.getProperty ("mean", 0.5));
+        constraint.standardDeviation = float (object.getProperty ("std", 0.15));
+
+        const String distribution = object.getProperty ("distribution", "uniform").toString();
+        if (distribution == "uniform")          constraint.distribution = ParameterDistribution::uniform;
+        else if (distribution == "normal")      constraint.distribution = ParameterDistribution::normal;
+        else if (distribution == "log")         constraint.distribution = ParameterDistribution::logarithmic;
+        else if (distribution == "categorical") constraint.distribution = ParameterDistribution::categorical;
+        else
+        {
+            std::cout << "PatchConstraints::fromJSON error: Unknown distribution \"" <<
+                         distribution << "\" for parameter " << int (object["index"]) << "." << std::endl;
+            return false;
+        }
+
+        if (const Array<var>* weights = object["weights"].getArray())
+            for (const var& weight : *weights)
+                constraint.weights.push_back (float (weight));
+
+        if (object.hasProperty ("fixed"))
+        {
+            constraint.isFixed = true;
+            constraint.fixedValue = float (object["fixed"]);
+        }
+
+        parsed[int (object["index"])] = constraint;
+    }
+
+    constraints.swap (parsed);
+    return true;
+}
+
+//==============================================================================
+bool PatchConstraints::save (const std::string& path) const
+{
+    const File file (File::getCurrentWorkingDirectory().getChildFile (String (path)));
+    if (file.replaceWithText (toJSON()))
+        return true;
+
+    std::cout << "PatchConstraints error: Couldn't write " <<
+                 file.getFullPathName() << "." << std::endl;
+    return false;
+}
+
+//==============================================================================
+bool PatchConstraints::load (const std::string& path)
+{
+    const File file (File::getCurrentWorkingDirectory().getChildFile (String (path)));
+    if (! file.existsAsFile())
+    {
+        std::cout << "PatchConstraints error: " << file.getFullPathName() <<
+                     " doesn't exist." << std::endl;
+        return false;
+    }
+    return fromJSON (file.loadFileAsString());
+}
@@ -0,0 +1,106 @@
+/*
+  ==============================================================================
+
+    PatchConstraints.h
+    Created: 18 Oct 2026 7:48:21pm
+
+  ==============================================================================
+*/
+
+#ifndef PATCHCONSTRAINTS_H_INCLUDED
+#define PATCHCONSTRAINTS_H_INCLUDED
+
+#include <map>
+#include <string>
+#include <vector>
+#include "RenderResult.h"
+
+//==============================================================================
+enum class ParameterDistribution
+{
+    uniform,
+    normal,
+    logarithmic,
+    categorical
+};
+
+//==============================================================================
+/** Limits what a generator may set one parameter to. Values are drawn between
+    minimum and maximum from the distribution, then snapped to one of numSteps
+    evenly spaced values if numSteps is 2 or more. Categorical weights give the
+    relative probability of every step. A fixed parameter always gets
+    fixedValue.
+*/
+struct ParameterConstraint
+{
+    float                 minimum = 0.0f;
+    float                 maximum = 1.0f;
+    int                   numSteps = 0;
+    ParameterDistribution distribution = ParameterDistribution::uniform;
+    float                 mean = 0.5f;
+    float                 standardDeviation = 0.15f;
+    std::vector<float>    weights;
+    bool                  isFixed = false;
+    float                 fixedValue = 0.0f;
+};
+
+//==============================================================================
+/** A constraint per parameter index, applied by mapping uniform values in
+    [0, 1) through each constraint's inverse distribution. Because the mapping
+    is monotonic, quasi-random samplers keep their even coverage inside the
+    constrained ranges.
+
+    The set can be saved to and loaded from JSON so several jobs share it.
+*/
+class PatchConstraints
+{
+public:
+    void setConstraint (const int index, const ParameterConstraint& constraint);
+
+    void removeConstraint (const int index);
+
+    void clear();
+
+    bool isEmpty() const;
+
+    const ParameterConstraint* getConstraint (const int index) const;
+
+    /** The value of the parameter for a uniform value in [0, 1). Parameters
+        without a constraint get the uniform value itself.
+    */
+    float apply (const int index, const float uniformValue) const;
+
+    /** Replaces every value of the patch, which holds uniform values, in place. */
+    void apply (PluginPatch& patch) const;
+
+    /** The value clamped to the parameter's range and snapped to the nearest
+        of its steps, or its fixed value. Parameters without a constraint are
+        clamped to [0, 1].
+    */
+    float constrain (const int index, const float value) const;
+
+    /** Minimum and maximum of the parameter, 0 and 1 without a constraint. */
+    Range<float> getRange (const int index) const;
+
+    /** The distance between neighbouring steps, 0 for a continuous parameter. */
+    float getStepSize (const int index) const;
+
+    bool isFixed (const int index) const;
+
+    String toJSON() const;
+
+    bool fromJSON (const String& json);
+
+    bool save (const std::string& path) const;
+
+    bool load (const std::string& path);
+
+private:
+    static float applyConstraint (const ParameterConstraint& constraint, const float uniformValue);
+
+    static int getNumSteps (const ParameterConstraint& constraint);
+
+    std::map<int, ParameterConstraint> constraints;
+};
+
+#endif  // PATCHCONSTRAINTS_H_INCLUDED
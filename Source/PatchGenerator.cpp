@@ -9,21 +9,334 @@
 */
 
 #include "PatchGenerator.h"
+#include "Philox.h"
 
-//==============================================================================
-std::pair<int, float> PatchGenerator::getRandomParameter (int index)
-{
-    std::uniform_real_distribution<float> distribution (0, 1);
-    float randomValue = distribution (generator);
-    return std::make_pair (index, randomValue);
-}
-
-//==============================================================================
-PluginPatch PatchGenerator::getRandomPatch()
-{
-    PluginPatch randomPatch = skeletonPatch;
-    std::uniform_real_distribution<float> distribution (0, 1);
-    for (auto& parameter : randomPatch)
-        parameter.second = distribution (generator);
-    return randomPatch;
-}
+//==============================================================================
+std::pair<int, float> PatchGenerator::getRandomParameter (int index)
+{
+    // The last counter word keeps these apart from the values of the patches.
+    const uint64 patchIndex = nextPatchIndex++;
+    const Philox::Key key = {{ uint32 (streamSeed), uint32 (streamSeed >> 32) }};
+    const Philox::Counter bits = Philox::generate ({{ uint32 (patchIndex), uint32 (patchIndex >> 32), uint32 (index), 1 }}, key);
+
+    float randomValue = constraints.apply (index, Philox::toUniformFloat (bits[0]));
+    return std::make_pair (index, randomValue);
+}
+
+//==============================================================================
+PluginPatch PatchGenerator::getRandomPatch()
+{
+    return getRandomPatch (streamSeed, nextPatchIndex++);
+}
+
+//==============================================================================
+PluginPatch PatchGenerator::getRandomPatch (uint64 seed, uint64 index) const
+{
+    return getRandomPatches (seed, index, 1).front();
+}
+
+//==============================================================================
+std::vector<PluginPatch> PatchGenerator::getRandomPatches (uint64 seed,
+                                                           uint64 firstIndex,
+                                                           size_t numPatches) const
+{
+    // The whole batch in one go, the generator works on four blocks at once.
+    const UniformSampler sampler (int (skeletonPatch.size()), seed);
+    return getPatches (sampler, firstIndex, numPatches);
+}
+
+//==============================================================================
+PluginPatch PatchGenerator::getPatch (const float* values) const
+{
+    PluginPatch patch = skeletonPatch;
+    for (size_t i = 0; i < patch.size(); ++i)
+        patch[i].second = constraints.apply (patch[i].first, values[i]);
+    return patch;
+}
+
+//==============================================================================
+std::vector<PluginPatch> PatchGenerator::getPatches (const PatchSampler& sampler,
+                                                     const uint64        firstIndex,
+                                                     const size_t        numPatches) const
+{
+    jassert (size_t (sampler.getNumParameters()) == skeletonPatch.size());
+
+    const std::vector<float> values = sampler.generate (firstIndex, numPatches);
+
+    std::vector<PluginPatch> patches;
+    patches.reserve (numPatches);
+    for (size_t i = 0; i < numPatches; ++i)
+        patches.push_back (getPatch (values.data() + i * skeletonPatch.size()));
+    return patches;
+}
+
+//==============================================================================
+void PatchGenerator::constrainToParameterSteps (const RenderEngine& engine)
+{
+    for (const auto& info : engine.getParameterInfo())
+    {
+        if (! info.isDiscrete || info.numSteps < 2 || constraints.getConstraint (info.index) != nullptr)
+            continue;
+
+        ParameterConstraint constraint;
+        constraint.numSteps = info.numSteps;
+        constraints.setConstraint (info.index, constraint);
+    }
+}
+
+//==============================================================================
+size_t PatchMatrix::getNumPatches() const
+{
+    return parameterIndices.empty() ? 0 : values.size() / parameterIndices.size();
+}
+
+PluginPatch PatchMatrix::getPatch (const size_t patch) const
+{
+    PluginPatch result (parameterIndices.size());
+    const float* row = getRow (patch);
+    for (size_t i = 0; i < result.size(); ++i)
+        result[i] = std::make_pair (parameterIndices[i], row[i]);
+    return result;
+}
+
+std::vector<PluginPatch> PatchMatrix::getPatches() const
+{
+    std::vector<PluginPatch> patches;
+    patches.reserve (getNumPatches());
+    for (size_t i = 0; i < getNumPatches(); ++i)
+        patches.push_back (getPatch (i));
+    return patches;
+}
+
+//==============================================================================
+// The draws of row i of an operator, from the Philox stream of the seed. The
+// last counter word tells the operators apart from each other and from the
+// patch streams, which leave it at 0.
+class RowRandom
+{
+public:
+    RowRandom (const uint64 seed, const uint32 operation, const uint64 row) noexcept :
+        key ({{ uint32 (seed), uint32 (seed >> 32) }}),
+        counter ({{ uint32 (row), uint32 (row >> 32), 0, operation }}),
+        numUsed (4)
+    { }
+
+    uint32 nextBits() noexcept
+    {
+        if (numUsed == 4)
+        {
+            bits = Philox::generate (counter, key);
+            ++counter[2];
+            numUsed = 0;
+        }
+        return bits[numUsed++];
+    }
+
+    double nextUniform() noexcept
+    {
+        return Philox::toUniformFloat (nextBits());
+    }
+
+    size_t nextIndex (const size_t size) noexcept
+    {
+        return jmin (size - 1, size_t (nextUniform() * double (size)));
+    }
+
+    // Box-Muller, the first uniform in (0, 1] so the log is finite.
+    double nextNormal() noexcept
+    {
+        const double radius = std::sqrt (-2.0 * std::log (1.0 - nextUniform()));
+        return radius * std::cos (2.0 * MathConstants<double>::pi * nextUniform());
+    }
+
+private:
+    const Philox::Key key;
+    Philox::Counter   counter;
+    Philox::Counter   bits;
+    int               numUsed;
+};
+
+//==============================================================================
+PatchMatrix PatchGenerator::createMatrix (const size_t numPatches) const
+{
+    PatchMatrix matrix;
+    for (const auto& parameter : skeletonPatch)
+        matrix.parameterIndices.push_back (parameter.first);
+    matrix.values.resize (numPatches * skeletonPatch.size());
+    return matrix;
+}
+
+bool PatchGenerator::hasParameterOrder (const PatchMatrix& matrix, const char* caller) const
+{
+    bool matches = matrix.parameterIndices.size() == skeletonPatch.size();
+    for (size_t i = 0; matches && i < skeletonPatch.size(); ++i)
+        matches = matrix.parameterIndices[i] == skeletonPatch[i].first;
+
+    if (! matches)
+        std::cout << "PatchGenerator::" << caller << " error: The matrix wasn't made by this generator." << std::endl;
+    return matches;
+}
+
+//==============================================================================
+PatchMatrix PatchGenerator::getPatchMatrix (const std::vector<PluginPatch>& patches) const
+{
+    PatchMatrix matrix = createMatrix (patches.size());
+    std::map<int, size_t> positions;
+    for (size_t i = 0; i < skeletonPatch.size(); ++i)
+        positions[skeletonPatch[i].first] = i;
+
+    for (size_t patch = 0; patch < patches.size(); ++patch)
+    {
+        float* row = matrix.getRow (patch);
+        for (size_t i = 0; i < skeletonPatch.size(); ++i)
+            row[i] = constraints.constrain (skeletonPatch[i].first, constraints.getRange (skeletonPatch[i].first).getStart());
+
+        for (const auto& parameter : patches[patch])
+        {
+            const auto position = positions.find (parameter.first);
+            if (position != positions.end())
+                row[position->second] = constraints.constrain (parameter.first, parameter.second);
+        }
+    }
+    return matrix;
+}
+
+PatchMatrix PatchGenerator::getPatchMatrix (const float* values, const size_t numPatches) const
+{
+    PatchMatrix matrix = createMatrix (numPatches);
+    for (size_t patch = 0; patch < numPatches; ++patch)
+        for (size_t i = 0; i < skeletonPatch.size(); ++i)
+            matrix.getRow (patch)[i] = constraints.constrain (skeletonPatch[i].first, values[patch * skeletonPatch.size() + i]);
+    return matrix;
+}
+
+//==============================================================================
+PatchMatrix PatchGenerator::mutate (const PatchMatrix& parents,
+                                    const size_t       numChildren,
+                                    const int          numMutated,
+                                    const float        strength,
+                                    const uint64       seed) const
+{
+    if (! hasParameterOrder (parents, "mutate") || parents.getNumPatches() == 0)
+        return createMatrix (0);
+
+    std::vector<size_t> unfixed;
+    for (size_t i = 0; i < skeletonPatch.size(); ++i)
+        if (! constraints.isFixed (skeletonPatch[i].first))
+            unfixed.push_back (i);
+
+    PatchMatrix children = createMatrix (numChildren);
+    const size_t numMoved = jmin (unfixed.size(), size_t (jmax (0, numMutated)));
+    std::vector<size_t> positions;
+
+    for (size_t child = 0; child < numChildren; ++child)
+    {
+        const float* parent = parents.getRow (child % parents.getNumPatches());
+        float* row = children.getRow (child);
+        std::copy (parent, parent + skeletonPatch.size(), row);
+
+        // A partial Fisher-Yates shuffle picks the parameters that move.
+        RowRandom random (seed, 0x4D555441, child);
+        positions = unfixed;
+        for (size_t i = 0; i < numMoved; ++i)
+        {
+            std::swap (positions[i], positions[i + random.nextIndex (positions.size() - i)]);
+
+            const size_t position = positions[i];
+            const int index = skeletonPatch[position].first;
+            const float stepSize = constraints.getStepSize (index);
+            const float step = float (random.nextNormal() * strength * constraints.getRange (index).getLength());
+            float value = constraints.constrain (index, row[position] + step);
+
+            if (stepSize > 0.0f && value == row[position])
+                value = constraints.constrain (index, row[position] + (step < 0.0f ? -stepSize : stepSize));
+
+            row[position] = value;
+        }
+    }
+    return children;
+}
+
+//==============================================================================
+PatchMatrix PatchGenerator::crossover (const PatchMatrix& mothers,
+                                       const PatchMatrix& fathers,
+                                       const uint64       seed) const
+{
+    if (! hasParameterOrder (mothers, "crossover") || ! hasParameterOrder (fathers, "crossover")
+         || mothers.getNumPatches() == 0 || fathers.getNumPatches() == 0)
+        return createMatrix (0);
+
+    const size_t numChildren = jmax (mothers.getNumPatches(), fathers.getNumPatches());
+    PatchMatrix children = createMatrix (numChildren);
+
+    for (size_t child = 0; child < numChildren; ++child)
+    {
+        const float* mother = mothers.getRow (child % mothers.getNumPatches());
+        const float* father = fathers.getRow (child % fathers.getNumPatches());
+        float* row = children.getRow (child);
+
+        RowRandom random (seed, 0x43524F53, child);
+        for (size_t i = 0; i < skeletonPatch.size(); ++i)
+            row[i] = (random.nextBits() & 1) != 0 ? father[i] : mother[i];
+    }
+    return children;
+}
+
+//==============================================================================
+PatchMatrix PatchGenerator::interpolate (const PluginPatch&      from,
+                                         const PluginPatch&      to,
+                                         const size_t            numSteps,
+                                         const InterpolationMode mode) const
+{
+    const PatchMatrix ends = getPatchMatrix ({ from, to });
+    PatchMatrix path = createMatrix (numSteps);
+    const size_t numParameters = skeletonPatch.size();
+
+    // Every value centred in its range and scaled to [-1, 1].
+    std::vector<double> centres (numParameters), halfRanges (numParameters);
+    std::vector<double> a (numParameters), b (numParameters);
+    for (size_t i = 0; i < numParameters; ++i)
+    {
+        const Range<float> range = constraints.getRange (skeletonPatch[i].first);
+        centres[i] = range.getStart() + range.getLength() * 0.5;
+        halfRanges[i] = jmax (1.0e-9, range.getLength() * 0.5);
+        a[i] = (ends.getRow (0)[i] - centres[i]) / halfRanges[i];
+        b[i] = (ends.getRow (1)[i] - centres[i]) / halfRanges[i];
+    }
+
+    double dot = 0.0, normA = 0.0, normB = 0.0;
+    for (size_t i = 0; i < numParameters; ++i)
+    {
+        dot += a[i] * b[i];
+        normA += a[i] * a[i];
+        normB += b[i] * b[i];
+    }
+
+    // Nearly parallel or a patch at the centre, slerp becomes linear.
+    const double cosine = normA > 0.0 && normB > 0.0 ? jlimit (-1.0, 1.0, dot / std::sqrt (normA * normB)) : 1.0;
+    const double angle = std::acos (cosine);
+    const bool isSpherical = mode == InterpolationMode::spherical && std::sin (angle) > 1.0e-6;
+    const double lengthA = std::sqrt (normA);
+    const double lengthB = std::sqrt (normB);
+
+    for (size_t step = 0; step < numSteps; ++step)
+    {
+        const double t = numSteps > 1 ? double (step) / double (numSteps - 1) : 0.0;
+        double weightA = 1.0 - t;
+        double weightB = t;
+
+        // Slerp the unit directions, then scale to the interpolated length.
+        if (isSpherical)
+        {
+            const double length = (1.0 - t) * lengthA + t * lengthB;
+            weightA = length * std::sin ((1.0 - t) * angle) / (std::sin (angle) * lengthA);
+            weightB = length * std::sin (t * angle) / (std::sin (angle) * lengthB);
+        }
+
+        float* row = path.getRow (step);
+        for (size_t i = 0; i < numParameters; ++i)
+            row[i] = constraints.constrain (skeletonPatch[i].first,
+                                            float (centres[i] + halfRanges[i] * (weightA * a[i] + weightB * b[i])));
+    }
+    return path;
+}
@@ -12,6 +12,37 @@
 #define PATCHGENERATOR_H_INCLUDED
 
 #include "RenderEngine.h"
+#include "PatchSampler.h"
+#include "PatchConstraints.h"
+
+//==============================================================================
+/** Patches stored one row of parameter values per patch, the parameters in
+    the order of parameterIndices in every row, ready to be turned into a
+    batch for a RenderPool.
+*/
+struct PatchMatrix
+{
+    size_t getNumPatches() const;
+
+    size_t getNumParameters() const { return parameterIndices.size(); }
+
+    float* getRow (const size_t patch)             { return values.data() + patch * parameterIndices.size(); }
+    const float* getRow (const size_t patch) const { return values.data() + patch * parameterIndices.size(); }
+
+    PluginPatch getPatch (const size_t patch) const;
+
+    std::vector<PluginPatch> getPatches() const;
+
+    std::vector<int>   parameterIndices;
+    std::vector<float> values;
+};
+
+//==============================================================================
+enum class InterpolationMode
+{
+    linear,
+    spherical
+};
 
 //==============================================================================
 class PatchGenerator
@@ -19,21 +50,126 @@ class PatchGenerator
 
 public:
     PatchGenerator (RenderEngine& engine) :
-        generator (std::random_device()())
+        PatchGenerator (engine, getRandomSeed())
+    { }
+
+    /** Seeded generators give the same patches on every run. */
+    PatchGenerator (RenderEngine& engine, uint64 seed) :
+        streamSeed (seed),
+        nextPatchIndex (0)
     {
         skeletonPatch = engine.getPatch();
         for (auto& parameter : skeletonPatch)
             parameter.second = 0.0f;
     }
 
+    /** A value for the parameter from this generator's own Philox stream.
+        Every call takes the next index of the stream, like getRandomPatch.
+    */
     std::pair<int, float> getRandomParameter (int index);
 
+    /** The next patch of this generator's own Philox stream. */
     PluginPatch getRandomPatch();
 
+    /** The index-th patch of the Philox stream for seed. Only depends on its
+        arguments, so any patch of a run can be regenerated on its own, in any
+        order, on any thread and on any platform.
+    */
+    PluginPatch getRandomPatch (uint64 seed, uint64 index) const;
+
+    /** Patches [firstIndex, firstIndex + numPatches) of the stream for seed,
+        generated as one batch.
+    */
+    std::vector<PluginPatch> getRandomPatches (uint64 seed,
+                                               uint64 firstIndex,
+                                               size_t numPatches) const;
+
+    /** The patch with the values of one row of a sampler's matrix. */
+    PluginPatch getPatch (const float* values) const;
+
+    /** Patches [firstIndex, firstIndex + numPatches) of a sampler that was
+        made with getNumParameters() parameters.
+    */
+    std::vector<PluginPatch> getPatches (const PatchSampler& sampler,
+                                         const uint64        firstIndex,
+                                         const size_t        numPatches) const;
+
+    size_t getNumParameters() const { return skeletonPatch.size(); }
+
+    /** Every patch this generator makes from here on has its uniform values
+        mapped through the constraints, whatever sampler they came from.
+    */
+    void setConstraints (const PatchConstraints& newConstraints) { constraints = newConstraints; }
+
+    const PatchConstraints& getConstraints() const { return constraints; }
+
+    /** Adds a constraint to the steps of every discrete parameter of the
+        engine's plugin that doesn't have a constraint yet, so no two patches
+        differ only by values the plugin treats as the same.
+    */
+    void constrainToParameterSteps (const RenderEngine& engine);
+
+    //==========================================================================
+    /** The patches as a matrix in this generator's parameter order, every
+        value put through the constraints. A parameter that a patch leaves
+        out gets the lowest value it may take.
+    */
+    PatchMatrix getPatchMatrix (const std::vector<PluginPatch>& patches) const;
+
+    /** numPatches rows of getNumParameters() values in this generator's
+        parameter order, every value put through the constraints.
+    */
+    PatchMatrix getPatchMatrix (const float* values, const size_t numPatches) const;
+
+    /** numChildren children, child i a copy of parent i % numParents with
+        numMutated of its parameters that aren't fixed, picked at random,
+        moved by a Gaussian step of strength times the parameter's range.
+        A stepped parameter always moves at least one step.
+
+        The operators draw row i from the Philox stream of (seed, i), so a
+        row doesn't depend on how many others are made with it.
+    */
+    PatchMatrix mutate (const PatchMatrix& parents,
+                        const size_t       numChildren,
+                        const int          numMutated,
+                        const float        strength,
+                        const uint64       seed) const;
+
+    /** Uniform crossover: child i takes every parameter from mother
+        i % numMothers or father i % numFathers with equal probability. There
+        are as many children as the larger of the two has patches.
+    */
+    PatchMatrix crossover (const PatchMatrix& mothers,
+                           const PatchMatrix& fathers,
+                           const uint64       seed) const;
+
+    /** numSteps patches from one patch to the other, both included. With
+        every value centred and scaled to its range, spherical interpolation
+        turns the direction from the centre of the parameter space along the
+        great circle between the two and moves the distance from the centre
+        linearly, rather than cutting through towards the centre.
+    */
+    PatchMatrix interpolate (const PluginPatch&      from,
+                             const PluginPatch&      to,
+                             const size_t            numSteps,
+                             const InterpolationMode mode) const;
+
 private:
+    PatchMatrix createMatrix (const size_t numPatches) const;
+
+    bool hasParameterOrder (const PatchMatrix& matrix, const char* caller) const;
+
+    static uint64 getRandomSeed()
+    {
+        std::random_device device;
+        return (uint64 (device()) << 32) ^ uint64 (device());
+    }
+
     PluginPatch skeletonPatch;
-    
-    std::mt19937_64 generator;
+    PatchConstraints constraints;
+
+    uint64          streamSeed;
+    uint64          nextPatchIndex;
 };
 
 #endif  // PATCHGENERATOR_H_INCLUDED
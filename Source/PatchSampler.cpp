@@ -0,0 +1,322 @@
+/*
+  ==============================================================================
+
+    PatchSampler.cpp
+    Created: 18 Oct 2026 6:12:40pm
+
+  ==============================================================================
+*/
+
+#include "PatchSampler.h"
+#include "Philox.h"
+
+//==============================================================================
+static int countTrailingZeros (const uint64 value) noexcept
+{
+    return countNumberOfBits ((value & (0 - value)) - 1);
+}
+
+static uint32 parity (uint32 value) noexcept
+{
+    value ^= value >> 16;
+    value ^= value >> 8;
+    value ^= value >> 4;
+    value ^= value >> 2;
+    value ^= value >> 1;
+    return value & 1;
+}
+
+//==============================================================================
+// Polynomials over GF(2) as bit masks, bit i is the coefficient of x^i.
+static uint64 multiplyModulo (uint64 a, uint64 b, const uint64 modulus, const int degree) noexcept
+{
+    uint64 product = 0;
+    while (b != 0)
+    {
+        if ((b & 1) != 0)
+            product ^= a;
+
+        b >>= 1;
+        a <<= 1;
+        if ((a >> degree) & 1)
+            a ^= modulus;
+    }
+    return product;
+}
+
+static uint64 powerOfX (uint64 exponent, const uint64 modulus, const int degree) noexcept
+{
+    uint64 result = 1;
+    uint64 base = degree > 1 ? 2 : (2 ^ modulus);
+    while (exponent != 0)
+    {
+        if ((exponent & 1) != 0)
+            result = multiplyModulo (result, base, modulus, degree);
+
+        base = multiplyModulo (base, base, modulus, degree);
+        exponent >>= 1;
+    }
+    return result;
+}
+
+//==============================================================================
+PatchSampler::PatchSampler (const int parameters) :
+    numParameters (jmax (0, parameters))
+{
+}
+
+//==============================================================================
+std::vector<float> PatchSampler::generate (const uint64 firstIndex,
+                                           const size_t numPatches) const
+{
+    std::vector<float> values (numPatches * size_t (numParameters));
+    generate (firstIndex, numPatches, values.data());
+    return values;
+}
+
+//==============================================================================
+int PatchSampler::getNumParameters() const
+{
+    return numParameters;
+}
+
+//==============================================================================
+UniformSampler::UniformSampler (const int    parameters,
+                                const uint64 streamSeed) :
+    PatchSampler (parameters),
+    seed (streamSeed)
+{
+}
+
+//==============================================================================
+void UniformSampler::generate (const uint64 firstIndex,
+                               const size_t numPatches,
+                               float*       values) const
+{
+    Philox::fillUniform (seed, firstIndex, numPatches, numParameters, values);
+}
+
+//==============================================================================
+std::vector<uint32> SobolSampler::findPrimitivePolynomials (const int count)
+{
+    // A polynomial of degree d is primitive when x has order 2^d - 1 modulo
+    // it, which also makes it irreducible.
+    std::vector<uint32> polynomials;
+
+    for (int degree = 1; int (polynomials.size()) < count && degree < numBits; ++degree)
+    {
+        const uint64 order = (uint64 (1) << degree) - 1;
+
+        std::vector<uint64> primeFactors;
+        uint64 remainder = order;
+        for (uint64 factor = 3; factor * factor <= remainder; factor += 2)
+        {
+            if (remainder % factor == 0)
+            {
+                primeFactors.push_back (factor);
+                while (remainder % factor == 0)
+                    remainder /= factor;
+            }
+        }
+        if (remainder > 1)
+            primeFactors.push_back (remainder);
+
+        // Leading and constant terms are always set.
+        for (uint64 middle = 0; middle < (uint64 (1) << (degree - 1)) && int (polynomials.size()) < count; ++middle)
+        {
+            const uint64 polynomial = (uint64 (1) << degree) | (middle << 1) | 1;
+            if (degree > 1 && powerOfX (order, polynomial, degree) != 1)
+                continue;
+
+            bool isPrimitive = true;
+            for (const uint64 factor : primeFactors)
+                if (factor != order && powerOfX (order / factor, polynomial, degree) == 1)
+                    isPrimitive = false;
+
+            if (isPrimitive)
+                polynomials.push_back (uint32 (polynomial));
+        }
+    }
+    return polynomials;
+}
+
+//==============================================================================
+SobolSampler::SobolSampler (const int    parameters,
+                            const uint64 seed,
+                            const bool   scramble) :
+    PatchSampler (parameters),
+    directions (size_t (numParameters) * numBits),
+    shifts (size_t (numParameters), 0)
+{
+    const std::vector<uint32> polynomials = findPrimitivePolynomials (numParameters - 1);
+
+    // The initial direction numbers are part of the sequence, not of the
+    // seed, so they come from a fixed stream.
+    uint64 initialState = 0x536F626F6CULL;
+
+    for (int dimension = 0; dimension < numParameters; ++dimension)
+    {
+        uint32* v = directions.data() + size_t (dimension) * numBits;
+
+        if (dimension == 0)
+        {
+            for (int k = 0; k < numBits; ++k)
+                v[k] = uint32 (1) << (numBits - 1 - k);
+            continue;
+        }
+
+        const uint32 polynomial = polynomials[size_t (dimension - 1)];
+        const int degree = findHighestSetBit (polynomial);
+
+        // m_k odd and below 2^k, placed so its top bit is bit 31 - k.
+        for (int k = 0; k < degree && k < numBits; ++k)
+        {
+            const uint32 m = (uint32 (splitMix64 (initialState)) & ((uint32 (1) << k) - 1) << 1) | 1;
+            v[k] = m << (numBits - 1 - k);
+        }
+
+        for (int k = degree; k < numBits; ++k)
+        {
+            uint32 value = v[k - degree] ^ (v[k - degree] >> degree);
+            for (int j = 1; j < degree; ++j)
+                if ((polynomial >> (degree - j)) & 1)
+                    value ^= v[k - j];
+            v[k] = value;
+        }
+    }
+
+    if (! scramble)
+        return;
+
+    uint64 state = seed;
+    for (int dimension = 0; dimension < numParameters; ++dimension)
+    {
+        // Lower triangular with a unit diagonal, counting bits from the most
+        // significant one, so the scramble is invertible.
+        uint32 rows[numBits];
+        for (int i = 0; i < numBits; ++i)
+        {
+            const uint32 diagonal = uint32 (1) << (numBits - 1 - i);
+            const uint32 above = ~((diagonal << 1) - 1);
+            rows[i] = diagonal | (uint32 (splitMix64 (state)) & above);
+        }
+
+        uint32* v = directions.data() + size_t (dimension) * numBits;
+        for (int k = 0; k < numBits; ++k)
+        {
+            uint32 scrambled = 0;
+            for (int i = 0; i < numBits; ++i)
+                scrambled |= parity (rows[i] & v[k]) << (numBits - 1 - i);
+            v[k] = scrambled;
+        }
+
+        shifts[size_t (dimension)] = uint32 (splitMix64 (state));
+    }
+}
+
+//==============================================================================
+void SobolSampler::generate (const uint64 firstIndex,
+                             const size_t numPatches,
+                             float*       values) const
+{
+    if (numPatches == 0 || numParameters == 0)
+        return;
+
+    // Jump straight to the first point through its Gray code, then step with
+    // one xor per dimension.
+    std::vector<uint32> point (shifts);
+    const uint64 gray = (firstIndex ^ (firstIndex >> 1)) & 0xFFFFFFFFULL;
+    for (int k = 0; k < numBits; ++k)
+    {
+        if (((gray >> k) & 1) == 0)
+            continue;
+
+        for (int dimension = 0; dimension < numParameters; ++dimension)
+            point[size_t (dimension)] ^= directions[size_t (dimension) * numBits + k];
+    }
+
+    const float scale = 1.0f / 16777216.0f;
+
+    for (size_t row = 0; row < numPatches; ++row)
+    {
+        float* output = values + row * size_t (numParameters);
+        for (int dimension = 0; dimension < numParameters; ++dimension)
+            output[dimension] = float (point[size_t (dimension)] >> 8) * scale;
+
+        const int bit = countTrailingZeros (firstIndex + row + 1) % numBits;
+        for (int dimension = 0; dimension < numParameters; ++dimension)
+            point[size_t (dimension)] ^= directions[size_t (dimension) * numBits + bit];
+    }
+}
+
+//==============================================================================
+LatinHypercubeSampler::LatinHypercubeSampler (const int    parameters,
+                                              const uint64 numPatches,
+                                              const uint64 designSeed) :
+    PatchSampler (parameters),
+    designSize (jmax<uint64> (1, numPatches)),
+    seed (designSeed),
+    halfBits (1)
+{
+    // The permutation works on the smallest even number of bits that covers
+    // the design, cycle walking skips what lies outside it.
+    while ((uint64 (1) << (2 * halfBits)) < designSize)
+        ++halfBits;
+}
+
+//==============================================================================
+uint64 LatinHypercubeSampler::permute (const uint64 index, const uint64 key) const
+{
+    const uint64 mask = (uint64 (1) << halfBits) - 1;
+    uint64 value = index;
+
+    do
+    {
+        uint64 left = value >> halfBits;
+        uint64 right = value & mask;
+
+        for (uint64 round = 0; round < 4; ++round)
+        {
+            uint64 state = key ^ (right * 0xD1B54A32D192ED03ULL) ^ round;
+            const uint64 next = left ^ (splitMix64 (state) & mask);
+            left = right;
+            right = next;
+        }
+
+        value = (left << halfBits) | right;
+    }
+    while (value >= designSize);
+
+    return value;
+}
+
+//==============================================================================
+void LatinHypercubeSampler::generate (const uint64 firstIndex,
+                                      const size_t numPatches,
+                                      float*       values) const
+{
+    const double scale = 1.0 / double (designSize);
+    const float largestBelowOne = 1.0f - 1.0f / 16777216.0f;
+
+    for (size_t row = 0; row < numPatches; ++row)
+    {
+        const uint64 index = firstIndex + row;
+        const uint64 design = index / designSize;
+        const uint64 position = index % designSize;
+        float* output = values + row * size_t (numParameters);
+
+        for (int dimension = 0; dimension < numParameters; ++dimension)
+        {
+            uint64 state = seed ^ (design * 0x9E3779B97F4A7C15ULL);
+            state = splitMix64 (state) ^ uint64 (dimension);
+            const uint64 key = splitMix64 (state);
+
+            // Which stratum this point takes, then where inside it.
+            const uint64 stratum = permute (position, key);
+            state = key ^ position;
+            const double jitter = double (splitMix64 (state) >> 11) * (1.0 / 9007199254740992.0);
+
+            output[dimension] = jmin (float ((double (stratum) + jitter) * scale), largestBelowOne);
+        }
+    }
+}
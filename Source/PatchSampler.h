@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    PatchSampler.h
+    Created: 18 Oct 2026 6:12:40pm
+
+  ==============================================================================
+*/
+
+#ifndef PATCHSAMPLER_H_INCLUDED
+#define PATCHSAMPLER_H_INCLUDED
+
+#include <vector>
+#include "../JuceLibraryCode/JuceHeader.h"
+
+using namespace juce;
+
+//==============================================================================
+/** SplitMix64, one step of the stream per call. */
+inline uint64 splitMix64 (uint64& state) noexcept
+{
+    uint64 z = (state += 0x9E3779B97F4A7C15ULL);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    return z ^ (z >> 31);
+}
+
+//==============================================================================
+/** A deterministic sequence of points in [0, 1)^numParameters. Any slice of
+    the sequence can be generated on its own, so parallel workers can each take
+    a disjoint range of indices and together produce exactly the sequence one
+    worker would have.
+*/
+class PatchSampler
+{
+public:
+    PatchSampler (const int numParameters);
+
+    virtual ~PatchSampler() {}
+
+    /** Writes points [firstIndex, firstIndex + numPatches) row by row into
+        values, which must hold numPatches * getNumParameters() floats.
+    */
+    virtual void generate (const uint64 firstIndex,
+                           const size_t numPatches,
+                           float*       values) const = 0;
+
+    std::vector<float> generate (const uint64 firstIndex,
+                                 const size_t numPatches) const;
+
+    int getNumParameters() const;
+
+protected:
+    const int numParameters;
+};
+
+//==============================================================================
+/** Independent uniform values from the Philox stream of the seed. Point i is
+    the same as PatchGenerator::getRandomPatch (seed, i).
+*/
+class UniformSampler : public PatchSampler
+{
+public:
+    UniformSampler (const int    numParameters,
+                    const uint64 seed);
+
+    using PatchSampler::generate;
+
+    void generate (const uint64 firstIndex,
+                   const size_t numPatches,
+                   float*       values) const override;
+
+private:
+    const uint64 seed;
+};
+
+//==============================================================================
+/** Sobol' sequence in base 2. The primitive polynomials are enumerated rather
+    than taken from a table, so any number of parameters works, and the
+    initial direction numbers are fixed pseudo-random odd integers.
+
+    With scrambling on, every dimension gets a random linear matrix scramble
+    and a random digital shift, both drawn from the seed. That keeps the
+    stratification of the sequence while giving independent replicates.
+*/
+class SobolSampler : public PatchSampler
+{
+public:
+    SobolSampler (const int    numParameters,
+                  const uint64 seed,
+                  const bool   scramble = true);
+
+    using PatchSampler::generate;
+
+    void generate (const uint64 firstIndex,
+                   const size_t numPatches,
+                   float*       values) const override;
+
+    static const int numBits = 32;
+
+private:
+    static std::vector<uint32> findPrimitivePolynomials (const int count);
+
+    // numBits direction numbers per dimension, dimension after dimension.
+    std::vector<uint32> directions;
+    std::vector<uint32> shifts;
+};
+
+//==============================================================================
+/** Latin hypercube design of numPatches points: every parameter's range is cut
+    into numPatches equal strata and each stratum is used by exactly one point.
+    The stratum of a point is a keyed permutation of its index, so any range of
+    the design can be generated without the rest of it.
+*/
+class LatinHypercubeSampler : public PatchSampler
+{
+public:
+    LatinHypercubeSampler (const int    numParameters,
+                           const uint64 numPatches,
+                           const uint64 seed);
+
+    using PatchSampler::generate;
+
+    /** Indices past the end of the design wrap around into a new design. */
+    void generate (const uint64 firstIndex,
+                   const size_t numPatches,
+                   float*       values) const override;
+
+private:
+    uint64 permute (const uint64 index, const uint64 key) const;
+
+    const uint64 designSize;
+    const uint64 seed;
+    int          halfBits;
+};
+
+#endif  // PATCHSAMPLER_H_INCLUDED
@@ -0,0 +1,182 @@
+/*
+  ==============================================================================
+
+    Philox.h
+    Created: 18 Oct 2026 7:02:55pm
+
+  ==============================================================================
+*/
+
+#ifndef PHILOX_H_INCLUDED
+#define PHILOX_H_INCLUDED
+
+#include <array>
+#include "../JuceLibraryCode/JuceHeader.h"
+
+#if JUCE_INTEL
+ #include <emmintrin.h>
+#endif
+
+using namespace juce;
+
+//==============================================================================
+/** Philox4x32-10 (Salmon et al., "Parallel random numbers: as easy as 1, 2,
+    3"). A counter-based generator: the output is a bijection of the counter
+    under the key, so there is no state to share between threads and any
+    block of any stream can be computed directly.
+
+    Patch streams use the seed as the key and (index, block) as the counter,
+    four parameters per block, so value j of patch i only depends on
+    (seed, i, j).
+*/
+namespace Philox
+{
+    typedef std::array<uint32, 4> Counter;
+    typedef std::array<uint32, 2> Key;
+
+    static const uint32 multiplier0 = 0xD2511F53;
+    static const uint32 multiplier1 = 0xCD9E8D57;
+    static const uint32 weyl0       = 0x9E3779B9;
+    static const uint32 weyl1       = 0xBB67AE85;
+    static const int    numRounds   = 10;
+
+    //==========================================================================
+    inline Counter generate (Counter counter, Key key) noexcept
+    {
+        for (int round = 0; round < numRounds; ++round)
+        {
+            const uint64 product0 = uint64 (multiplier0) * counter[0];
+            const uint64 product1 = uint64 (multiplier1) * counter[2];
+
+            counter = {{ uint32 (product1 >> 32) ^ counter[1] ^ key[0],
+                         uint32 (product1),
+                         uint32 (product0 >> 32) ^ counter[3] ^ key[1],
+                         uint32 (product0) }};
+
+            key[0] += weyl0;
+            key[1] += weyl1;
+        }
+        return counter;
+    }
+
+    /** Top 24 bits as a float in [0, 1). */
+    inline float toUniformFloat (const uint32 bits) noexcept
+    {
+        return float (bits >> 8) * (1.0f / 16777216.0f);
+    }
+
+   #if JUCE_INTEL
+    //==========================================================================
+    /** Four counters at once, one per lane: word w of every counter is in
+        words[w]. Gives exactly what generate() gives for each lane.
+    */
+    inline void generate4 (__m128i words[4], const Key key) noexcept
+    {
+        const __m128i m0 = _mm_set1_epi32 (int (multiplier0));
+        const __m128i m1 = _mm_set1_epi32 (int (multiplier1));
+        const __m128i lowMask = _mm_set_epi32 (0, -1, 0, -1);
+        uint32 k0 = key[0];
+        uint32 k1 = key[1];
+
+        for (int round = 0; round < numRounds; ++round)
+        {
+            // 32 x 32 -> 64 bit products of the even and the odd lanes.
+            const __m128i even0 = _mm_mul_epu32 (words[0], m0);
+            const __m128i odd0  = _mm_mul_epu32 (_mm_srli_epi64 (words[0], 32), m0);
+            const __m128i even1 = _mm_mul_epu32 (words[2], m1);
+            const __m128i odd1  = _mm_mul_epu32 (_mm_srli_epi64 (words[2], 32), m1);
+
+            const __m128i lo0 = _mm_or_si128 (_mm_and_si128 (even0, lowMask), _mm_slli_epi64 (odd0, 32));
+            const __m128i hi0 = _mm_or_si128 (_mm_srli_epi64 (even0, 32), _mm_andnot_si128 (lowMask, odd0));
+            const __m128i lo1 = _mm_or_si128 (_mm_and_si128 (even1, lowMask), _mm_slli_epi64 (odd1, 32));
+            const __m128i hi1 = _mm_or_si128 (_mm_srli_epi64 (even1, 32), _mm_andnot_si128 (lowMask, odd1));
+
+            const __m128i word0 = _mm_xor_si128 (_mm_xor_si128 (hi1, words[1]), _mm_set1_epi32 (int (k0)));
+            const __m128i word2 = _mm_xor_si128 (_mm_xor_si128 (hi0, words[3]), _mm_set1_epi32 (int (k1)));
+
+            words[0] = word0;
+            words[1] = lo1;
+            words[2] = word2;
+            words[3] = lo0;
+
+            k0 += weyl0;
+            k1 += weyl1;
+        }
+    }
+   #endif
+
+    //==========================================================================
+    /** Rows [firstIndex, firstIndex + numPatches) of the uniform patch stream
+        for seed, numParameters floats in [0, 1) per row, written row by row.
+    */
+    inline void fillUniform (const uint64 seed,
+                             const uint64 firstIndex,
+                             const size_t numPatches,
+                             const int    numParameters,
+                             float*       values) noexcept
+    {
+        if (numParameters <= 0)
+            return;
+
+        const Key key = {{ uint32 (seed), uint32 (seed >> 32) }};
+        const size_t blocksPerPatch = size_t (numParameters + 3) / 4;
+        const size_t numBlocks = numPatches * blocksPerPatch;
+
+        // Writes one block of outputs into its row, the last block of a row
+        // may be partial.
+        auto store = [&] (const size_t block, const uint32* bits)
+        {
+            const size_t row = block / blocksPerPatch;
+            const size_t first = (block % blocksPerPatch) * 4;
+            float* output = values + row * size_t (numParameters) + first;
+            const size_t count = jmin<size_t> (4, size_t (numParameters) - first);
+
+            for (size_t i = 0; i < count; ++i)
+                output[i] = toUniformFloat (bits[i]);
+        };
+
+        size_t block = 0;
+
+       #if JUCE_INTEL
+        for (; block + 4 <= numBlocks; block += 4)
+        {
+            uint32 counters[4][4];
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                const uint64 index = firstIndex + (block + lane) / blocksPerPatch;
+                counters[0][lane] = uint32 (index);
+                counters[1][lane] = uint32 (index >> 32);
+                counters[2][lane] = uint32 ((block + lane) % blocksPerPatch);
+                counters[3][lane] = 0;
+            }
+
+            __m128i words[4];
+            for (int w = 0; w < 4; ++w)
+                words[w] = _mm_loadu_si128 (reinterpret_cast<const __m128i*> (counters[w]));
+
+            generate4 (words, key);
+
+            for (int w = 0; w < 4; ++w)
+                _mm_storeu_si128 (reinterpret_cast<__m128i*> (counters[w]), words[w]);
+
+            for (size_t lane = 0; lane < 4; ++lane)
+            {
+                const uint32 bits[4] = { counters[0][lane], counters[1][lane],
+                                         counters[2][lane], counters[3][lane] };
+                store (block + lane, bits);
+            }
+        }
+       #endif
+
+        for (; block < numBlocks; ++block)
+        {
+            const uint64 index = firstIndex + block / blocksPerPatch;
+            const Counter counter = {{ uint32 (index), uint32 (index >> 32),
+                                       uint32 (block % blocksPerPatch), 0 }};
+            const Counter bits = generate (counter, key);
+            store (block, bits.data());
+        }
+    }
+}
+
+#endif  // PHILOX_H_INCLUDED
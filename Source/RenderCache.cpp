@@ -0,0 +1,447 @@
+/*
+  ==============================================================================
+
+    RenderCache.cpp
+    Created: 18 Oct 2026 5:20:16pm
+
+  ==============================================================================
+*/
+
+#include "RenderCache.h"
+
+static const char cacheMagic[8] = { 'R', 'M', 'C', 'A', 'C', 'H', 'E', '1' };
+
+//==============================================================================
+DiskRenderCache::DiskRenderCache (const std::string& directoryPath,
+                                  const int64        maximumBytes) :
+    directory (File::getCurrentWorkingDirectory().getChildFile (String (directoryPath))),
+    maxBytes (jmax<int64> (0, maximumBytes)),
+    sizeInBytes (0),
+    numHits (0),
+    numMisses (0)
+{
+    if (! directory.createDirectory())
+        std::cout << "DiskRenderCache error: Couldn't create " <<
+                     directory.getFullPathName() << "." << std::endl;
+
+    Array<File> entries;
+    directory.findChildFiles (entries, File::findFiles, true, "*.rmcache");
+
+    int64 total = 0;
+    for (auto& entry : entries)
+        total += entry.getSize();
+    sizeInBytes = total;
+
+    if (sizeInBytes > maxBytes)
+        evict();
+}
+
+//==============================================================================
+File DiskRenderCache::getEntryFile (const String& key) const
+{
+    // Fan out on the first byte so no directory gets too big.
+    return directory.getChildFile (key.substring (0, 2)).getChildFile (key + ".rmcache");
+}
+
+//==============================================================================
+bool DiskRenderCache::load (const String& key, RenderStorage& storage)
+{
+    const File file = getEntryFile (key);
+
+    MemoryBlock block;
+    if (! file.existsAsFile() || ! file.loadFileAsData (block))
+    {
+        ++numMisses;
+        return false;
+    }
+
+    MemoryInputStream input (block, false);
+
+    char magic[8] = {};
+    input.read (magic, sizeof (magic));
+    const int precision      = input.readInt();
+    const double sampleRate  = input.readDouble();
+    const double appliedGain = input.readDouble();
+    const int numSamples     = input.readInt();
+    const int numChannels    = input.readInt();
+    const int channelSamples = input.readInt();
+    const int numMfccFrames  = input.readInt();
+    const int numRmsFrames   = input.readInt();
+
+    const bool isDouble = precision == int (AudioPrecision::doublePrecision);
+    const int64 expectedBytes = int64 (numSamples) * (isDouble ? 8 : 4)
+                              + int64 (numChannels) * channelSamples * 4
+                              + int64 (numMfccFrames) * 13 * 8
+                              + int64 (numRmsFrames) * 8;
+
+    if (memcmp (magic, cacheMagic, sizeof (magic)) != 0
+         || numSamples < 0 || numChannels < 0 || channelSamples < 0
+         || numMfccFrames < 0 || numRmsFrames < 0
+         || input.getNumBytesRemaining() != expectedBytes)
+    {
+        // Not something this version wrote, or a file that was cut short.
+        file.deleteFile();
+        ++numMisses;
+        return false;
+    }
+
+    storage.clear();
+    storage.sampleRate = sampleRate;
+    storage.precision = isDouble ? AudioPrecision::doublePrecision
+                                 : AudioPrecision::singlePrecision;
+    storage.appliedGain = appliedGain;
+
+    if (isDouble)
+    {
+        storage.processedMonoAudioPreview.resize (size_t (numSamples));
+        input.read (storage.processedMonoAudioPreview.data(), numSamples * 8);
+    }
+    else
+    {
+        storage.monoAudioFrames.resize (size_t (numSamples));
+        input.read (storage.monoAudioFrames.data(), numSamples * 4);
+    }
+
+    storage.channelAudio.setSize (numChannels, channelSamples, false, false, true);
+    for (int i = 0; i < numChannels; ++i)
+        input.read (storage.channelAudio.getWritePointer (i), channelSamples * 4);
+
+    storage.mfccFeatures.resize (size_t (numMfccFrames));
+    if (numMfccFrames > 0)
+        input.read (storage.mfccFeatures[0].data(), numMfccFrames * 13 * 8);
+
+    storage.rmsFrames.resize (size_t (numRmsFrames));
+    input.read (storage.rmsFrames.data(), numRmsFrames * 8);
+
+    file.setLastModificationTime (Time::getCurrentTime());
+    ++numHits;
+    return true;
+}
+
+//==============================================================================
+bool DiskRenderCache::store (const String& key, const RenderStorage& storage)
+{
+    const bool isDouble = storage.precision == AudioPrecision::doublePrecision;
+    const size_t numSamples = isDouble ? storage.processedMonoAudioPreview.size()
+                                       : storage.monoAudioFrames.size();
+    const AudioSampleBuffer& channelAudio = storage.channelAudio;
+
+    MemoryOutputStream output;
+    output.write (cacheMagic, sizeof (cacheMagic));
+    output.writeInt (int (storage.precision));
+    output.writeDouble (storage.sampleRate);
+    output.writeDouble (storage.appliedGain);
+    output.writeInt (int (numSamples));
+    output.writeInt (channelAudio.getNumChannels());
+    output.writeInt (channelAudio.getNumSamples());
+    output.writeInt (int (storage.mfccFeatures.size()));
+    output.writeInt (int (storage.rmsFrames.size()));
+
+    if (isDouble)
+        output.write (storage.processedMonoAudioPreview.data(), numSamples * 8);
+    else
+        output.write (storage.monoAudioFrames.data(), numSamples * 4);
+
+    for (int i = 0; i < channelAudio.getNumChannels(); ++i)
+        output.write (channelAudio.getReadPointer (i), size_t (channelAudio.getNumSamples()) * 4);
+
+    if (! storage.mfccFeatures.empty())
+        output.write (storage.mfccFeatures[0].data(), storage.mfccFeatures.size() * 13 * 8);
+
+    output.write (storage.rmsFrames.data(), storage.rmsFrames.size() * 8);
+
+    // Unique per thread, engines sharing the directory may store the same key.
+    const File file = getEntryFile (key);
+    const File tempFile = file.getSiblingFile (file.getFileName() + "."
+                                               + String::toHexString ((pointer_sized_int) Thread::getCurrentThreadId())
+                                               + String::toHexString (Time::getHighResolutionTicks())
+                                               + ".tmp");
+
+    if (! file.getParentDirectory().createDirectory()
+         || ! tempFile.replaceWithData (output.getData(), output.getDataSize())
+         || ! tempFile.moveFileTo (file))
+    {
+        std::cout << "DiskRenderCache error: Couldn't write " <<
+                     file.getFullPathName() << "." << std::endl;
+        tempFile.deleteFile();
+        return false;
+    }
+
+    sizeInBytes += int64 (output.getDataSize());
+    if (sizeInBytes > maxBytes)
+        evict();
+
+    return true;
+}
+
+//==============================================================================
+void DiskRenderCache::evict()
+{
+    // One eviction at a time is plenty, the others just carry on.
+    std::unique_lock<std::mutex> guard (evictionLock, std::try_to_lock);
+    if (! guard.owns_lock())
+        return;
+
+    struct Entry
+    {
+        Time  lastUsed;
+        int64 size;
+        File  file;
+    };
+
+    Array<File> files;
+    directory.findChildFiles (files, File::findFiles, true, "*.rmcache");
+
+    std::vector<Entry> entries;
+    entries.reserve (size_t (files.size()));
+    int64 total = 0;
+    for (auto& file : files)
+    {
+        entries.push_back ({ file.getLastModificationTime(), file.getSize(), file });
+        total += entries.back().size;
+    }
+
+    std::sort (entries.begin(), entries.end(), [] (const Entry& a, const Entry& b)
+    {
+        return a.lastUsed < b.lastUsed;
+    });
+
+    const int64 target = maxBytes / 10 * 9;
+    for (size_t i = 0; i < entries.size() && total > target; ++i)
+        if (entries[i].file.deleteFile())
+            total -= entries[i].size;
+
+    sizeInBytes = total;
+}
+
+//==============================================================================
+void DiskRenderCache::clear()
+{
+    std::lock_guard<std::mutex> guard (evictionLock);
+
+    Array<File> files;
+    directory.findChildFiles (files, File::findFiles, true, "*.rmcache");
+    for (auto& file : files)
+        file.deleteFile();
+
+    sizeInBytes = 0;
+}
+
+//==============================================================================
+int64 DiskRenderCache::getSizeInBytes() const
+{
+    return sizeInBytes;
+}
+
+//==============================================================================
+uint64 DiskRenderCache::getNumHits() const
+{
+    return numHits;
+}
+
+//==============================================================================
+uint64 DiskRenderCache::getNumMisses() const
+{
+    return numMisses;
+}
+
+//==============================================================================
+String DiskRenderCache::hashPluginBinary (const File& plugin)
+{
+    if (plugin.existsAsFile())
+        return SHA256 (plugin).toHexString();
+
+    if (! plugin.isDirectory())
+        return String();
+
+    // Bundles (.vst, .vst3, .component) hash every file in a fixed order,
+    // together with its path inside the bundle.
+    Array<File> files;
+    plugin.findChildFiles (files, File::findFiles, true);
+
+    std::sort (files.begin(), files.end(), [&plugin] (const File& a, const File& b)
+    {
+        return a.getRelativePathFrom (plugin) < b.getRelativePathFrom (plugin);
+    });
+
+    MemoryOutputStream contents;
+    for (auto& file : files)
+    {
+        contents << file.getRelativePathFrom (plugin);
+        contents << SHA256 (file).toHexString();
+    }
+    return SHA256 (contents.getData(), contents.getDataSize()).toHexString();
+}
+
+//==============================================================================
+MemoryRenderCache::MemoryRenderCache (const size_t maximumEntries,
+                                      const double resolution,
+                                      const bool   shouldStoreAudio) :
+    maxEntries (jmax<size_t> (1, maximumEntries)),
+    defaultResolution (jmax (0.0, resolution)),
+    storeAudio (shouldStoreAudio),
+    numHits (0),
+    numMisses (0)
+{
+}
+
+//==============================================================================
+void MemoryRenderCache::setParameterResolution (const int parameter, const double resolution)
+{
+    std::lock_guard<std::mutex> guard (lock);
+    resolutions[parameter] = jmax (0.0, resolution);
+}
+
+//==============================================================================
+void MemoryRenderCache::appendQuantized (std::string& key, const PluginPatch& patch) const
+{
+    for (const auto& parameter : patch)
+    {
+        const auto found = resolutions.find (parameter.first);
+        const double resolution = found != resolutions.end() ? found->second : defaultResolution;
+
+        // Exact values go in as their bit pattern, everything else as the
+        // number of steps of the resolution.
+        int64 step = 0;
+        if (resolution > 0.0)
+            step = int64 (std::floor (parameter.second / resolution + 0.5));
+        else
+            memcpy (&step, &parameter.second, sizeof (parameter.second));
+
+        key.append (reinterpret_cast<const char*> (&parameter.first), sizeof (parameter.first));
+        key.append (reinterpret_cast<const char*> (&step), sizeof (step));
+    }
+}
+
+//==============================================================================
+std::string MemoryRenderCache::makeKey (const PluginPatch& patch,
+                                        const PluginPatch& overrides,
+                                        const void*        settings,
+                                        const size_t       settingsSize) const
+{
+    std::string key;
+    key.reserve ((patch.size() + overrides.size()) * 12 + settingsSize + 1);
+
+    std::lock_guard<std::mutex> guard (lock);
+    appendQuantized (key, patch);
+    key.push_back ('|');
+    appendQuantized (key, overrides);
+    key.append (static_cast<const char*> (settings), settingsSize);
+    return key;
+}
+
+//==============================================================================
+bool MemoryRenderCache::load (const std::string& key, RenderStorage& storage, const bool needsAudio)
+{
+    std::lock_guard<std::mutex> guard (lock);
+
+    // A features-only entry would hand back a render without audio.
+    const auto found = index.find (key);
+    if (found == index.end() || (needsAudio && ! storeAudio))
+    {
+        ++numMisses;
+        return false;
+    }
+
+    // Most recently used at the front.
+    entries.splice (entries.begin(), entries, found->second);
+
+    // Assigning keeps the capacity the storage already has.
+    const RenderStorage& cached = found->second->storage;
+    storage.sampleRate = cached.sampleRate;
+    storage.precision = cached.precision;
+    storage.appliedGain = cached.appliedGain;
+    storage.monoAudioFrames = cached.monoAudioFrames;
+    storage.processedMonoAudioPreview = cached.processedMonoAudioPreview;
+    storage.channelAudio.makeCopyOf (cached.channelAudio, true);
+    storage.mfccFeatures = cached.mfccFeatures;
+    storage.rmsFrames = cached.rmsFrames;
+
+    ++numHits;
+    return true;
+}
+
+//==============================================================================
+void MemoryRenderCache::store (const std::string& key, const RenderStorage& storage)
+{
+    std::lock_guard<std::mutex> guard (lock);
+
+    if (index.find (key) != index.end())
+        return;
+
+    // Reuse the least recently used entry once the cache is full.
+    if (entries.size() >= maxEntries)
+    {
+        index.erase (entries.back().key);
+        entries.splice (entries.begin(), entries, std::prev (entries.end()));
+    }
+    else
+    {
+        entries.emplace_front();
+    }
+
+    Entry& entry = entries.front();
+    entry.key = key;
+    entry.storage.sampleRate = storage.sampleRate;
+    entry.storage.precision = storage.precision;
+    entry.storage.appliedGain = storage.appliedGain;
+    entry.storage.mfccFeatures = storage.mfccFeatures;
+    entry.storage.rmsFrames = storage.rmsFrames;
+
+    if (storeAudio)
+    {
+        entry.storage.monoAudioFrames = storage.monoAudioFrames;
+        entry.storage.processedMonoAudioPreview = storage.processedMonoAudioPreview;
+        entry.storage.channelAudio.makeCopyOf (storage.channelAudio, true);
+    }
+    else
+    {
+        entry.storage.monoAudioFrames.clear();
+        entry.storage.processedMonoAudioPreview.clear();
+        entry.storage.channelAudio.setSize (0, 0, false, false, true);
+    }
+
+    index[key] = entries.begin();
+}
+
+//==============================================================================
+void MemoryRenderCache::clear()
+{
+    std::lock_guard<std::mutex> guard (lock);
+    index.clear();
+    entries.clear();
+}
+
+//==============================================================================
+void MemoryRenderCache::resetCounters()
+{
+    numHits = 0;
+    numMisses = 0;
+}
+
+//==============================================================================
+size_t MemoryRenderCache::getNumEntries() const
+{
+    std::lock_guard<std::mutex> guard (lock);
+    return entries.size();
+}
+
+//==============================================================================
+uint64 MemoryRenderCache::getNumHits() const
+{
+    return numHits;
+}
+
+//==============================================================================
+uint64 MemoryRenderCache::getNumMisses() const
+{
+    return numMisses;
+}
+
+//==============================================================================
+double MemoryRenderCache::getHitRate() const
+{
+    const uint64 hits = numHits;
+    const uint64 lookups = hits + numMisses;
+    return lookups > 0 ? double (hits) / double (lookups) : 0.0;
+}
@@ -0,0 +1,124 @@
+/*
+  ==============================================================================
+
+    RenderCache.h
+    Created: 18 Oct 2026 5:20:16pm
+
+  ==============================================================================
+*/
+
+#ifndef RENDERCACHE_H_INCLUDED
+#define RENDERCACHE_H_INCLUDED
+
+#include <atomic>
+#include <list>
+#include <map>
+#include <unordered_map>
+#include "RenderResult.h"
+
+//==============================================================================
+/** Content-addressed store of whole renders on disk, keyed by a hash of every
+    input that can change a render. Entries are written under a temporary name
+    and renamed, so engines in several processes can share a directory.
+
+    The cache is bounded in size: when it grows past maxBytes the least
+    recently used entries, by modification time, are deleted until it is
+    back under 90% of the limit. A hit touches the entry's modification time.
+*/
+class DiskRenderCache
+{
+public:
+    DiskRenderCache (const std::string& directory,
+                     const int64        maxBytes);
+
+    /** Fills the storage from the entry for key, if there is a valid one. */
+    bool load (const String& key, RenderStorage& storage);
+
+    bool store (const String& key, const RenderStorage& storage);
+
+    void clear();
+
+    int64 getSizeInBytes() const;
+
+    uint64 getNumHits() const;
+
+    uint64 getNumMisses() const;
+
+    /** SHA-256 of a plugin binary, or of every file in a bundle directory. */
+    static String hashPluginBinary (const File& plugin);
+
+private:
+    File getEntryFile (const String& key) const;
+    void evict();
+
+    const File          directory;
+    const int64         maxBytes;
+    std::atomic<int64>  sizeInBytes;
+    std::atomic<uint64> numHits;
+    std::atomic<uint64> numMisses;
+    std::mutex          evictionLock;
+};
+
+//==============================================================================
+/** Thread-safe LRU of recent renders in memory, for searches that keep coming
+    back to the same patches. Keys are built from the patch quantized to a
+    resolution per parameter, so patches closer than that share an entry.
+
+    Only the features are kept unless storeAudio is set. Such entries only
+    answer loads that don't need the audio, the others count as misses.
+*/
+class MemoryRenderCache
+{
+public:
+    MemoryRenderCache (const size_t maxEntries,
+                       const double defaultResolution,
+                       const bool   storeAudio);
+
+    /** A resolution of 0 only matches the exact value. */
+    void setParameterResolution (const int index, const double resolution);
+
+    /** Quantizes the patch and then the overrides, which are applied on top
+        of it, and appends the render settings as they are.
+    */
+    std::string makeKey (const PluginPatch& patch,
+                         const PluginPatch& overrides,
+                         const void*        settings,
+                         const size_t       settingsSize) const;
+
+    bool load (const std::string& key, RenderStorage& storage, const bool needsAudio);
+
+    void store (const std::string& key, const RenderStorage& storage);
+
+    void clear();
+
+    void resetCounters();
+
+    size_t getNumEntries() const;
+
+    uint64 getNumHits() const;
+
+    uint64 getNumMisses() const;
+
+    double getHitRate() const;
+
+private:
+    struct Entry
+    {
+        std::string   key;
+        RenderStorage storage;
+    };
+
+    void appendQuantized (std::string& key, const PluginPatch& patch) const;
+
+    const size_t                                                 maxEntries;
+    const double                                                 defaultResolution;
+    const bool                                                   storeAudio;
+    mutable std::mutex                                           lock;
+    std::map<int, double>                                        resolutions;
+    std::list<Entry>                                             entries;
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    std::atomic<uint64>                                          numHits;
+    std::atomic<uint64>                                          numMisses;
+};
+
+#endif  // RENDERCACHE_H_INCLUDED
@@ -51,6 +51,22 @@ bool RenderEngine::loadPlugin (const std::string& path)
         // Resize the pluginParameters patch type to fit this plugin and init
         // all the values to 0.0f!
         fillAvailablePluginParameters (pluginParameters);
+        fillParameterInfo();
+
+        // Only worth reading the whole binary when there is a cache to key.
+        pluginPath = path;
+        presetHash = String();
+        isPatchApplied = false;
+        pluginBinaryHash = diskCache != nullptr ? DiskRenderCache::hashPluginBinary (File (String (path)))
+                                                : String();
+
+        // A channel picked for an earlier plugin may not exist on this one.
+        if (featureChannel >= plugin->getTotalNumOutputChannels())
+        {
+            std::cout << "RenderEngine::loadPlugin error: The feature channel " << featureChannel <<
+                         " isn't an output of this plugin, using the mono mixdown." << std::endl;
+            featureChannel = -1;
+        }
 
         return true;
     }
@@ -68,43 +84,199 @@ void RenderEngine::renderPatch (const uint8  midiNote,
                                 const double noteLength,
                                 const double renderLength)
 {
-    // Get the overriden patch and set the vst parameters with it.
-    PluginPatch overridenPatch = getPatch();
-    for (const auto& parameter : overridenPatch)
-        plugin->setParameter (parameter.first, parameter.second);
+    renderWithCaches (midiNote, midiVelocity, noteLength, renderLength, false, true);
+}
+
+//==============================================================================
+void RenderEngine::renderWithCaches (const uint8  midiNote,
+                                     const uint8  midiVelocity,
+                                     const double noteLength,
+                                     const double renderLength,
+                                     const bool   reusePatch,
+                                     const bool   needsAudio)
+{
+    if (memoryCache == nullptr && diskCache == nullptr)
+    {
+        renderPluginPatch (midiNote, midiVelocity, noteLength, renderLength, reusePatch);
+        return;
+    }
+
+    // Memory first, it is the cheap one. A disk hit is remembered in memory.
+    std::string memoryKey;
+    if (memoryCache != nullptr)
+    {
+        MemoryOutputStream settings;
+        settings << String (pluginPath);
+        writeRenderSettings (settings, midiNote, midiVelocity, noteLength, renderLength);
+
+        memoryKey = memoryCache->makeKey (pluginParameters, overridenParameters,
+                                          settings.getData(), settings.getDataSize());
+        if (memoryCache->load (memoryKey, *storage, needsAudio))
+        {
+            storage->fingerprint = Fingerprint::compute (storage->mfccFeatures);
+            return;
+        }
+    }
+
+    String diskKey;
+    if (diskCache != nullptr)
+    {
+        diskKey = getRenderKey (midiNote, midiVelocity, noteLength, renderLength);
+        if (diskCache->load (diskKey, *storage))
+        {
+            storage->fingerprint = Fingerprint::compute (storage->mfccFeatures);
+            if (memoryCache != nullptr)
+                memoryCache->store (memoryKey, *storage);
+            return;
+        }
+    }
+
+    renderPluginPatch (midiNote, midiVelocity, noteLength, renderLength, reusePatch);
+
+    if (memoryCache != nullptr)
+        memoryCache->store (memoryKey, *storage);
+    if (diskCache != nullptr)
+        diskCache->store (diskKey, *storage);
+}
+
+//==============================================================================
+void RenderEngine::setMemoryCache (std::shared_ptr<MemoryRenderCache> cache)
+{
+    memoryCache = std::move (cache);
+}
+
+//==============================================================================
+void RenderEngine::writeRenderSettings (OutputStream& stream,
+                                        const uint8   midiNote,
+                                        const uint8   midiVelocity,
+                                        const double  noteLength,
+                                        const double  renderLength) const
+{
+    stream.writeByte (char (midiNote));
+    stream.writeByte (char (midiVelocity));
+    stream.writeDouble (noteLength);
+    stream.writeDouble (renderLength);
+    stream.writeDouble (sampleRate);
+    stream.writeInt (bufferSize);
+    stream.writeInt (fftSize);
+    stream.writeInt (int (normalisationMode));
+    stream.writeDouble (normalisationTarget);
+    stream.writeDouble (normalisationCeiling);
+    stream.writeBool (retainChannels);
+    stream.writeInt (featureChannel);
+    stream.writeInt (int (audioPrecision));
+
+    // Empty until a preset is loaded, so keys of plain patches don't change.
+    stream << presetHash;
+}
+
+//==============================================================================
+void RenderEngine::setDiskCache (std::shared_ptr<DiskRenderCache> cache)
+{
+    diskCache = std::move (cache);
+
+    if (diskCache != nullptr && pluginBinaryHash.isEmpty() && ! pluginPath.empty())
+        pluginBinaryHash = DiskRenderCache::hashPluginBinary (File (String (pluginPath)));
+}
+
+//==============================================================================
+String RenderEngine::getRenderKey (const uint8  midiNote,
+                                   const uint8  midiVelocity,
+                                   const double noteLength,
+                                   const double renderLength) const
+{
+    // Bump the version whenever rendering or analysis changes what a given
+    // input produces, so old entries are never mistaken for new ones.
+    MemoryOutputStream key;
+    key << "RenderMan render 1" << pluginBinaryHash;
+
+    // The parameters are applied in this order, overrides last.
+    key.writeInt (int (pluginParameters.size()));
+    for (const auto& parameter : pluginParameters)
+    {
+        key.writeInt (parameter.first);
+        key.writeFloat (parameter.second);
+    }
+    key.writeInt (int (overridenParameters.size()));
+    for (const auto& parameter : overridenParameters)
+    {
+        key.writeInt (parameter.first);
+        key.writeFloat (parameter.second);
+    }
+
+    writeRenderSettings (key, midiNote, midiVelocity, noteLength, renderLength);
+
+    return SHA256 (key.getData(), key.getDataSize()).toHexString();
+}
+
+//==============================================================================
+void RenderEngine::renderPluginPatch (const uint8  midiNote,
+                                      const uint8  midiVelocity,
+                                      const double noteLength,
+                                      const double renderLength,
+                                      const bool   reusePatch)
+{
+    // Set the vst parameters with the patch, then the overriden ones on top.
+    // Same end result as applying getPatch() without copying the patch.
+    const bool onlyReset = reusePatch && isPatchApplied;
+    if (! onlyReset)
+    {
+        for (const auto& parameter : pluginParameters)
+            plugin->setParameter (parameter.first, parameter.second);
+        for (const auto& parameter : overridenParameters)
+            plugin->setParameter (parameter.first, parameter.second);
+    }
 
     // Get the note on midiBuffer.
     MidiMessage onMessage = MidiMessage::noteOn (1,
                                                  midiNote,
                                                  midiVelocity);
     onMessage.setTimeStamp(0);
-    MidiBuffer midiNoteBuffer;
+    midiNoteBuffer.clear();
     midiNoteBuffer.addEvent (onMessage, onMessage.getTimeStamp());
 
-    // Setup fft here so it is destroyed when rendering is finished and
-    // the stack unwinds so it doesn't share frames with a new patch.
-    maxiFFT fft;
-    fft.setup (fftSize, fftSize / 2, fftSize / 4);
+    // Clear the fft so it doesn't share frames with the previous patch.
+    fft.reset();
 
     // Data structure to hold multi-channel audio data.
-    AudioSampleBuffer audioBuffer (plugin->getTotalNumOutputChannels(),
-                                   bufferSize);
+    processingBuffer.setSize (plugin->getTotalNumOutputChannels(),
+                              bufferSize,
+                              false, false, true);
 
     int numberOfBuffers = int (std::ceil (renderLength * sampleRate / bufferSize));
 
-    // Clear and reserve memory for the audio storage!
-    processedMonoAudioPreview.clear();
-    processedMonoAudioPreview.reserve (numberOfBuffers * bufferSize);
+    // Size the audio storage up front so every block is written in place!
+    // Only the vector of the chosen precision is used, the other stays empty.
+    storage->sampleRate = sampleRate;
+    storage->precision = audioPrecision;
+    storage->monoAudioFrames.clear();
+    storage->processedMonoAudioPreview.clear();
+    if (audioPrecision == AudioPrecision::singlePrecision)
+        storage->monoAudioFrames.resize (numberOfBuffers * bufferSize);
+    else
+        storage->processedMonoAudioPreview.resize (numberOfBuffers * bufferSize);
+
+    // Keep the plugin's own channel layout too if it was asked for, or if the
+    // features have to come from one particular channel.
+    const bool keepChannels = retainChannels || featureChannel >= 0;
+    storage->channelAudio.setSize (keepChannels ? processingBuffer.getNumChannels() : 0,
+                                   keepChannels ? numberOfBuffers * bufferSize : 0,
+                                   false, false, true);
 
     // Number of FFT, MFCC and RMS frames.
     int numberOfFFT = int (std::ceil (renderLength * sampleRate / fftSize)) * 4;
-    rmsFrames.clear();
-    rmsFrames.reserve (numberOfFFT);
-    currentRmsFrame = 0.0;
-    mfccFeatures.clear();
-    mfccFeatures.reserve (numberOfFFT);
-
-    plugin->prepareToPlay (sampleRate, bufferSize);
+    storage->rmsFrames.clear();
+    storage->rmsFrames.reserve (numberOfFFT);
+    storage->mfccFeatures.clear();
+    storage->mfccFeatures.reserve (numberOfFFT);
+
+    // Reset clears the voices and tails of the last note without the plugin
+    // reallocating anything.
+    if (onlyReset)
+        plugin->reset();
+    else
+        plugin->prepareToPlay (sampleRate, bufferSize);
+    isPatchApplied = true;
 
     for (int i = 0; i < numberOfBuffers; ++i)
     {
@@ -119,57 +291,296 @@ void RenderEngine::renderPatch (const uint8  midiNote,
                           midiNoteBuffer);
 
         // Turn Midi to audio via the vst.
-        plugin->processBlock (audioBuffer, midiNoteBuffer);
+        plugin->processBlock (processingBuffer, midiNoteBuffer);
+
+        // Mono the block and keep it for normalisation and analysis.
+        if (audioPrecision == AudioPrecision::singlePrecision)
+            fillAudioFrames (processingBuffer, storage->monoAudioFrames, i * bufferSize);
+        else
+            fillAudioFrames (processingBuffer, storage->processedMonoAudioPreview, i * bufferSize);
+    }
+
+    if (audioPrecision == AudioPrecision::singlePrecision)
+        analyseAudioFrames (storage->monoAudioFrames);
+    else
+        analyseAudioFrames (storage->processedMonoAudioPreview);
+}
+
+//==============================================================================
+RenderResult RenderEngine::renderPatchToResult (const uint8  midiNote,
+                                                const uint8  midiVelocity,
+                                                const double noteLength,
+                                                const double renderLength,
+                                                const bool   needsAudio)
+{
+    renderWithCaches (midiNote, midiVelocity, noteLength, renderLength, false, needsAudio);
+    return takeResult();
+}
+
+//==============================================================================
+RenderResult RenderEngine::renderNoteToResult (const uint8  midiNote,
+                                               const uint8  midiVelocity,
+                                               const double noteLength,
+                                               const double renderLength)
+{
+    renderWithCaches (midiNote, midiVelocity, noteLength, renderLength, true, true);
+    return takeResult();
+}
 
-        // Get audio features and fill the datastructure.
-        fillAudioFeatures (audioBuffer, fft);
+//==============================================================================
+MFCCFeatures RenderEngine::analyseAudio (const std::vector<float>& audio)
+{
+    if (plugin == nullptr)
+    {
+        std::cout << "RenderEngine::analyseAudio error: Please load the plugin first!" << std::endl;
+        return MFCCFeatures();
     }
+
+    std::unique_ptr<RenderStorage> lastRender = std::move (storage);
+    storage = storagePool->acquire();
+    storage->clear();
+    storage->sampleRate = sampleRate;
+    storage->monoAudioFrames = audio;
+
+    fft.reset();
+    analyseAudioFrames (storage->monoAudioFrames);
+
+    MFCCFeatures features = std::move (storage->mfccFeatures);
+    storagePool->release (std::move (storage));
+    storage = std::move (lastRender);
+    return features;
+}
+
+//==============================================================================
+RenderResult RenderEngine::takeResult()
+{
+    // The engine keeps an empty storage so the getters still have something
+    // to read from until the next render.
+    RenderResult result (std::move (storage), storagePool);
+    storage = storagePool->acquire();
+    return result;
 }
 
 //=============================================================================
-void RenderEngine::fillAudioFeatures (const AudioSampleBuffer& data,
-                                      maxiFFT&                 fft)
+template <typename SampleType>
+void RenderEngine::analyseAudioFrames (std::vector<SampleType>& frames)
 {
-    // Keep it auto as it may or may not be double precision.
-    const auto readptrs = data.getArrayOfReadPointers();
-    for (int i = 0; i < data.getNumSamples(); ++i)
+    // Rescale the whole render before any features are taken from it.
+    normaliseAudioFrames (frames);
+
+    // Get audio features and fill the datastructure.
+    const AudioSampleBuffer& channelAudio = storage->channelAudio;
+    if (featureChannel >= 0 && featureChannel < channelAudio.getNumChannels())
+        fillAudioFeatures (channelAudio.getReadPointer (featureChannel),
+                           size_t (channelAudio.getNumSamples()));
+    else
+        fillAudioFeatures (frames.data(), frames.size());
+
+    storage->fingerprint = Fingerprint::compute (storage->mfccFeatures);
+}
+
+//=============================================================================
+template <typename SampleType>
+void RenderEngine::fillAudioFrames (const AudioSampleBuffer&  data,
+                                    std::vector<SampleType>& frames,
+                                    const int                writePosition)
+{
+    const int numberOfSamples = data.getNumSamples();
+
+    // Planar copy straight from the plugin's buffer, one per channel.
+    AudioSampleBuffer& channelAudio = storage->channelAudio;
+    for (int channel = 0; channel < channelAudio.getNumChannels(); ++channel)
+        channelAudio.copyFrom (channel, writePosition, data, channel, 0, numberOfSamples);
+
+    // Mono the block and save the audio for playback and plotting!
+    AudioKernels::mixdown (frames.data() + writePosition,
+                           data.getArrayOfReadPointers(),
+                           data.getNumChannels(),
+                           numberOfSamples);
+}
+
+//=============================================================================
+template <typename SampleType>
+void RenderEngine::normaliseAudioFrames (std::vector<SampleType>& frames)
+{
+    const AudioSampleBuffer& channelAudio = storage->channelAudio;
+    storage->appliedGain = 1.0;
+
+    if (normalisationMode == NormalisationMode::none || frames.empty())
+        return;
+
+    double peak = AudioKernels::getPeak (frames.data(), int (frames.size()));
+    const double sumOfSquares = AudioKernels::sumOfSquares (frames.data(), int (frames.size()));
+
+    // Individual channels can peak higher than their mono fold.
+    if (channelAudio.getNumChannels() > 0)
+        peak = std::max (peak, double (channelAudio.getMagnitude (0, channelAudio.getNumSamples())));
+
+    // Silence can't be brought up to any target, so leave it untouched.
+    if (peak <= 0.0)
+        return;
+
+    double measuredDecibels = 0.0;
+    switch (normalisationMode)
     {
-        // Mono the frame.
-        int channel = 0;
-        auto currentFrame = readptrs[channel][i];
-        const int numberChannels = data.getNumChannels();
+        case NormalisationMode::peak:
+            measuredDecibels = Decibels::gainToDecibels (peak, -1000.0);
+            break;
 
-        while (++channel < numberChannels)
-            currentFrame += readptrs[channel][i];
+        case NormalisationMode::rms:
+            measuredDecibels = Decibels::gainToDecibels (std::sqrt (sumOfSquares / frames.size()),
+                                                         -1000.0);
+            break;
 
-        currentFrame /= numberChannels;
+        case NormalisationMode::lufs:
+            measuredDecibels = getIntegratedLoudness (frames);
+            break;
 
-        // Save the audio for playback and plotting!
-        processedMonoAudioPreview.push_back (currentFrame);
+        case NormalisationMode::none:
+            break;
+    }
 
-        // RMS.
-        currentRmsFrame += (currentFrame * currentFrame);
+    // Below the absolute gate of BS.1770 there is nothing meaningful to match.
+    if (measuredDecibels <= -70.0)
+        return;
 
-        // Extract features.
-        if (fft.process (currentFrame))
+    double gain = Decibels::decibelsToGain (normalisationTarget - measuredDecibels);
+
+    // Gain staging - never push the peak over the ceiling.
+    const double ceiling = Decibels::decibelsToGain (normalisationCeiling);
+    if (peak * gain > ceiling)
+        gain = ceiling / peak;
+
+    FloatVectorOperations::multiply (frames.data(), SampleType (gain), int (frames.size()));
+
+    storage->channelAudio.applyGain (float (gain));
+
+    storage->appliedGain = gain;
+}
+
+//=============================================================================
+template <typename SampleType>
+double RenderEngine::getIntegratedLoudness (const std::vector<SampleType>& frames) const
+{
+    // K-weighting from ITU-R BS.1770-4, the two biquads are derived from their
+    // analogue prototypes so any sample rate is supported.
+    const double pi = MathConstants<double>::pi;
+
+    double k = std::tan (pi * 1681.974450955533 / sampleRate);
+    const double q = 0.7071752369554196;
+    const double vh = std::pow (10.0, 3.999843853973347 / 20.0);
+    const double vb = std::pow (vh, 0.4996667741545416);
+    double a0 = 1.0 + k / q + k * k;
+    const double shelfB[3] = { (vh + vb * k / q + k * k) / a0,
+                               2.0 * (k * k - vh) / a0,
+                               (vh - vb * k / q + k * k) / a0 };
+    const double shelfA[2] = { 2.0 * (k * k - 1.0) / a0,
+                               (1.0 - k / q + k * k) / a0 };
+
+    k = std::tan (pi * 38.13547087602444 / sampleRate);
+    const double hq = 0.5003270373238773;
+    a0 = 1.0 + k / hq + k * k;
+    const double passA[2] = { 2.0 * (k * k - 1.0) / a0,
+                              (1.0 - k / hq + k * k) / a0 };
+
+    // Mean square of the weighted signal in 100ms steps, gating blocks are
+    // 400ms long with 75% overlap so each is made of four steps.
+    const size_t stepSize = std::max<size_t> (1, size_t (sampleRate * 0.1));
+    const size_t numberOfSamples = frames.size();
+    std::vector<double> stepPowers;
+    stepPowers.reserve (numberOfSamples / stepSize + 1);
+
+    double s1 = 0.0, s2 = 0.0, h1 = 0.0, h2 = 0.0;
+    double stepSum = 0.0;
+    for (size_t i = 0; i < numberOfSamples; ++i)
+    {
+        const double x = frames[i];
+        const double shelved = shelfB[0] * x + s1;
+        s1 = shelfB[1] * x - shelfA[0] * shelved + s2;
+        s2 = shelfB[2] * x - shelfA[1] * shelved;
+
+        const double weighted = shelved + h1;
+        h1 = -2.0 * shelved - passA[0] * weighted + h2;
+        h2 = shelved - passA[1] * weighted;
+
+        stepSum += weighted * weighted;
+        if ((i + 1) % stepSize == 0)
+        {
+            stepPowers.push_back (stepSum / stepSize);
+            stepSum = 0.0;
+        }
+    }
+
+    std::vector<double> blockPowers;
+    if (stepPowers.size() < 4)
+    {
+        // Shorter than a gating block, so measure the whole render.
+        double sum = std::accumulate (stepPowers.begin(), stepPowers.end(), 0.0) * stepSize + stepSum;
+        blockPowers.push_back (sum / numberOfSamples);
+    }
+    else
+    {
+        for (size_t i = 0; i + 4 <= stepPowers.size(); ++i)
+            blockPowers.push_back ((stepPowers[i]     + stepPowers[i + 1] +
+                                    stepPowers[i + 2] + stepPowers[i + 3]) / 4.0);
+    }
+
+    auto toLoudness = [] (double power) { return -0.691 + 10.0 * std::log10 (power); };
+
+    // Absolute gate at -70 LUFS, then a relative gate 10 LU below that.
+    double gatedSum = 0.0;
+    size_t gatedCount = 0;
+    for (const auto power : blockPowers)
+    {
+        if (power > 0.0 && toLoudness (power) > -70.0)
         {
-            // This isn't real-time so I can take the luxuary of allocating
-            // heap memory here.
-            double* mfccs = new double[13];
-            mfcc.mfcc (fft.magnitudes, mfccs);
+            gatedSum += power;
+            ++gatedCount;
+        }
+    }
+
+    if (gatedCount == 0)
+        return -1000.0;
 
+    const double relativeGate = toLoudness (gatedSum / gatedCount) - 10.0;
+    gatedSum = 0.0;
+    gatedCount = 0;
+    for (const auto power : blockPowers)
+    {
+        if (power > 0.0 && toLoudness (power) > relativeGate)
+        {
+            gatedSum += power;
+            ++gatedCount;
+        }
+    }
+
+    return gatedCount > 0 ? toLoudness (gatedSum / gatedCount) : -1000.0;
+}
+
+//=============================================================================
+template <typename SampleType>
+void RenderEngine::fillAudioFeatures (const SampleType* samples,
+                                      const size_t      numberOfSamples)
+{
+    // Each RMS frame covers the samples fed to the FFT since the last frame.
+    size_t rmsFrameStart = 0;
+
+    for (size_t i = 0; i < numberOfSamples; ++i)
+    {
+        // Extract features.
+        if (fft.process (samples[i]))
+        {
             std::array<double, 13> mfccsFrame;
-            std::memcpy (mfccsFrame.data(), mfccs, sizeof (double) * 13);
+            mfcc.mfcc (fft.magnitudes, mfccsFrame.data());
 
             // Add the mfcc frames here.
-            mfccFeatures.push_back (mfccsFrame);
-            delete[] mfccs;
+            storage->mfccFeatures.push_back (mfccsFrame);
 
             // Root Mean Square.
-            currentRmsFrame /= fftSize;
-            currentRmsFrame = sqrt (currentRmsFrame);
-            rmsFrames.push_back (currentRmsFrame);
-            currentRmsFrame = 0.0;
+            const double sumOfSquares = AudioKernels::sumOfSquares (samples + rmsFrameStart,
+                                                                    int (i + 1 - rmsFrameStart));
+            storage->rmsFrames.push_back (std::sqrt (sumOfSquares / fftSize));
+            rmsFrameStart = i + 1;
         }
     }
 }
@@ -190,13 +601,14 @@ void RenderEngine::ifTimeSetNoteOff (const double& noteLength,
     bool noteOffEvent = bufferBeginIsBeforeEvent && bufferEndIsAfterEvent;
     if (noteOffEvent)
     {
-        MidiBuffer midiOffBuffer;
         MidiMessage offMessage = MidiMessage::noteOff (midiChannel,
                                                        midiPitch,
                                                        midiVelocity);
         offMessage.setTimeStamp(eventFrame);
-        midiOffBuffer.addEvent(offMessage, offMessage.getTimeStamp());
-        bufferToNoteOff = midiOffBuffer;
+
+        // Replace the buffer's contents in place, keeping its allocation.
+        bufferToNoteOff.clear();
+        bufferToNoteOff.addEvent(offMessage, offMessage.getTimeStamp());
     }
 }
 
@@ -248,6 +660,7 @@ bool RenderEngine::overridePluginParameter (const int   index,
     else
         overridenParameters.push_back(std::make_pair(index, value));
 
+    isPatchApplied = false;
     return true;
 }
 
@@ -289,6 +702,7 @@ bool RenderEngine::removeOverridenParameter (const int index)
     if (exists)
     {
         overridenParameters.erase(iterator);
+        isPatchApplied = false;
         return true;
     }
 
@@ -318,34 +732,196 @@ void RenderEngine::fillAvailablePluginParameters (PluginPatch& params)
 }
 
 //==============================================================================
-const String RenderEngine::getPluginParametersDescription()
+void RenderEngine::fillParameterInfo()
 {
-    String parameterListString ("");
+    // Enough points to tell a switch or a handful of modes from a continuous
+    // parameter, without probing every plugin for long.
+    const int numTextSamples = 33;
 
-    if (plugin != nullptr)
-    {
-        std::ostringstream ss;
+    parameterInfo.clear();
+    parameterInfo.reserve (pluginParameters.size());
+    MemoryOutputStream description;
 
-        for (const auto& pair : pluginParameters)
+    for (const auto& parameter : pluginParameters)
+    {
+        const int index = parameter.first;
+        ParameterInfo info;
+        info.index = index;
+        info.name = plugin->getParameterName (index);
+        info.label = plugin->getParameterLabel (index);
+        info.defaultValue = plugin->getParameterDefaultValue (index);
+        info.isAutomatable = plugin->isParameterAutomatable (index);
+        info.isMeta = plugin->isMetaParameter (index);
+
+        const int steps = plugin->getParameterNumSteps (index);
+        const bool hasSteps = steps >= 2 && steps != AudioProcessor::getDefaultNumParameterSteps();
+        info.isDiscrete = plugin->isParameterDiscrete (index) || hasSteps;
+        info.numSteps = hasSteps ? steps : 0;
+
+        if (info.numSteps >= 2 && info.numSteps <= numTextSamples)
+        {
+            info.valueTexts = getValueTexts (index, info.numSteps);
+        }
+        else
         {
-            ss << std::setw (3) << std::setfill (' ') << pair.first;
+            info.valueTexts = getValueTexts (index, numTextSamples);
+
+            if (info.numSteps == 0)
+            {
+                StringArray texts;
+                for (const auto& valueText : info.valueTexts)
+                    texts.addIfNotAlreadyThere (valueText.second);
+
+                const int numTexts = int (texts.size());
+                if (numTexts >= 2 && numTexts <= numTextSamples / 2)
+                {
+                    info.isDiscrete = true;
+                    info.stepsAreInferred = true;
+                    info.numSteps = numTexts;
+                    info.valueTexts = getValueTexts (index, numTexts);
+                }
+            }
+        }
 
-            const String name = plugin->getParameterName (pair.first);
-            const String index (ss.str());
+        info.isBoolean = info.isDiscrete && info.numSteps == 2;
 
-            parameterListString = parameterListString +
-                                  index + ": " + name +
-                                  "\n";
-            ss.str ("");
-            ss.clear();
-        }
+        description << String (index).paddedLeft (' ', 3) << ": " << info.name << "\n";
+        parameterInfo.push_back (std::move (info));
     }
-    else
+
+    parametersDescription = description.toString();
+}
+
+//==============================================================================
+std::vector<std::pair<float, String>> RenderEngine::getValueTexts (const int index,
+                                                                   const int numValues)
+{
+    std::vector<std::pair<float, String>> valueTexts;
+    valueTexts.reserve (size_t (numValues));
+
+    // Hosted plugins only give the text of the current value.
+    const float currentValue = plugin->getParameter (index);
+
+    for (int i = 0; i < numValues; ++i)
+    {
+        const float value = numValues > 1 ? float (i) / float (numValues - 1) : 0.0f;
+        plugin->setParameter (index, value);
+        valueTexts.push_back (std::make_pair (value, plugin->getParameterText (index)));
+    }
+
+    plugin->setParameter (index, currentValue);
+    return valueTexts;
+}
+
+//==============================================================================
+const String RenderEngine::getPluginParametersDescription()
+{
+    if (plugin == nullptr)
     {
         std::cout << "Please load the plugin first!" << std::endl;
+        return String();
+    }
+
+    return parametersDescription;
+}
+
+//==============================================================================
+const std::vector<ParameterInfo>& RenderEngine::getParameterInfo() const
+{
+    return parameterInfo;
+}
+
+//==============================================================================
+int RenderEngine::getNumPrograms() const
+{
+    return plugin != nullptr ? plugin->getNumPrograms() : 0;
+}
+
+//==============================================================================
+String RenderEngine::getProgramName (const int index) const
+{
+    return plugin != nullptr ? plugin->getProgramName (index) : String();
+}
+
+//==============================================================================
+bool RenderEngine::setProgram (const int index)
+{
+    if (plugin == nullptr || ! isPositiveAndBelow (index, plugin->getNumPrograms()))
+    {
+        std::cout << "RenderEngine::setProgram error: There is no program " << index << "." << std::endl;
+        return false;
     }
 
-    return parameterListString;
+    plugin->setCurrentProgram (index);
+    readPatchFromPlugin();
+    return true;
+}
+
+//==============================================================================
+bool RenderEngine::loadPresetFile (const std::string& path)
+{
+    if (plugin == nullptr)
+    {
+        std::cout << "RenderEngine::loadPresetFile error: Please load a plugin first!" << std::endl;
+        return false;
+    }
+
+    const File file = File::getCurrentWorkingDirectory().getChildFile (String (path));
+    MemoryBlock data;
+    if (! file.loadFileAsData (data))
+    {
+        std::cout << "RenderEngine::loadPresetFile error: Couldn't read " << path << "." << std::endl;
+        return false;
+    }
+
+    if (! file.hasFileExtension ("fxp;fxb"))
+        return setState (data);
+
+   #if JUCE_PLUGINHOST_VST
+    if (VSTPluginFormat::loadFromFXBFile (plugin, data.getData(), data.getSize()))
+    {
+        readPatchFromPlugin();
+        return true;
+    }
+   #endif
+
+    std::cout << "RenderEngine::loadPresetFile error: " << path <<
+                 " isn't a preset or bank this plugin can load." << std::endl;
+    return false;
+}
+
+//==============================================================================
+MemoryBlock RenderEngine::getState() const
+{
+    MemoryBlock state;
+    if (plugin != nullptr)
+        plugin->getStateInformation (state);
+    return state;
+}
+
+//==============================================================================
+bool RenderEngine::setState (const MemoryBlock& state)
+{
+    if (plugin == nullptr)
+    {
+        std::cout << "RenderEngine::setState error: Please load a plugin first!" << std::endl;
+        return false;
+    }
+
+    plugin->setStateInformation (state.getData(), int (state.getSize()));
+    readPatchFromPlugin();
+    return true;
+}
+
+//==============================================================================
+void RenderEngine::readPatchFromPlugin()
+{
+    for (auto& parameter : pluginParameters)
+        parameter.second = plugin->getParameter (parameter.first);
+
+    const MemoryBlock state = getState();
+    presetHash = SHA256 (state.getData(), state.getSize()).toHexString();
+    isPatchApplied = false;
 }
 
 //==============================================================================
@@ -357,6 +933,7 @@ void RenderEngine::setPatch (const PluginPatch patch)
     if (currentParameterSize == newPatchParameterSize)
     {
         pluginParameters = patch;
+        isPatchApplied = false;
     }
     else
     {
@@ -400,7 +977,7 @@ const size_t RenderEngine::getPluginParameterSize()
 //==============================================================================
 const MFCCFeatures RenderEngine::getMFCCFrames()
 {
-    return mfccFeatures;
+    return storage->mfccFeatures;
 }
 
 //==============================================================================
@@ -408,6 +985,7 @@ const MFCCFeatures RenderEngine::getNormalisedMFCCFrames(const std::array<double
                                                          const std::array<double, 13>& variance)
 {
     MFCCFeatures normalisedMFCCFrames;
+    const MFCCFeatures& mfccFeatures = storage->mfccFeatures;
     normalisedMFCCFrames.resize (mfccFeatures.size());
 
     for (size_t i = 0; i < normalisedMFCCFrames.size(); ++i)
@@ -424,28 +1002,147 @@ const MFCCFeatures RenderEngine::getNormalisedMFCCFrames(const std::array<double
 //==============================================================================
 const std::vector<double> RenderEngine::getAudioFrames()
 {
-    return processedMonoAudioPreview;
+    const std::vector<float>& monoAudioFrames = storage->monoAudioFrames;
+    if (storage->precision == AudioPrecision::doublePrecision)
+        return storage->processedMonoAudioPreview;
+
+    std::vector<double> audioFrames (monoAudioFrames.size());
+    AudioKernels::convert (audioFrames.data(), monoAudioFrames.data(), int (monoAudioFrames.size()));
+    return audioFrames;
+}
+
+//==============================================================================
+const std::vector<float> RenderEngine::getFloatAudioFrames()
+{
+    if (storage->precision != AudioPrecision::doublePrecision)
+        return storage->monoAudioFrames;
+
+    const std::vector<double>& processedMonoAudioPreview = storage->processedMonoAudioPreview;
+    std::vector<float> audioFrames (processedMonoAudioPreview.size());
+    AudioKernels::convert (audioFrames.data(),
+                           processedMonoAudioPreview.data(),
+                           int (processedMonoAudioPreview.size()));
+    return audioFrames;
+}
+
+//==============================================================================
+void RenderEngine::setAudioPrecision (const AudioPrecision precision)
+{
+    audioPrecision = precision;
 }
 
 //==============================================================================
 const std::vector<double> RenderEngine::getRMSFrames()
 {
-    return rmsFrames;
+    return storage->rmsFrames;
 }
 
 //==============================================================================
 bool RenderEngine::writeToWav(const std::string& path)
 {
-    const auto size = processedMonoAudioPreview.size();
-    if (size == 0)
+    // Always the mono preview as 16 bit, whatever channels were retained.
+    const std::vector<float> audioFrames = getFloatAudioFrames();
+    const float* data = audioFrames.data();
+    return writeAudioFile (File::getCurrentWorkingDirectory().getChildFile (String (path)),
+                           &data,
+                           1,
+                           int (audioFrames.size()),
+                           sampleRate,
+                           AudioFileFormat::wav16);
+}
+
+//==============================================================================
+bool RenderEngine::writeToFile (const std::string&    path,
+                                const AudioFileFormat format,
+                                const int             flacCompression)
+{
+    if (storage->getNumSamples() == 0)
         return false;
 
-    maxiRecorder recorder;
-    recorder.setup (path);
-    recorder.startRecording();
-    const double* data = processedMonoAudioPreview.data();
-    recorder.passData (data, size);
-    recorder.stopRecording();
-    recorder.saveToWav();
+    return writeAudioFile (File::getCurrentWorkingDirectory().getChildFile (String (path)),
+                           *storage,
+                           format,
+                           flacCompression);
+}
+
+//==============================================================================
+void RenderEngine::setNormalisation (const NormalisationMode mode,
+                                     const double            target,
+                                     const double            peakCeiling)
+{
+    normalisationMode = mode;
+    normalisationTarget = target;
+    normalisationCeiling = peakCeiling;
+}
+
+//==============================================================================
+double RenderEngine::getAppliedGain() const
+{
+    return storage->appliedGain;
+}
+
+//==============================================================================
+uint64 RenderEngine::getFingerprint() const
+{
+    return storage->fingerprint;
+}
+
+//==============================================================================
+void RenderEngine::setRetainChannels (const bool shouldRetainChannels)
+{
+    retainChannels = shouldRetainChannels;
+}
+
+//==============================================================================
+bool RenderEngine::setFeatureChannel (const int channel)
+{
+    if (channel == -1)
+    {
+        featureChannel = channel;
+        return true;
+    }
+
+    if (plugin == nullptr)
+    {
+        std::cout << "RenderEngine::setFeatureChannel error: Please load the plugin first!" << std::endl;
+        return false;
+    }
+
+    if (! isPositiveAndBelow (channel, plugin->getTotalNumOutputChannels()))
+    {
+        std::cout << "RenderEngine::setFeatureChannel error: Channel " << channel <<
+                     " isn't -1 or one of the plugin's " << plugin->getTotalNumOutputChannels() <<
+                     " output channels." << std::endl;
+        return false;
+    }
+
+    featureChannel = channel;
     return true;
 }
+
+//==============================================================================
+int RenderEngine::getNumAudioChannels() const
+{
+    return storage->channelAudio.getNumChannels();
+}
+
+//==============================================================================
+const AudioSampleBuffer& RenderEngine::getChannelAudio() const
+{
+    return storage->channelAudio;
+}
+
+//==============================================================================
+const std::vector<float> RenderEngine::getChannelAudioFrames (const int channel) const
+{
+    const AudioSampleBuffer& channelAudio = storage->channelAudio;
+    if (channel < 0 || channel >= channelAudio.getNumChannels())
+    {
+        std::cout << "RenderEngine::getChannelAudioFrames error: " <<
+                     "Channel " << channel << " was not retained." << std::endl;
+        return std::vector<float>();
+    }
+
+    const float* data = channelAudio.getReadPointer (channel);
+    return std::vector<float> (data, data + channelAudio.getNumSamples());
+}
@@ -12,6 +12,7 @@
 #define RENDERENGINE_H_INCLUDED
 
 #include <random>
+#include <numeric>
 #include <array>
 #include <iomanip>
 #include <sstream>
@@ -19,13 +20,51 @@
 #include "Maximilian/maximilian.h"
 #include "Maximilian/libs/maxiFFT.h"
 #include "Maximilian/libs/maxiMFCC.h"
+#include "AudioKernels.h"
+#include "RenderResult.h"
+#include "AudioExport.h"
+#include "RenderCache.h"
+#include "Fingerprint.h"
 #include "../JuceLibraryCode/JuceHeader.h"
 
 using namespace juce;
 
-typedef std::vector<std::pair<int, float>>  PluginPatch;
-typedef std::vector<std::array<double, 13>> MFCCFeatures;
+//==============================================================================
+/** How the rendered audio is rescaled before features are extracted and the
+    audio is exported. Peak and RMS targets are in dBFS, loudness targets are
+    in LUFS (ITU-R BS.1770 integrated, gated loudness).
+*/
+enum class NormalisationMode
+{
+    none,
+    peak,
+    rms,
+    lufs
+};
+
+//==============================================================================
+/** What the plugin reports about one of its parameters, read once when it is
+    loaded. valueTexts holds the text the plugin shows at evenly spaced values,
+    one per step for discrete parameters. Plugin formats that don't report
+    steps get them from the text table when it only holds a few distinct
+    texts, stepsAreInferred is set then.
+*/
+struct ParameterInfo
+{
+    int                                   index = 0;
+    String                                name;
+    String                                label;
+    float                                 defaultValue = 0.0f;
+    int                                   numSteps = 0;
+    bool                                  isDiscrete = false;
+    bool                                  isBoolean = false;
+    bool                                  stepsAreInferred = false;
+    bool                                  isAutomatable = true;
+    bool                                  isMeta = false;
+    std::vector<std::pair<float, String>> valueTexts;
+};
 
+//==============================================================================
 class RenderEngine
 {
 public:
@@ -35,9 +74,22 @@ public:
         sampleRate(sr),
         bufferSize(bs),
         fftSize(ffts),
-        plugin(nullptr)
+        plugin(nullptr),
+        isPatchApplied(false),
+        normalisationMode(NormalisationMode::none),
+        normalisationTarget(0.0),
+        normalisationCeiling(0.0),
+        retainChannels(false),
+        featureChannel(-1),
+        audioPrecision(AudioPrecision::singlePrecision),
+        storagePool(std::make_shared<RenderStoragePool>()),
+        storage(storagePool->acquire())
     {
         maxiSettings::setup (sampleRate, 1, bufferSize);
+
+        // One fft for the engine's lifetime, it is reset between renders so
+        // it doesn't share frames with a new patch.
+        fft.setup (fftSize, fftSize / 2, fftSize / 4);
     }
 
     virtual ~RenderEngine()
@@ -61,6 +113,28 @@ public:
                       const double noteLength,
                       const double renderLength);
 
+    /** Without needsAudio a memory cache that only keeps features may answer,
+        leaving the result without audio.
+    */
+    RenderResult renderPatchToResult (const uint8  midiNote,
+                                      const uint8  midiVelocity,
+                                      const double noteLength,
+                                      const double renderLength,
+                                      const bool   needsAudio = true);
+
+    /** Plays another note of the patch the last render played, without
+        setting every parameter and preparing the plugin again: it is only
+        reset between the notes, which is much cheaper when one patch is
+        rendered at many notes and velocities. If the patch or the overriden
+        parameters changed since the last render it does a full render.
+    */
+    RenderResult renderNoteToResult (const uint8  midiNote,
+                                     const uint8  midiVelocity,
+                                     const double noteLength,
+                                     const double renderLength);
+
+    RenderResult takeResult();
+
     const MFCCFeatures getMFCCFrames();
 
     const MFCCFeatures getNormalisedMFCCFrames (const std::array<double, 13>& mean,
@@ -68,10 +142,39 @@ public:
 
     const std::vector<double> getRMSFrames();
 
+    /** MFCC frames of audio that wasn't rendered, such as a sound to match,
+        normalised and analysed exactly like a render. Needs a loaded plugin
+        for the analysis setup, leaves the last render untouched.
+    */
+    MFCCFeatures analyseAudio (const std::vector<float>& audio);
+
     const size_t getPluginParameterSize();
 
     const String getPluginParametersDescription();
 
+    /** One entry per parameter of the patch, in the same order. */
+    const std::vector<ParameterInfo>& getParameterInfo() const;
+
+    /** The plugin's own programs, the factory presets of most synths. */
+    int getNumPrograms() const;
+
+    String getProgramName (const int index) const;
+
+    /** Switches the plugin to the program and reads the patch back from it,
+        so getPatch() and the renders that follow use the program's values.
+    */
+    bool setProgram (const int index);
+
+    /** Loads a .fxp preset or .fxb bank into a VST, or any other file as a
+        state blob of the plugin, then reads the patch back from it.
+    */
+    bool loadPresetFile (const std::string& path);
+
+    /** The plugin's whole state, as a host would save it with a session. */
+    MemoryBlock getState() const;
+
+    bool setState (const MemoryBlock& state);
+
     bool overridePluginParameter (const int   index,
                                   const float value);
 
@@ -79,11 +182,75 @@ public:
 
     const std::vector<double> getAudioFrames();
 
+    /** The mono audio narrowed to floats, leaving the stored render as it is. */
+    const std::vector<float> getFloatAudioFrames();
+
+    void setAudioPrecision (const AudioPrecision precision);
+
     bool writeToWav(const std::string& path);
 
+    bool writeToFile (const std::string&    path,
+                      const AudioFileFormat format,
+                      const int             flacCompression = 5);
+
+    void setNormalisation (const NormalisationMode mode,
+                           const double            target,
+                           const double            peakCeiling = 0.0);
+
+    double getAppliedGain() const;
+
+    /** The Fingerprint of the last render's MFCC frames. */
+    uint64 getFingerprint() const;
+
+    void setRetainChannels (const bool shouldRetainChannels);
+
+    /** -1 takes the features from the mono mixdown, otherwise they come from
+        that output channel of the loaded plugin. Returns false, keeping the
+        current channel, for anything else.
+    */
+    bool setFeatureChannel (const int channel);
+
+    int getNumAudioChannels() const;
+
+    const AudioSampleBuffer& getChannelAudio() const;
+
+    const std::vector<float> getChannelAudioFrames (const int channel) const;
+
+    /** Looks every render up in the cache before running the plugin, and
+        stores it there afterwards. Engines may share a cache, pass nullptr to
+        stop using it.
+    */
+    void setDiskCache (std::shared_ptr<DiskRenderCache> cache);
+
+    /** Checked before the disk cache. Engines of a pool may share one. */
+    void setMemoryCache (std::shared_ptr<MemoryRenderCache> cache);
+
+    /** SHA-256 of everything that decides the next render: the plugin binary,
+        the patch with its overrides, the note and every engine setting.
+    */
+    String getRenderKey (const uint8  midiNote,
+                         const uint8  midiVelocity,
+                         const double noteLength,
+                         const double renderLength) const;
+
 private:
-    void fillAudioFeatures (const AudioSampleBuffer& data,
-                            maxiFFT&                 fft);
+    template <typename SampleType>
+    void fillAudioFrames (const AudioSampleBuffer&  data,
+                          std::vector<SampleType>& frames,
+                          const int                writePosition);
+
+    template <typename SampleType>
+    void analyseAudioFrames (std::vector<SampleType>& frames);
+
+    template <typename SampleType>
+    void normaliseAudioFrames (std::vector<SampleType>& frames);
+
+    template <typename SampleType>
+    double getIntegratedLoudness (const std::vector<SampleType>& frames) const;
+
+    template <typename SampleType>
+    void fillAudioFeatures (const SampleType* samples,
+                            const size_t      numberOfSamples);
 
     void ifTimeSetNoteOff (const double& noteLength,
                            const double& sampleRate,
@@ -96,17 +263,65 @@ private:
 
     void fillAvailablePluginParameters (PluginPatch& params);
 
+    void fillParameterInfo();
+
+    /** Takes the patch from the plugin after a preset changed it, and keys
+        the caches on the state it left, which may hold more than the
+        parameters.
+    */
+    void readPatchFromPlugin();
+
+    std::vector<std::pair<float, String>> getValueTexts (const int index,
+                                                         const int numValues);
+
+    /** Loads the render from a cache if there is one, else renders it. */
+    void renderWithCaches (const uint8  midiNote,
+                           const uint8  midiVelocity,
+                           const double noteLength,
+                           const double renderLength,
+                           const bool   reusePatch,
+                           const bool   needsAudio);
+
+    void renderPluginPatch (const uint8  midiNote,
+                            const uint8  midiVelocity,
+                            const double noteLength,
+                            const double renderLength,
+                            const bool   reusePatch);
+
+    void writeRenderSettings (OutputStream& stream,
+                              const uint8   midiNote,
+                              const uint8   midiVelocity,
+                              const double  noteLength,
+                              const double  renderLength) const;
+
     double               sampleRate;
     int                  bufferSize;
     int                  fftSize;
     maxiMFCC             mfcc;
     AudioPluginInstance* plugin;
+    bool                 isPatchApplied;
     PluginPatch          pluginParameters;
     PluginPatch          overridenParameters;
-    MFCCFeatures         mfccFeatures;
-    std::vector<double>  processedMonoAudioPreview;
-    std::vector<double>  rmsFrames;
-    double               currentRmsFrame;
+    std::vector<ParameterInfo> parameterInfo;
+    String               parametersDescription;
+    NormalisationMode    normalisationMode;
+    double               normalisationTarget;
+    double               normalisationCeiling;
+    bool                 retainChannels;
+    int                  featureChannel;
+    AudioPrecision       audioPrecision;
+    maxiFFT              fft;
+    AudioSampleBuffer    processingBuffer;
+    MidiBuffer           midiNoteBuffer;
+
+    std::shared_ptr<RenderStoragePool> storagePool;
+    std::unique_ptr<RenderStorage>     storage;
+
+    std::string                        pluginPath;
+    String                             pluginBinaryHash;
+    String                             presetHash;
+    std::shared_ptr<DiskRenderCache>   diskCache;
+    std::shared_ptr<MemoryRenderCache> memoryCache;
 };
 
 
@@ -0,0 +1,241 @@
+/*
+  ==============================================================================
+
+    RenderPool.cpp
+    Created: 18 Oct 2026 2:48:10pm
+
+  ==============================================================================
+*/
+
+#include "RenderPool.h"
+#include "AudioKernels.h"
+
+//==============================================================================
+const float* RenderGrid::getAudio (const size_t note, const size_t velocity) const
+{
+    return audio.data() + (note * velocities.size() + velocity) * numSamples;
+}
+
+//==============================================================================
+RenderPool::RenderPool (int numEngines,
+                        int sampleRate,
+                        int bufferSize,
+                        int fftSize) :
+    threadPool (jmax (1, numEngines))
+{
+    for (int i = 0; i < jmax (1, numEngines); ++i)
+        engines.emplace_back (new RenderEngine (sampleRate, bufferSize, fftSize));
+}
+
+//==============================================================================
+RenderPool::~RenderPool()
+{
+    threadPool.removeAllJobs (false, -1);
+}
+
+//==============================================================================
+bool RenderPool::loadPlugin (const std::string& path)
+{
+    // Plugins are loaded one after the other on the calling thread, plenty of
+    // them aren't happy being instantiated concurrently.
+    for (auto& engine : engines)
+    {
+        if (! engine->loadPlugin (path))
+        {
+            std::cout << "RenderPool::loadPlugin error: " <<
+                         "Couldn't load the plugin into every engine." << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+//==============================================================================
+int RenderPool::getNumEngines() const
+{
+    return int (engines.size());
+}
+
+//==============================================================================
+RenderEngine& RenderPool::getEngine (const int index)
+{
+    jassert (index >= 0 && index < int (engines.size()));
+    return *engines[size_t (index)];
+}
+
+//==============================================================================
+void RenderPool::forEachEngine (const std::function<void (RenderEngine&)>& function)
+{
+    for (auto& engine : engines)
+        function (*engine);
+}
+
+//==============================================================================
+void RenderPool::run (const size_t                                       numJobs,
+                      const std::function<void (RenderEngine&, size_t)>& job)
+{
+    if (numJobs == 0)
+        return;
+
+    // One pool job per engine, each pulling the next index until none are
+    // left, so a slow patch only holds up its own engine.
+    std::atomic<size_t> nextJob (0);
+    const size_t numWorkers = jmin (engines.size(), numJobs);
+    std::atomic<size_t> remainingWorkers (numWorkers);
+    WaitableEvent finished;
+
+    for (size_t i = 0; i < numWorkers; ++i)
+    {
+        RenderEngine* engine = engines[i].get();
+        threadPool.addJob ([&, engine]
+        {
+            for (size_t index = nextJob++; index < numJobs; index = nextJob++)
+                job (*engine, index);
+
+            if (--remainingWorkers == 0)
+                finished.signal();
+        });
+    }
+
+    finished.wait();
+}
+
+//==============================================================================
+void RenderPool::renderPatches (const std::vector<PluginPatch>& patches,
+                                const RenderSettings&           settings,
+                                const ResultCallback&           onRendered)
+{
+    run (patches.size(), [&] (RenderEngine& engine, size_t index)
+    {
+        engine.setPatch (patches[index]);
+        onRendered (index, engine.renderPatchToResult (settings.midiNote,
+                                                       settings.midiVelocity,
+                                                       settings.noteLength,
+                                                       settings.renderLength,
+                                                       settings.needsAudio));
+    });
+}
+
+//==============================================================================
+std::vector<RenderResult> RenderPool::renderPatches (const std::vector<PluginPatch>& patches,
+                                                     const RenderSettings&           settings)
+{
+    std::vector<RenderResult> results (patches.size());
+    renderPatches (patches, settings, [&results] (size_t index, RenderResult&& result)
+    {
+        results[index] = std::move (result);
+    });
+    return results;
+}
+
+//==============================================================================
+bool RenderPool::loadPresetFile (const std::string& path)
+{
+    bool loaded = true;
+    forEachEngine ([&] (RenderEngine& engine)
+    {
+        loaded = engine.loadPresetFile (path) && loaded;
+    });
+    return loaded;
+}
+
+//==============================================================================
+void RenderPool::renderPrograms (const RenderSettings& settings,
+                                 const PresetCallback& onRendered)
+{
+    renderPresets (size_t (jmax (0, getEngine (0).getNumPrograms())), [] (RenderEngine& engine, size_t index)
+    {
+        return engine.setProgram (int (index));
+    }, settings, onRendered);
+}
+
+//==============================================================================
+void RenderPool::renderPresetFiles (const std::vector<std::string>& paths,
+                                    const RenderSettings&           settings,
+                                    const PresetCallback&           onRendered)
+{
+    renderPresets (paths.size(), [&paths] (RenderEngine& engine, size_t index)
+    {
+        return engine.loadPresetFile (paths[index]);
+    }, settings, onRendered);
+}
+
+//==============================================================================
+void RenderPool::renderPresets (const size_t                                       numPresets,
+                                const std::function<bool (RenderEngine&, size_t)>& loadPreset,
+                                const RenderSettings&                              settings,
+                                const PresetCallback&                              onRendered)
+{
+    run (numPresets, [&] (RenderEngine& engine, size_t index)
+    {
+        if (! loadPreset (engine, index))
+        {
+            onRendered (index, PluginPatch(), RenderResult());
+            return;
+        }
+
+        const PluginPatch patch = engine.getPatch();
+        onRendered (index, patch, engine.renderPatchToResult (settings.midiNote,
+                                                              settings.midiVelocity,
+                                                              settings.noteLength,
+                                                              settings.renderLength));
+    });
+}
+
+//==============================================================================
+RenderGrid RenderPool::renderGrid (const PluginPatch&        patch,
+                                   const std::vector<uint8>& notes,
+                                   const std::vector<uint8>& velocities,
+                                   const double              noteLength,
+                                   const double              renderLength,
+                                   const ResultCallback&     onRendered)
+{
+    RenderGrid grid;
+    grid.notes = notes;
+    grid.velocities = velocities;
+
+    // Only the parameters are copied here, each engine's plugin gets them
+    // with its first render of the grid.
+    forEachEngine ([&patch] (RenderEngine& engine)
+    {
+        engine.setPatch (patch);
+    });
+
+    // Every render of the grid has the same length, the first one to finish
+    // sizes the block.
+    std::mutex lock;
+    run (notes.size() * velocities.size(), [&] (RenderEngine& engine, size_t index)
+    {
+        RenderResult result = engine.renderNoteToResult (notes[index / velocities.size()],
+                                                         velocities[index % velocities.size()],
+                                                         noteLength,
+                                                         renderLength);
+        if (result.isValid())
+        {
+            const RenderStorage& render = *result;
+            const bool isDouble = render.precision == AudioPrecision::doublePrecision;
+            const size_t numSamples = isDouble ? render.processedMonoAudioPreview.size()
+                                               : render.monoAudioFrames.size();
+            {
+                std::lock_guard<std::mutex> guard (lock);
+                if (grid.audio.empty())
+                {
+                    grid.numSamples = numSamples;
+                    grid.audio.assign (notes.size() * velocities.size() * numSamples, 0.0f);
+                }
+            }
+
+            float* row = grid.audio.data() + index * grid.numSamples;
+            const int numToCopy = int (jmin (numSamples, grid.numSamples));
+            if (isDouble)
+                AudioKernels::convert (row, render.processedMonoAudioPreview.data(), numToCopy);
+            else
+                AudioKernels::convert (row, render.monoAudioFrames.data(), numToCopy);
+        }
+
+        if (onRendered != nullptr)
+            onRendered (index, std::move (result));
+    });
+
+    return grid;
+}
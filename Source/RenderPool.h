@@ -0,0 +1,137 @@
+/*
+  ==============================================================================
+
+    RenderPool.h
+    Created: 18 Oct 2026 2:48:10pm
+
+  ==============================================================================
+*/
+
+#ifndef RENDERPOOL_H_INCLUDED
+#define RENDERPOOL_H_INCLUDED
+
+#include <functional>
+#include "RenderEngine.h"
+
+//==============================================================================
+/** The note that is played for every patch of a batch. Searches that only
+    look at the features clear needsAudio, so a memory cache that keeps only
+    features can answer them.
+*/
+struct RenderSettings
+{
+    uint8  midiNote     = 60;
+    uint8  midiVelocity = 127;
+    double noteLength   = 1.0;
+    double renderLength = 2.0;
+    bool   needsAudio   = true;
+};
+
+//==============================================================================
+/** The mono audio of one patch played at every combination of some notes and
+    velocities, as one contiguous block of shape [notes, velocities,
+    numSamples]. A render that failed leaves its row silent.
+*/
+struct RenderGrid
+{
+    std::vector<uint8> notes;
+    std::vector<uint8> velocities;
+    size_t             numSamples = 0;
+    std::vector<float> audio;
+
+    const float* getAudio (const size_t note, const size_t velocity) const;
+};
+
+//==============================================================================
+/** A set of engines, each with its own instance of the same plugin, that
+    render batches of patches in parallel. Each engine renders on one thread
+    at a time, so plugins never see concurrent calls.
+*/
+class RenderPool
+{
+public:
+    typedef std::function<void (size_t, RenderResult&&)> ResultCallback;
+
+    /** Like a ResultCallback, with the patch the preset set. */
+    typedef std::function<void (size_t, const PluginPatch&, RenderResult&&)> PresetCallback;
+
+    RenderPool (int numEngines,
+                int sampleRate,
+                int bufferSize,
+                int fftSize);
+
+    ~RenderPool();
+
+    bool loadPlugin (const std::string& path);
+
+    int getNumEngines() const;
+
+    RenderEngine& getEngine (const int index);
+
+    /** Calls the function once for every engine, for example to set the same
+        normalisation or overriden parameters on all of them.
+    */
+    void forEachEngine (const std::function<void (RenderEngine&)>& function);
+
+    /** Renders every patch and hands each result to the callback as soon as it
+        is ready, on the thread that rendered it. Results arrive out of order,
+        the index says which patch they belong to. Blocks until all are done.
+    */
+    void renderPatches (const std::vector<PluginPatch>& patches,
+                        const RenderSettings&           settings,
+                        const ResultCallback&           onRendered);
+
+    std::vector<RenderResult> renderPatches (const std::vector<PluginPatch>& patches,
+                                             const RenderSettings&           settings);
+
+    /** Loads the preset or bank into every engine, so a bank's programs can
+        be rendered with renderPrograms.
+    */
+    bool loadPresetFile (const std::string& path);
+
+    /** Renders every program of the plugin, each engine switching its own
+        instance to the program before playing the note. The index is the
+        program's.
+    */
+    void renderPrograms (const RenderSettings& settings,
+                         const PresetCallback& onRendered);
+
+    /** Renders each preset file, loaded with RenderEngine::loadPresetFile.
+        A file that doesn't load gives an empty result and patch. Engines are
+        left with whichever preset they rendered last.
+    */
+    void renderPresetFiles (const std::vector<std::string>& paths,
+                            const RenderSettings&           settings,
+                            const PresetCallback&           onRendered);
+
+    /** Renders the patch at every note and velocity. Each engine applies the
+        patch once and only resets the plugin between the notes it plays,
+        see RenderEngine::renderNoteToResult. Combination (note i, velocity
+        j) is handed to the callback, if there is one, with the index
+        i * velocities.size() + j once its audio is in the grid.
+    */
+    RenderGrid renderGrid (const PluginPatch&        patch,
+                           const std::vector<uint8>& notes,
+                           const std::vector<uint8>& velocities,
+                           const double              noteLength,
+                           const double              renderLength,
+                           const ResultCallback&     onRendered = nullptr);
+
+    /** Runs job (engine, index) for every index in [0, numJobs), spreading the
+        indices over the engines. The building block for the batch renders.
+    */
+    void run (const size_t                                         numJobs,
+              const std::function<void (RenderEngine&, size_t)>&   job);
+
+private:
+    /** Renders preset i after loadPreset (engine, i) put it into the engine. */
+    void renderPresets (const size_t                                       numPresets,
+                        const std::function<bool (RenderEngine&, size_t)>& loadPreset,
+                        const RenderSettings&                              settings,
+                        const PresetCallback&                              onRendered);
+
+    std::vector<std::unique_ptr<RenderEngine>> engines;
+    ThreadPool                                 threadPool;
+};
+
+#endif  // RENDERPOOL_H_INCLUDED
@@ -0,0 +1,133 @@
+/*
+  ==============================================================================
+
+    RenderResult.cpp
+    Created: 18 Oct 2026 11:02:37am
+
+  ==============================================================================
+*/
+
+#include "RenderResult.h"
+
+//==============================================================================
+void RenderStorage::clear()
+{
+    monoAudioFrames.clear();
+    processedMonoAudioPreview.clear();
+    channelAudio.setSize (0, 0, false, false, true);
+    mfccFeatures.clear();
+    rmsFrames.clear();
+    appliedGain = 1.0;
+    fingerprint = 0;
+}
+
+//==============================================================================
+size_t RenderStorage::getNumSamples() const
+{
+    if (precision == AudioPrecision::doublePrecision)
+        return processedMonoAudioPreview.size();
+
+    return monoAudioFrames.size();
+}
+
+//==============================================================================
+std::unique_ptr<RenderStorage> RenderStoragePool::acquire()
+{
+    {
+        std::lock_guard<std::mutex> guard (lock);
+        if (! freeStorage.empty())
+        {
+            std::unique_ptr<RenderStorage> storage = std::move (freeStorage.back());
+            freeStorage.pop_back();
+            return storage;
+        }
+    }
+    return std::unique_ptr<RenderStorage> (new RenderStorage());
+}
+
+//==============================================================================
+void RenderStoragePool::release (std::unique_ptr<RenderStorage> storage)
+{
+    if (storage == nullptr)
+        return;
+
+    storage->clear();
+
+    std::lock_guard<std::mutex> guard (lock);
+    freeStorage.push_back (std::move (storage));
+}
+
+//==============================================================================
+size_t RenderStoragePool::getNumFree() const
+{
+    std::lock_guard<std::mutex> guard (lock);
+    return freeStorage.size();
+}
+
+//==============================================================================
+RenderResult::RenderResult() noexcept
+{
+}
+
+//==============================================================================
+RenderResult::RenderResult (std::unique_ptr<RenderStorage>     s,
+                            std::shared_ptr<RenderStoragePool> p) noexcept :
+    storage (std::move (s)),
+    pool (std::move (p))
+{
+}
+
+//==============================================================================
+RenderResult::RenderResult (RenderResult&& other) noexcept :
+    storage (std::move (other.storage)),
+    pool (std::move (other.pool))
+{
+}
+
+//==============================================================================
+RenderResult& RenderResult::operator= (RenderResult&& other) noexcept
+{
+    if (this != &other)
+    {
+        reset();
+        storage = std::move (other.storage);
+        pool = std::move (other.pool);
+    }
+    return *this;
+}
+
+//==============================================================================
+RenderResult::~RenderResult()
+{
+    reset();
+}
+
+//==============================================================================
+bool RenderResult::isValid() const noexcept
+{
+    return storage != nullptr;
+}
+
+//==============================================================================
+const RenderStorage& RenderResult::operator*() const noexcept
+{
+    jassert (storage != nullptr);
+    return *storage;
+}
+
+//==============================================================================
+const RenderStorage* RenderResult::operator->() const noexcept
+{
+    jassert (storage != nullptr);
+    return storage.get();
+}
+
+//==============================================================================
+void RenderResult::reset()
+{
+    if (pool != nullptr)
+        pool->release (std::move (storage));
+
+    storage.reset();
+    pool.reset();
+}
@@ -0,0 +1,108 @@
+/*
+  ==============================================================================
+
+    RenderResult.h
+    Created: 18 Oct 2026 11:02:37am
+
+  ==============================================================================
+*/
+
+#ifndef RENDERRESULT_H_INCLUDED
+#define RENDERRESULT_H_INCLUDED
+
+#include <array>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "../JuceLibraryCode/JuceHeader.h"
+
+using namespace juce;
+
+typedef std::vector<std::array<double, 13>> MFCCFeatures;
+typedef std::vector<std::pair<int, float>>  PluginPatch;
+
+//==============================================================================
+/** Precision the rendered mono audio is stored and analysed in. Plugins render
+    in single precision, so doubles only widen what is already there.
+*/
+enum class AudioPrecision
+{
+    singlePrecision,
+    doublePrecision
+};
+
+//==============================================================================
+/** Everything one render produces. The vectors are cleared rather than freed
+    between renders so a recycled storage keeps its capacity.
+*/
+struct RenderStorage
+{
+    void clear();
+
+    size_t getNumSamples() const;
+
+    double              sampleRate = 44100.0;
+    AudioPrecision      precision = AudioPrecision::singlePrecision;
+    std::vector<float>  monoAudioFrames;
+    std::vector<double> processedMonoAudioPreview;
+    AudioSampleBuffer   channelAudio;
+    MFCCFeatures        mfccFeatures;
+    std::vector<double> rmsFrames;
+    double              appliedGain = 1.0;
+    uint64              fingerprint = 0;
+};
+
+//==============================================================================
+/** A free list of RenderStorage shared by an engine and every result it has
+    handed out. Results may be released on any thread.
+*/
+class RenderStoragePool
+{
+public:
+    std::unique_ptr<RenderStorage> acquire();
+
+    void release (std::unique_ptr<RenderStorage> storage);
+
+    size_t getNumFree() const;
+
+private:
+    mutable std::mutex                          lock;
+    std::vector<std::unique_ptr<RenderStorage>> freeStorage;
+};
+
+//==============================================================================
+/** Move-only owner of one render's audio and features. The storage goes back
+    to the pool it came from when the result is destroyed, so in steady state
+    rendering doesn't touch the heap.
+*/
+class RenderResult
+{
+public:
+    RenderResult() noexcept;
+
+    RenderResult (std::unique_ptr<RenderStorage>     storage,
+                  std::shared_ptr<RenderStoragePool> pool) noexcept;
+
+    RenderResult (RenderResult&& other) noexcept;
+
+    RenderResult& operator= (RenderResult&& other) noexcept;
+
+    ~RenderResult();
+
+    RenderResult (const RenderResult&) = delete;
+    RenderResult& operator= (const RenderResult&) = delete;
+
+    bool isValid() const noexcept;
+
+    const RenderStorage& operator*() const noexcept;
+
+    const RenderStorage* operator->() const noexcept;
+
+    void reset();
+
+private:
+    std::unique_ptr<RenderStorage>     storage;
+    std::shared_ptr<RenderStoragePool> pool;
+};
+
+#endif  // RENDERRESULT_H_INCLUDED
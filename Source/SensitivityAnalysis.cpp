@@ -0,0 +1,203 @@
+/*
+  ==============================================================================
+
+    SensitivityAnalysis.cpp
+    Created: 18 Oct 2026 8:31:05pm
+
+  ==============================================================================
+*/
+
+#include "SensitivityAnalysis.h"
+
+//==============================================================================
+SensitivityAnalysis::SensitivityAnalysis (RenderPool&           pool,
+                                          const RenderSettings& settings) :
+    renderPool (pool),
+    renderSettings (settings)
+{
+    // The effects are measured on the features alone.
+    renderSettings.needsAudio = false;
+
+    for (const auto& info : renderPool.getEngine (0).getParameterInfo())
+        basePatch.push_back (std::make_pair (info.index, info.defaultValue));
+}
+
+//==============================================================================
+void SensitivityAnalysis::setBasePatch (const PluginPatch& patch)
+{
+    if (patch.size() != basePatch.size())
+    {
+        std::cout << "SensitivityAnalysis::setBasePatch error: Incorrect patch size!" <<
+        "\n- Current size:  " << basePatch.size() <<
+        "\n- Supplied size: " << patch.size() << std::endl;
+        return;
+    }
+    basePatch = patch;
+}
+
+//==============================================================================
+const PluginPatch& SensitivityAnalysis::getBasePatch() const
+{
+    return basePatch;
+}
+
+//==============================================================================
+std::vector<ParameterSensitivity> SensitivityAnalysis::analyse (const std::vector<int>& parameterIndices,
+                                                                const int               numTrajectories,
+                                                                const int               numLevels,
+                                                                const uint64            seed,
+                                                                const int               numBootstrapSamples,
+                                                                const double            confidence)
+{
+    // Positions in the patch of the analysed parameters.
+    std::vector<size_t> positions;
+    for (size_t i = 0; i < basePatch.size(); ++i)
+    {
+        if (parameterIndices.empty()
+             || std::find (parameterIndices.begin(), parameterIndices.end(), basePatch[i].first) != parameterIndices.end())
+            positions.push_back (i);
+    }
+
+    const size_t numParameters = positions.size();
+    const size_t trajectoryLength = numParameters + 1;
+    const int levels = jmax (2, numLevels & ~1);
+    const float delta = float (levels) / float (2 * (levels - 1));
+
+    if (numParameters == 0 || numTrajectories <= 0)
+    {
+        std::cout << "SensitivityAnalysis::analyse error: Nothing to analyse." << std::endl;
+        return {};
+    }
+
+    std::mt19937_64 generator (seed);
+    std::uniform_int_distribution<int> lowLevel (0, levels / 2 - 1);
+    std::bernoulli_distribution goUp (0.5);
+
+    // effects[p * numTrajectories + t] is the effect of parameter p in
+    // trajectory t.
+    std::vector<double> effects (numParameters * size_t (numTrajectories), 0.0);
+
+    // Whole trajectories per batch, enough of them to keep every engine busy
+    // without holding the features of every render at once.
+    const size_t targetBatch = size_t (renderPool.getNumEngines()) * 16;
+    const size_t trajectoriesPerBatch = jmax<size_t> (1, targetBatch / trajectoryLength);
+
+    std::vector<PluginPatch> patches;
+    std::vector<size_t> movedParameter;
+    std::vector<MFCCFeatures> features;
+    std::vector<size_t> order (numParameters);
+
+    for (size_t firstTrajectory = 0; firstTrajectory < size_t (numTrajectories); firstTrajectory += trajectoriesPerBatch)
+    {
+        const size_t batchTrajectories = jmin (trajectoriesPerBatch, size_t (numTrajectories) - firstTrajectory);
+        patches.clear();
+        movedParameter.clear();
+
+        for (size_t t = 0; t < batchTrajectories; ++t)
+        {
+            PluginPatch point = basePatch;
+            std::vector<float> otherValue (numParameters);
+
+            for (size_t p = 0; p < numParameters; ++p)
+            {
+                const float low = float (lowLevel (generator)) / float (levels - 1);
+                const bool up = goUp (generator);
+                point[positions[p]].second = up ? low : low + delta;
+                otherValue[p] = up ? low + delta : low;
+                order[p] = p;
+            }
+            std::shuffle (order.begin(), order.end(), generator);
+
+            patches.push_back (point);
+            movedParameter.push_back (numParameters);
+
+            for (const size_t p : order)
+            {
+                point[positions[p]].second = otherValue[p];
+                patches.push_back (point);
+                movedParameter.push_back (p);
+            }
+        }
+
+        features.assign (patches.size(), MFCCFeatures());
+        renderPool.renderPatches (patches, renderSettings, [&] (size_t index, RenderResult&& result)
+        {
+            features[index] = result->mfccFeatures;
+        });
+
+        for (size_t t = 0; t < batchTrajectories; ++t)
+        {
+            const size_t first = t * trajectoryLength;
+            for (size_t step = 1; step < trajectoryLength; ++step)
+            {
+                const double distance = FeatureDistance::distance (FeatureDistance::fromMfcc (features[first + step - 1]),
+                                                                   FeatureDistance::fromMfcc (features[first + step]),
+                                                                   DistanceMetric::euclidean);
+                effects[movedParameter[first + step] * size_t (numTrajectories) + firstTrajectory + t] = distance / delta;
+            }
+        }
+    }
+
+    // Percentile bootstrap of mu* over the trajectories.
+    const double tail = jlimit (0.0, 0.5, (1.0 - confidence) / 2.0);
+    const int numResamples = jmax (1, numBootstrapSamples);
+    std::uniform_int_distribution<int> pick (0, numTrajectories - 1);
+    std::vector<double> resampledMeans (static_cast<size_t> (numResamples));
+    std::vector<ParameterSensitivity> results;
+    results.reserve (numParameters);
+
+    for (size_t p = 0; p < numParameters; ++p)
+    {
+        const double* effect = effects.data() + p * size_t (numTrajectories);
+        const double mean = std::accumulate (effect, effect + numTrajectories, 0.0) / numTrajectories;
+
+        double sumOfSquares = 0.0;
+        for (int t = 0; t < numTrajectories; ++t)
+            sumOfSquares += (effect[t] - mean) * (effect[t] - mean);
+
+        for (auto& resampledMean : resampledMeans)
+        {
+            double sum = 0.0;
+            for (int t = 0; t < numTrajectories; ++t)
+                sum += effect[pick (generator)];
+            resampledMean = sum / numTrajectories;
+        }
+        std::sort (resampledMeans.begin(), resampledMeans.end());
+
+        ParameterSensitivity result;
+        result.index = basePatch[positions[p]].first;
+        result.meanEffect = mean;
+        result.standardDeviation = numTrajectories > 1 ? std::sqrt (sumOfSquares / (numTrajectories - 1)) : 0.0;
+        result.lowerBound = resampledMeans[size_t (tail * (numResamples - 1))];
+        result.upperBound = resampledMeans[size_t ((1.0 - tail) * (numResamples - 1))];
+        results.push_back (result);
+    }
+
+    return results;
+}
+
+//==============================================================================
+PatchConstraints SensitivityAnalysis::getInertParameterConstraints (const std::vector<ParameterSensitivity>& results,
+                                                                    const double                             threshold) const
+{
+    PatchConstraints constraints;
+
+    for (const auto& result : results)
+    {
+        if (result.upperBound >= threshold)
+            continue;
+
+        for (const auto& parameter : basePatch)
+        {
+            if (parameter.first == result.index)
+            {
+                ParameterConstraint constraint;
+                constraint.isFixed = true;
+                constraint.fixedValue = parameter.second;
+                constraints.setConstraint (result.index, constraint);
+                break;
+            }
+        }
+    }
+    return constraints;
+}
@@ -0,0 +1,77 @@
+/*
+  ==============================================================================
+
+    SensitivityAnalysis.h
+    Created: 18 Oct 2026 8:31:05pm
+
+  ==============================================================================
+*/
+
+#ifndef SENSITIVITYANALYSIS_H_INCLUDED
+#define SENSITIVITYANALYSIS_H_INCLUDED
+
+#include "RenderPool.h"
+#include "PatchConstraints.h"
+#include "FeatureDistance.h"
+
+//==============================================================================
+/** How much the sound depends on one parameter. meanEffect is Morris' mu*,
+    the mean feature distance per unit change of the parameter, with a
+    bootstrap confidence interval. A large standardDeviation next to it means
+    the effect depends on the other parameters.
+*/
+struct ParameterSensitivity
+{
+    int    index = 0;
+    double meanEffect = 0.0;
+    double standardDeviation = 0.0;
+    double lowerBound = 0.0;
+    double upperBound = 0.0;
+};
+
+//==============================================================================
+/** Morris elementary effects screening, rendered on the engines of a pool.
+
+    Every trajectory starts at a random point of a grid of numLevels values
+    per parameter and moves one parameter at a time by the same step, in a
+    random order. The effect of a move is the MFCC distance between the two
+    renders divided by the step. Parameters that aren't analysed keep their
+    value from the base patch, which defaults to the plugin's default values.
+
+    Needs numTrajectories * (numParameters + 1) renders.
+*/
+class SensitivityAnalysis
+{
+public:
+    SensitivityAnalysis (RenderPool&           pool,
+                         const RenderSettings& settings);
+
+    void setBasePatch (const PluginPatch& patch);
+
+    const PluginPatch& getBasePatch() const;
+
+    /** Analyses the parameters with the given indices, or every parameter of
+        the patch if there are none. numLevels is rounded down to an even
+        number of at least 2.
+    */
+    std::vector<ParameterSensitivity> analyse (const std::vector<int>& parameterIndices,
+                                               const int               numTrajectories,
+                                               const int               numLevels,
+                                               const uint64            seed,
+                                               const int               numBootstrapSamples = 1000,
+                                               const double            confidence = 0.95);
+
+    /** Constraints that freeze every parameter whose upper bound is below
+        threshold at its value in the base patch, ready to be saved and shared
+        by later jobs.
+    */
+    PatchConstraints getInertParameterConstraints (const std::vector<ParameterSensitivity>& results,
+                                                   const double                             threshold) const;
+
+private:
+    RenderPool&    renderPool;
+    RenderSettings renderSettings;
+    PluginPatch    basePatch;
+};
+
+#endif  // SENSITIVITYANALYSIS_H_INCLUDED
@@ -0,0 +1,628 @@
+/*
+  ==============================================================================
+
+    SoundMatcher.cpp
+    Created: 18 Oct 2026 9:12:44pm
+
+  ==============================================================================
+*/
+
+#include "SoundMatcher.h"
+
+//==============================================================================
+// Householder reduction of the symmetric matrix in vectors (n x n, row major)
+// to tridiagonal form, then the implicit QL algorithm, after JAMA. Leaves the
+// eigenvectors in the columns of vectors and the eigenvalues in values.
+static void tridiagonalise (const int n, std::vector<double>& vectors, std::vector<double>& values, std::vector<double>& offDiagonal)
+{
+    auto V = [&] (const int row, const int column) -> double& { return vectors[size_t (row * n + column)]; };
+    std::vector<double>& d = values;
+    std::vector<double>& e = offDiagonal;
+
+    for (int j = 0; j < n; ++j)
+        d[size_t (j)] = V (n - 1, j);
+
+    for (int i = n - 1; i > 0; --i)
+    {
+        double scale = 0.0;
+        double h = 0.0;
+        for (int k = 0; k < i; ++k)
+            scale += std::abs (d[size_t (k)]);
+
+        if (scale == 0.0)
+        {
+            e[size_t (i)] = d[size_t (i - 1)];
+            for (int j = 0; j < i; ++j)
+            {
+                d[size_t (j)] = V (i - 1, j);
+                V (i, j) = 0.0;
+                V (j, i) = 0.0;
+            }
+        }
+        else
+        {
+            for (int k = 0; k < i; ++k)
+            {
+                d[size_t (k)] /= scale;
+                h += d[size_t (k)] * d[size_t (k)];
+            }
+
+            double f = d[size_t (i - 1)];
+            double g = f > 0.0 ? -std::sqrt (h) : std::sqrt (h);
+            e[size_t (i)] = scale * g;
+            h -= f * g;
+            d[size_t (i - 1)] = f - g;
+
+            for (int j = 0; j < i; ++j)
+                e[size_t (j)] = 0.0;
+
+            for (int j = 0; j < i; ++j)
+            {
+                f = d[size_t (j)];
+                V (j, i) = f;
+                g = e[size_t (j)] + V (j, j) * f;
+                for (int k = j + 1; k <= i - 1; ++k)
+                {
+                    g += V (k, j) * d[size_t (k)];
+                    e[size_t (k)] += V (k, j) * f;
+                }
+                e[size_t (j)] = g;
+            }
+
+            f = 0.0;
+            for (int j = 0; j < i; ++j)
+            {
+                e[size_t (j)] /= h;
+                f += e[size_t (j)] * d[size_t (j)];
+            }
+
+            const double hh = f / (h + h);
+            for (int j = 0; j < i; ++j)
+                e[size_t (j)] -= hh * d[size_t (j)];
+
+            for (int j = 0; j < i; ++j)
+            {
+                f = d[size_t (j)];
+                g = e[size_t (j)];
+                for (int k = j; k <= i - 1; ++k)
+                    V (k, j) -= f * e[size_t (k)] + g * d[size_t (k)];
+
+                d[size_t (j)] = V (i - 1, j);
+                V (i, j) = 0.0;
+            }
+        }
+        d[size_t (i)] = h;
+    }
+
+    // Accumulate the transformations.
+    for (int i = 0; i < n - 1; ++i)
+    {
+        V (n - 1, i) = V (i, i);
+        V (i, i) = 1.0;
+        const double h = d[size_t (i + 1)];
+
+        if (h != 0.0)
+        {
+            for (int k = 0; k <= i; ++k)
+                d[size_t (k)] = V (k, i + 1) / h;
+
+            for (int j = 0; j <= i; ++j)
+            {
+                double g = 0.0;
+                for (int k = 0; k <= i; ++k)
+                    g += V (k, i + 1) * V (k, j);
+                for (int k = 0; k <= i; ++k)
+                    V (k, j) -= g * d[size_t (k)];
+            }
+        }
+
+        for (int k = 0; k <= i; ++k)
+            V (k, i + 1) = 0.0;
+    }
+
+    for (int j = 0; j < n; ++j)
+    {
+        d[size_t (j)] = V (n - 1, j);
+        V (n - 1, j) = 0.0;
+    }
+    V (n - 1, n - 1) = 1.0;
+    e[0] = 0.0;
+}
+
+static void diagonalise (const int n, std::vector<double>& vectors, std::vector<double>& values, std::vector<double>& offDiagonal)
+{
+    auto V = [&] (const int row, const int column) -> double& { return vectors[size_t (row * n + column)]; };
+    std::vector<double>& d = values;
+    std::vector<double>& e = offDiagonal;
+
+    for (int i = 1; i < n; ++i)
+        e[size_t (i - 1)] = e[size_t (i)];
+    e[size_t (n - 1)] = 0.0;
+
+    double f = 0.0;
+    double largest = 0.0;
+    const double epsilon = std::numeric_limits<double>::epsilon();
+
+    for (int l = 0; l < n; ++l)
+    {
+        largest = jmax (largest, std::abs (d[size_t (l)]) + std::abs (e[size_t (l)]));
+
+        int m = l;
+        while (m < n && std::abs (e[size_t (m)]) > epsilon * largest)
+            ++m;
+
+        if (m > l)
+        {
+            do
+            {
+                double g = d[size_t (l)];
+                double p = (d[size_t (l + 1)] - g) / (2.0 * e[size_t (l)]);
+                double r = std::hypot (p, 1.0);
+                if (p < 0.0)
+                    r = -r;
+
+                d[size_t (l)] = e[size_t (l)] / (p + r);
+                d[size_t (l + 1)] = e[size_t (l)] * (p + r);
+                const double dl1 = d[size_t (l + 1)];
+                double h = g - d[size_t (l)];
+                for (int i = l + 2; i < n; ++i)
+                    d[size_t (i)] -= h;
+                f += h;
+
+                p = d[size_t (m)];
+                double c = 1.0, c2 = 1.0, c3 = 1.0;
+                const double el1 = e[size_t (l + 1)];
+                double s = 0.0, s2 = 0.0;
+
+                for (int i = m - 1; i >= l; --i)
+                {
+                    c3 = c2;
+                    c2 = c;
+                    s2 = s;
+                    g = c * e[size_t (i)];
+                    h = c * p;
+                    r = std::hypot (p, e[size_t (i)]);
+                    e[size_t (i + 1)] = s * r;
+                    s = e[size_t (i)] / r;
+                    c = p / r;
+                    p = c * d[size_t (i)] - s * g;
+                    d[size_t (i + 1)] = h + s * (c * g + s * d[size_t (i)]);
+
+                    for (int k = 0; k < n; ++k)
+                    {
+                        h = V (k, i + 1);
+                        V (k, i + 1) = s * V (k, i) + c * h;
+                        V (k, i) = c * V (k, i) - s * h;
+                    }
+                }
+
+                p = -s * s2 * c3 * el1 * e[size_t (l)] / dl1;
+                e[size_t (l)] = s * p;
+                d[size_t (l)] = c * p;
+            }
+            while (std::abs (e[size_t (l)]) > epsilon * largest);
+        }
+
+        d[size_t (l)] += f;
+        e[size_t (l)] = 0.0;
+    }
+}
+
+//==============================================================================
+SoundMatcher::SoundMatcher (RenderPool&           pool,
+                            const RenderSettings& settings) :
+    renderPool (pool),
+    renderSettings (settings),
+    generator (pool.getEngine (0)),
+    numBest (1),
+    metric (DistanceMetric::euclidean),
+    band (-1),
+    shouldStop (false)
+{
+    // Candidates are only compared on their features.
+    renderSettings.needsAudio = false;
+}
+
+//==============================================================================
+void SoundMatcher::setTarget (const MFCCFeatures& targetFeatures)
+{
+    target = targetFeatures;
+}
+
+//==============================================================================
+bool SoundMatcher::setTargetAudio (const std::vector<float>& audio)
+{
+    target = renderPool.getEngine (0).analyseAudio (audio);
+    return ! target.empty();
+}
+
+//==============================================================================
+PatchGenerator& SoundMatcher::getGenerator()
+{
+    return generator;
+}
+
+//==============================================================================
+void SoundMatcher::stop()
+{
+    shouldStop = true;
+}
+
+//==============================================================================
+std::vector<MatchCandidate> SoundMatcher::match (const MatchSettings&    settings,
+                                                 const ProgressCallback& onGeneration)
+{
+    best.clear();
+    shouldStop = false;
+    numBest = size_t (jmax (1, settings.numBest));
+    metric = settings.metric;
+    band = settings.band;
+
+    if (target.empty())
+    {
+        std::cout << "SoundMatcher::match error: Please set a target first!" << std::endl;
+        return best;
+    }
+
+    // Fixed parameters don't need a dimension of the search.
+    const std::vector<float> zeros (generator.getNumParameters(), 0.0f);
+    const PluginPatch skeleton = generator.getPatch (zeros.data());
+    searchedPositions.clear();
+    for (size_t i = 0; i < skeleton.size(); ++i)
+    {
+        const ParameterConstraint* constraint = generator.getConstraints().getConstraint (skeleton[i].first);
+        if (constraint == nullptr || ! constraint->isFixed)
+            searchedPositions.push_back (i);
+    }
+
+    if (searchedPositions.empty())
+    {
+        std::cout << "SoundMatcher::match error: Every parameter is fixed." << std::endl;
+        return best;
+    }
+
+    return settings.algorithm == MatchAlgorithm::cmaes ? runCmaEs (settings, onGeneration)
+                                                       : runGenetic (settings, onGeneration);
+}
+
+//==============================================================================
+std::vector<MatchCandidate> SoundMatcher::runCmaEs (const MatchSettings&    settings,
+                                                    const ProgressCallback& onGeneration)
+{
+    // Default strategy parameters from Hansen, "The CMA Evolution Strategy:
+    // A Tutorial".
+    const int n = int (searchedPositions.size());
+    const int lambda = settings.populationSize > 0 ? jmax (2, settings.populationSize)
+                                                   : 4 + int (3.0 * std::log (double (n)));
+    const int mu = lambda / 2;
+    const size_t dimensions = searchedPositions.size();
+    const size_t numOffspring = size_t (lambda);
+
+    std::vector<double> weights (static_cast<size_t> (mu));
+    for (int i = 0; i < mu; ++i)
+        weights[size_t (i)] = std::log (mu + 0.5) - std::log (i + 1.0);
+
+    const double sumOfWeights = std::accumulate (weights.begin(), weights.end(), 0.0);
+    double sumOfSquaredWeights = 0.0;
+    for (auto& weight : weights)
+    {
+        weight /= sumOfWeights;
+        sumOfSquaredWeights += weight * weight;
+    }
+
+    const double muEff = 1.0 / sumOfSquaredWeights;
+    const double cSigma = (muEff + 2.0) / (n + muEff + 5.0);
+    const double dSigma = 1.0 + 2.0 * jmax (0.0, std::sqrt ((muEff - 1.0) / (n + 1.0)) - 1.0) + cSigma;
+    const double cC = (4.0 + muEff / n) / (n + 4.0 + 2.0 * muEff / n);
+    const double c1 = 2.0 / ((n + 1.3) * (n + 1.3) + muEff);
+    const double cMu = jmin (1.0 - c1, 2.0 * (muEff - 2.0 + 1.0 / muEff) / ((n + 2.0) * (n + 2.0) + muEff));
+    const double chiN = std::sqrt (double (n)) * (1.0 - 1.0 / (4.0 * n) + 1.0 / (21.0 * n * n));
+    const int eigenInterval = jmax (1, int (lambda / ((c1 + cMu) * n * 10.0)));
+
+    std::vector<double> mean (dimensions, 0.5);
+    std::vector<double> pathSigma (dimensions, 0.0);
+    std::vector<double> pathC (dimensions, 0.0);
+    std::vector<double> covariance (size_t (n * n), 0.0);
+    std::vector<double> basis (size_t (n * n), 0.0);
+    std::vector<double> scales (dimensions, 1.0);
+    std::vector<double> eigenvalues (dimensions);
+    std::vector<double> offDiagonal (dimensions);
+    std::vector<double> weightedStep (dimensions);
+    std::vector<double> temp (dimensions);
+    double sigma = settings.stepSize;
+
+    for (int i = 0; i < n; ++i)
+    {
+        covariance[size_t (i * n + i)] = 1.0;
+        basis[size_t (i * n + i)] = 1.0;
+    }
+
+    std::mt19937_64 random (settings.seed);
+    std::normal_distribution<double> normal;
+    Population population (numOffspring, std::vector<double> (dimensions));
+    Population steps (numOffspring, std::vector<double> (dimensions));
+    Population clamped (numOffspring, std::vector<double> (dimensions));
+    std::vector<double> fitness (numOffspring);
+    std::vector<size_t> order (numOffspring);
+
+    for (int generation = 0; ; ++generation)
+    {
+        // x = m + sigma * B * D * z
+        for (int k = 0; k < lambda; ++k)
+        {
+            for (int i = 0; i < n; ++i)
+                temp[size_t (i)] = scales[size_t (i)] * normal (random);
+
+            for (int i = 0; i < n; ++i)
+            {
+                double sum = 0.0;
+                for (int j = 0; j < n; ++j)
+                    sum += basis[size_t (i * n + j)] * temp[size_t (j)];
+
+                steps[size_t (k)][size_t (i)] = sum;
+                population[size_t (k)][size_t (i)] = mean[size_t (i)] + sigma * sum;
+                clamped[size_t (k)][size_t (i)] = jlimit (0.0, 1.0, population[size_t (k)][size_t (i)]);
+            }
+        }
+
+        const std::vector<double> distances = evaluate (clamped);
+        addCandidates (clamped, distances);
+
+        // Points outside the range are rendered at its edge and ranked worse
+        // the further out they are, scaled to the distances at hand.
+        std::vector<double> sorted (distances);
+        std::nth_element (sorted.begin(), sorted.begin() + lambda / 2, sorted.end());
+        const double penaltyScale = jmax (1.0e-9, sorted[size_t (lambda / 2)]);
+
+        for (int k = 0; k < lambda; ++k)
+        {
+            double outside = 0.0;
+            for (int i = 0; i < n; ++i)
+            {
+                const double excess = population[size_t (k)][size_t (i)] - clamped[size_t (k)][size_t (i)];
+                outside += excess * excess;
+            }
+            fitness[size_t (k)] = distances[size_t (k)] + penaltyScale * outside;
+            order[size_t (k)] = size_t (k);
+        }
+        std::sort (order.begin(), order.end(), [&] (size_t a, size_t b) { return fitness[a] < fitness[b]; });
+
+        // Move the mean to the weighted best steps.
+        std::fill (weightedStep.begin(), weightedStep.end(), 0.0);
+        for (int r = 0; r < mu; ++r)
+            for (int i = 0; i < n; ++i)
+                weightedStep[size_t (i)] += weights[size_t (r)] * steps[order[size_t (r)]][size_t (i)];
+
+        for (int i = 0; i < n; ++i)
+            mean[size_t (i)] += sigma * weightedStep[size_t (i)];
+
+        // C^-1/2 * step = B * D^-1 * B^T * step
+        for (int j = 0; j < n; ++j)
+        {
+            double sum = 0.0;
+            for (int i = 0; i < n; ++i)
+                sum += basis[size_t (i * n + j)] * weightedStep[size_t (i)];
+            temp[size_t (j)] = sum / scales[size_t (j)];
+        }
+
+        const double sigmaFactor = std::sqrt (cSigma * (2.0 - cSigma) * muEff);
+        double pathLength = 0.0;
+        for (int i = 0; i < n; ++i)
+        {
+            double sum = 0.0;
+            for (int j = 0; j < n; ++j)
+                sum += basis[size_t (i * n + j)] * temp[size_t (j)];
+
+            pathSigma[size_t (i)] = (1.0 - cSigma) * pathSigma[size_t (i)] + sigmaFactor * sum;
+            pathLength += pathSigma[size_t (i)] * pathSigma[size_t (i)];
+        }
+        pathLength = std::sqrt (pathLength);
+
+        const bool isStalling = pathLength / std::sqrt (1.0 - std::pow (1.0 - cSigma, 2.0 * (generation + 1)))
+                                 < (1.4 + 2.0 / (n + 1.0)) * chiN;
+        const double hSigma = isStalling ? 1.0 : 0.0;
+        const double cFactor = std::sqrt (cC * (2.0 - cC) * muEff);
+        for (int i = 0; i < n; ++i)
+            pathC[size_t (i)] = (1.0 - cC) * pathC[size_t (i)] + hSigma * cFactor * weightedStep[size_t (i)];
+
+        // Rank one and rank mu update, lower triangle then mirrored.
+        const double keep = 1.0 - c1 - cMu + (1.0 - hSigma) * c1 * cC * (2.0 - cC);
+        for (int i = 0; i < n; ++i)
+        {
+            for (int j = 0; j <= i; ++j)
+            {
+                double rankMu = 0.0;
+                for (int r = 0; r < mu; ++r)
+                {
+                    const std::vector<double>& step = steps[order[size_t (r)]];
+                    rankMu += weights[size_t (r)] * step[size_t (i)] * step[size_t (j)];
+                }
+
+                const double value = keep * covariance[size_t (i * n + j)]
+                                      + c1 * pathC[size_t (i)] * pathC[size_t (j)]
+                                      + cMu * rankMu;
+                covariance[size_t (i * n + j)] = value;
+                covariance[size_t (j * n + i)] = value;
+            }
+        }
+
+        sigma *= std::exp ((cSigma / dSigma) * (pathLength / chiN - 1.0));
+
+        // The decomposition is O(n^3), so it only follows C every few
+        // generations.
+        if ((generation + 1) % eigenInterval == 0)
+        {
+            basis = covariance;
+            tridiagonalise (n, basis, eigenvalues, offDiagonal);
+            diagonalise (n, basis, eigenvalues, offDiagonal);
+
+            for (int i = 0; i < n; ++i)
+                scales[size_t (i)] = std::sqrt (jmax (1.0e-20, eigenvalues[size_t (i)]));
+        }
+
+        if (! shouldContinue (settings, onGeneration, generation))
+            break;
+    }
+
+    return best;
+}
+
+//==============================================================================
+std::vector<MatchCandidate> SoundMatcher::runGenetic (const MatchSettings&    settings,
+                                                      const ProgressCallback& onGeneration)
+{
+    const size_t n = searchedPositions.size();
+    const size_t populationSize = size_t (settings.populationSize > 0 ? jmax (2, settings.populationSize) : 64);
+    const size_t numElites = size_t (jlimit (0, int (populationSize) - 1, settings.numElites));
+
+    std::mt19937_64 random (settings.seed);
+    std::uniform_real_distribution<double> uniform (0.0, 1.0);
+    std::normal_distribution<double> normal (0.0, settings.mutationStrength);
+    std::uniform_int_distribution<size_t> pick (0, populationSize - 1);
+
+    Population population (populationSize, std::vector<double> (n));
+    for (auto& genes : population)
+        for (auto& gene : genes)
+            gene = uniform (random);
+
+    std::vector<double> distances = evaluate (population);
+    addCandidates (population, distances);
+
+    std::vector<size_t> order (populationSize);
+    Population children;
+    Population next;
+    std::vector<double> nextDistances;
+
+    auto tournament = [&]
+    {
+        size_t winner = pick (random);
+        for (int i = 1; i < settings.tournamentSize; ++i)
+        {
+            const size_t challenger = pick (random);
+            if (distances[challenger] < distances[winner])
+                winner = challenger;
+        }
+        return winner;
+    };
+
+    for (int generation = 0; shouldContinue (settings, onGeneration, generation); ++generation)
+    {
+        for (size_t i = 0; i < populationSize; ++i)
+            order[i] = i;
+        std::sort (order.begin(), order.end(), [&] (size_t a, size_t b) { return distances[a] < distances[b]; });
+
+        // Elites go through unchanged and keep their distances, only the
+        // children need rendering.
+        children.clear();
+        while (children.size() < populationSize - numElites)
+        {
+            const std::vector<double>& mother = population[tournament()];
+            const std::vector<double>& father = population[tournament()];
+            std::vector<double> child (mother);
+
+            if (uniform (random) < settings.crossoverRate)
+                for (size_t i = 0; i < n; ++i)
+                    if (uniform (random) < 0.5)
+                        child[i] = father[i];
+
+            for (auto& gene : child)
+                if (uniform (random) < settings.mutationRate)
+                    gene = jlimit (0.0, 1.0, gene + normal (random));
+
+            children.push_back (std::move (child));
+        }
+
+        const std::vector<double> childDistances = evaluate (children);
+        addCandidates (children, childDistances);
+
+        next.clear();
+        nextDistances.clear();
+        for (size_t i = 0; i < numElites; ++i)
+        {
+            next.push_back (population[order[i]]);
+            nextDistances.push_back (distances[order[i]]);
+        }
+        for (size_t i = 0; i < children.size(); ++i)
+        {
+            next.push_back (std::move (children[i]));
+            nextDistances.push_back (childDistances[i]);
+        }
+
+        population.swap (next);
+        distances.swap (nextDistances);
+    }
+
+    return best;
+}
+
+//==============================================================================
+std::vector<double> SoundMatcher::evaluate (const Population& population)
+{
+    std::vector<PluginPatch> patches;
+    patches.reserve (population.size());
+    for (const auto& genes : population)
+        patches.push_back (getPatch (genes));
+
+    const FeatureSequence<double> targetSequence = FeatureDistance::fromMfcc (target);
+    std::vector<double> distances (population.size(), std::numeric_limits<double>::max());
+    renderPool.renderPatches (patches, renderSettings, [&] (size_t index, RenderResult&& result)
+    {
+        distances[index] = FeatureDistance::distance (targetSequence,
+                                                      FeatureDistance::fromMfcc (result->mfccFeatures),
+                                                      metric,
+                                                      band);
+    });
+    return distances;
+}
+
+//==============================================================================
+PluginPatch SoundMatcher::getPatch (const std::vector<double>& genes) const
+{
+    std::vector<float> values (generator.getNumParameters(), 0.0f);
+    for (size_t i = 0; i < searchedPositions.size(); ++i)
+        values[searchedPositions[i]] = float (jlimit (0.0, 1.0, genes[i]));
+    return generator.getPatch (values.data());
+}
+
+//==============================================================================
+void SoundMatcher::addCandidates (const Population&          population,
+                                  const std::vector<double>& distances)
+{
+    for (size_t i = 0; i < population.size(); ++i)
+    {
+        if (best.size() >= numBest && distances[i] >= best.back().distance)
+            continue;
+
+        MatchCandidate candidate;
+        candidate.patch = getPatch (population[i]);
+        candidate.distance = distances[i];
+
+        // Elites and stepped parameters give the same patch again and again.
+        if (std::any_of (best.begin(), best.end(), [&] (const MatchCandidate& other) { return other.patch == candidate.patch; }))
+            continue;
+
+        const auto position = std::upper_bound (best.begin(), best.end(), candidate,
+                                                [] (const MatchCandidate& a, const MatchCandidate& b)
+                                                {
+                                                    return a.distance < b.distance;
+                                                });
+        best.insert (position, std::move (candidate));
+
+        if (best.size() > numBest)
+            best.pop_back();
+    }
+}
+
+//==============================================================================
+bool SoundMatcher::shouldContinue (const MatchSettings&    settings,
+                                   const ProgressCallback& onGeneration,
+                                   const int               generation)
+{
+    if (onGeneration != nullptr && ! best.empty()
+         && ! onGeneration (generation, best.front().distance, best.front().patch))
+        return false;
+
+    return ! shouldStop
+            && generation + 1 < settings.maxGenerations
+            && (best.empty() || best.front().distance > settings.targetDistance);
+}
@@ -0,0 +1,129 @@
+/*
+  ==============================================================================
+
+    SoundMatcher.h
+    Created: 18 Oct 2026 9:12:44pm
+
+  ==============================================================================
+*/
+
+#ifndef SOUNDMATCHER_H_INCLUDED
+#define SOUNDMATCHER_H_INCLUDED
+
+#include <atomic>
+#include "RenderPool.h"
+#include "PatchGenerator.h"
+#include "FeatureDistance.h"
+
+//==============================================================================
+enum class MatchAlgorithm
+{
+    cmaes,
+    genetic
+};
+
+//==============================================================================
+/** Settings of one search. A population size of 0 picks the usual default of
+    the algorithm, 4 + 3 ln(n) for CMA-ES and 64 for the genetic algorithm.
+    The search stops after maxGenerations or once the best distance is at or
+    below targetDistance. Renders are compared to the target with the metric,
+    the band only applies to DTW.
+*/
+struct MatchSettings
+{
+    MatchAlgorithm algorithm = MatchAlgorithm::cmaes;
+    int            populationSize = 0;
+    int            maxGenerations = 100;
+    uint64         seed = 0;
+    double         targetDistance = 0.0;
+    int            numBest = 8;
+    DistanceMetric metric = DistanceMetric::euclidean;
+    int            band = -1;
+
+    // CMA-ES, the initial step size in the [0, 1) space of every parameter.
+    double         stepSize = 0.3;
+
+    // Genetic algorithm.
+    int            numElites = 2;
+    int            tournamentSize = 3;
+    double         crossoverRate = 0.9;
+    double         mutationRate = 0.05;
+    double         mutationStrength = 0.1;
+};
+
+//==============================================================================
+struct MatchCandidate
+{
+    PluginPatch patch;
+    double      distance = 0.0;
+};
+
+//==============================================================================
+/** Searches for the patch whose render is closest to a target sound, scored
+    natively by the distance of the render's MFCC frames to the target's. Every
+    generation is rendered as one batch on the engines of the pool.
+
+    Genes are values in [0, 1) mapped through the generator's constraints, so
+    a fixed parameter is left out of the search entirely.
+*/
+class SoundMatcher
+{
+public:
+    /** Called on the searching thread after every generation, returning
+        false stops the search.
+    */
+    typedef std::function<bool (int, double, const PluginPatch&)> ProgressCallback;
+
+    SoundMatcher (RenderPool&           pool,
+                  const RenderSettings& settings);
+
+    void setTarget (const MFCCFeatures& targetFeatures);
+
+    /** Analyses the audio on the first engine of the pool. */
+    bool setTargetAudio (const std::vector<float>& audio);
+
+    PatchGenerator& getGenerator();
+
+    /** The numBest best patches found, best first. */
+    std::vector<MatchCandidate> match (const MatchSettings&    settings,
+                                       const ProgressCallback& onGeneration = nullptr);
+
+    /** Safe to call from any thread, the search returns after the current
+        generation.
+    */
+    void stop();
+
+private:
+    typedef std::vector<std::vector<double>> Population;
+
+    std::vector<MatchCandidate> runCmaEs (const MatchSettings&    settings,
+                                          const ProgressCallback& onGeneration);
+
+    std::vector<MatchCandidate> runGenetic (const MatchSettings&    settings,
+                                            const ProgressCallback& onGeneration);
+
+    /** Renders the population and returns the distance of every member. */
+    std::vector<double> evaluate (const Population& population);
+
+    PluginPatch getPatch (const std::vector<double>& genes) const;
+
+    void addCandidates (const Population&          population,
+                        const std::vector<double>& distances);
+
+    bool shouldContinue (const MatchSettings&    settings,
+                         const ProgressCallback& onGeneration,
+                         const int               generation);
+
+    RenderPool&                 renderPool;
+    RenderSettings              renderSettings;
+    PatchGenerator              generator;
+    MFCCFeatures                target;
+    std::vector<size_t>         searchedPositions;
+    std::vector<MatchCandidate> best;
+    size_t                      numBest;
+    DistanceMetric              metric;
+    int                         band;
+    std::atomic<bool>           shouldStop;
+};
+
+#endif  // SOUNDMATCHER_H_INCLUDED
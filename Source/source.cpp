@@ -9,6 +9,16 @@
 */
 
 #include "PatchGenerator.h"
+#include "RenderPool.h"
+#include "Dataset.h"
+#include "JobRunner.h"
+#include "SensitivityAnalysis.h"
+#include "SoundMatcher.h"
+#include "FeatureDistance.h"
+#include "FeatureIndex.h"
+#include "FeatureClustering.h"
+#include "NoveltySearch.h"
+#include <list>
 #include <boost/python.hpp>
 
 // Could also easily be namespace crap.
@@ -104,6 +114,293 @@ namespace wrap
         return patch;
     }
 
+    //==========================================================================
+    std::vector<PluginPatch> listOfPatchesToPluginPatches (boost::python::list patches)
+    {
+        std::vector<PluginPatch> pluginPatches;
+        const int size = boost::python::len (patches);
+        pluginPatches.reserve (size);
+        for (int i = 0; i < size; ++i)
+        {
+            boost::python::list patch = boost::python::extract<boost::python::list> (patches[i]);
+            pluginPatches.push_back (listOfTuplesToPluginPatch (patch));
+        }
+        return pluginPatches;
+    }
+
+    //==========================================================================
+    // A memoryview made with PyMemoryView_FromBuffer has no owner, and views
+    // or numpy arrays made from it only hold on to its buffer. Views exported
+    // by this object hold on to it instead, and it holds the owner, so the
+    // memory lives as long as anything that can read it.
+    struct BufferExporter
+    {
+        PyObject_HEAD
+        PyObject*   owner;
+        const void* data;
+        const char* format;
+        Py_ssize_t  itemSize;
+        int         numDimensions;
+        Py_ssize_t  numBytes;
+        Py_ssize_t  shape[3];
+        Py_ssize_t  strides[3];
+    };
+
+    int bufferExporterGetBuffer (PyObject* object, Py_buffer* view, int flags)
+    {
+        if ((flags & PyBUF_WRITABLE) == PyBUF_WRITABLE)
+        {
+            PyErr_SetString (PyExc_BufferError, "The view is read-only.");
+            return -1;
+        }
+
+        BufferExporter* exporter = reinterpret_cast<BufferExporter*> (object);
+        Py_INCREF (object);
+        view->obj = object;
+        view->buf = const_cast<void*> (exporter->data);
+        view->len = exporter->numBytes;
+        view->itemsize = exporter->itemSize;
+        view->readonly = 1;
+        view->ndim = exporter->numDimensions;
+        view->format = (flags & PyBUF_FORMAT) == PyBUF_FORMAT ? const_cast<char*> (exporter->format) : nullptr;
+        view->shape = (flags & PyBUF_ND) == PyBUF_ND ? exporter->shape : nullptr;
+        view->strides = (flags & PyBUF_STRIDES) == PyBUF_STRIDES ? exporter->strides : nullptr;
+        view->suboffsets = nullptr;
+        view->internal = nullptr;
+        return 0;
+    }
+
+    void bufferExporterDealloc (PyObject* object)
+    {
+        Py_XDECREF (reinterpret_cast<BufferExporter*> (object)->owner);
+        Py_TYPE (object)->tp_free (object);
+    }
+
+    PyBufferProcs bufferExporterProcs = PyBufferProcs();
+    PyTypeObject  bufferExporterType = PyTypeObject();
+
+    // Called once when the module is imported. PyType_Ready takes the
+    // metatype from object, the reference keeps the static type from ever
+    // being freed.
+    void readyBufferExporterType()
+    {
+        Py_INCREF (reinterpret_cast<PyObject*> (&bufferExporterType));
+        bufferExporterType.tp_name = "librenderman.BufferExporter";
+        bufferExporterType.tp_basicsize = sizeof (BufferExporter);
+        bufferExporterType.tp_dealloc = bufferExporterDealloc;
+        // Python 2 puts the old buffer slots first, and only looks at
+        // bf_getbuffer with the new buffer flag set.
+        bufferExporterProcs.bf_getbuffer = bufferExporterGetBuffer;
+        bufferExporterType.tp_as_buffer = &bufferExporterProcs;
+       #if PY_MAJOR_VERSION < 3
+        bufferExporterType.tp_flags = Py_TPFLAGS_DEFAULT | Py_TPFLAGS_HAVE_NEWBUFFER;
+       #else
+        bufferExporterType.tp_flags = Py_TPFLAGS_DEFAULT;
+       #endif
+        bufferExporterType.tp_doc = "Keeps the memory behind a memoryview alive.";
+
+        if (PyType_Ready (&bufferExporterType) < 0)
+            boost::python::throw_error_already_set();
+    }
+
+    // Wraps C++ memory in a read-only memoryview without copying,
+    // numpy.asarray() turns it into an array of the right shape and dtype.
+    // The view, and anything made from it, keeps owner alive, which has to
+    // keep the memory alive. Up to three dimensions, C order, and the format
+    // is static.
+    boost::python::object memoryView (boost::python::object owner,
+                                      const void*           data,
+                                      const char*           format,
+                                      const Py_ssize_t      itemSize,
+                                      const int             numDimensions,
+                                      const Py_ssize_t*     shape)
+    {
+        jassert (numDimensions >= 1 && numDimensions <= 3);
+
+        BufferExporter* exporter = PyObject_New (BufferExporter, &bufferExporterType);
+        if (exporter == nullptr)
+            boost::python::throw_error_already_set();
+
+        exporter->owner = boost::python::incref (owner.ptr());
+        exporter->data = data;
+        exporter->format = format;
+        exporter->itemSize = itemSize;
+        exporter->numDimensions = numDimensions;
+
+        Py_ssize_t numBytes = itemSize;
+        for (int i = numDimensions - 1; i >= 0; --i)
+        {
+            exporter->shape[i] = shape[i];
+            exporter->strides[i] = numBytes;
+            numBytes *= shape[i];
+        }
+        exporter->numBytes = numBytes;
+
+        boost::python::handle<> exporterHandle (reinterpret_cast<PyObject*> (exporter));
+        return boost::python::object (boost::python::handle<> (PyMemoryView_FromObject (exporterHandle.get())));
+    }
+
+    //==========================================================================
+    // Lets other Python threads run, for instance to call stop(), while a
+    // long search renders. Nothing in its scope may touch a Python object
+    // without a ScopedGILAcquire.
+    class ScopedGILRelease
+    {
+    public:
+        ScopedGILRelease() : state (PyEval_SaveThread()) { }
+        ~ScopedGILRelease() { PyEval_RestoreThread (state); }
+
+    private:
+        PyThreadState* state;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedGILRelease)
+    };
+
+    // Takes the GIL back for a callback into Python, on any thread.
+    class ScopedGILAcquire
+    {
+    public:
+        ScopedGILAcquire() : state (PyGILState_Ensure()) { }
+        ~ScopedGILAcquire() { PyGILState_Release (state); }
+
+    private:
+        PyGILState_STATE state;
+
+        JUCE_DECLARE_NON_COPYABLE (ScopedGILAcquire)
+    };
+
+    //==========================================================================
+    // Results are move-only in C++, Python gets a shared handle instead. The
+    // storage goes back to the engine's pool once Python drops the last one.
+    class RenderResultWrapper
+    {
+    public:
+        RenderResultWrapper (RenderResult r) :
+            result (std::make_shared<RenderResult> (std::move (r)))
+        { }
+
+        boost::python::list wrapperGetAudioFrames()
+        {
+            if ((*result)->precision == AudioPrecision::doublePrecision)
+                return vectorToList ((*result)->processedMonoAudioPreview);
+            return vectorToList ((*result)->monoAudioFrames);
+        }
+
+        boost::python::list wrapperGetMFCCFrames()
+        {
+            return mfccFramesToListOfLists ((*result)->mfccFeatures);
+        }
+
+        boost::python::list wrapperGetRMSFrames()
+        {
+            return vectorToList ((*result)->rmsFrames);
+        }
+
+        double wrapperGetAppliedGain()
+        {
+            return (*result)->appliedGain;
+        }
+
+        unsigned long long wrapperGetFingerprint()
+        {
+            return (*result)->fingerprint;
+        }
+
+        boost::python::list wrapperGetAudioChannels()
+        {
+            boost::python::list list;
+            const AudioSampleBuffer& channelAudio = (*result)->channelAudio;
+            for (int i = 0; i < channelAudio.getNumChannels(); ++i)
+            {
+                const float* data = channelAudio.getReadPointer (i);
+                list.append (vectorToList (std::vector<float> (data, data + channelAudio.getNumSamples())));
+            }
+            return list;
+        }
+
+        std::shared_ptr<RenderResult> result;
+    };
+
+    //==========================================================================
+    // Engines share the cache, Python holds one more reference to it.
+    class DiskCacheWrapper
+    {
+    public:
+        DiskCacheWrapper (std::string directory, long long maxBytes) :
+            cache (std::make_shared<DiskRenderCache> (directory, int64 (maxBytes)))
+        { }
+
+        long long wrapperGetSizeInBytes()
+        {
+            return cache->getSizeInBytes();
+        }
+
+        unsigned long long wrapperGetNumHits()
+        {
+            return cache->getNumHits();
+        }
+
+        unsigned long long wrapperGetNumMisses()
+        {
+            return cache->getNumMisses();
+        }
+
+        void wrapperClear()
+        {
+            cache->clear();
+        }
+
+        std::shared_ptr<DiskRenderCache> cache;
+    };
+
+    //==========================================================================
+    class MemoryCacheWrapper
+    {
+    public:
+        MemoryCacheWrapper (int maxEntries, double resolution, bool storeAudio) :
+            cache (std::make_shared<MemoryRenderCache> (size_t (std::max (1, maxEntries)),
+                                                        resolution,
+                                                        storeAudio))
+        { }
+
+        void wrapperSetParameterResolution (int index, double resolution)
+        {
+            cache->setParameterResolution (index, resolution);
+        }
+
+        int wrapperGetNumEntries()
+        {
+            return int (cache->getNumEntries());
+        }
+
+        unsigned long long wrapperGetNumHits()
+        {
+            return cache->getNumHits();
+        }
+
+        unsigned long long wrapperGetNumMisses()
+        {
+            return cache->getNumMisses();
+        }
+
+        double wrapperGetHitRate()
+        {
+            return cache->getHitRate();
+        }
+
+        void wrapperResetCounters()
+        {
+            cache->resetCounters();
+        }
+
+        void wrapperClear()
+        {
+            cache->clear();
+        }
+
+        std::shared_ptr<MemoryRenderCache> cache;
+    };
+
     //==========================================================================
     class RenderEngineWrapper : public RenderEngine
     {
@@ -138,6 +435,15 @@ namespace wrap
                                       renderLength);
         }
 
+        RenderResultWrapper wrapperRenderPatchToResult (int    midiNote,
+                                                        int    midiVelocity,
+                                                        double noteLength,
+                                                        double renderLength)
+        {
+            wrapperRenderPatch (midiNote, midiVelocity, noteLength, renderLength);
+            return RenderResultWrapper (RenderEngine::takeResult());
+        }
+
         boost::python::list wrapperGetMFCCFrames()
         {
             return mfccFramesToListOfLists (RenderEngine::getMFCCFrames());
@@ -153,6 +459,62 @@ namespace wrap
             return RenderEngine::getPluginParametersDescription().toStdString();
         }
 
+        boost::python::list wrapperGetParameterInfo()
+        {
+            boost::python::list list;
+            for (const auto& info : RenderEngine::getParameterInfo())
+            {
+                boost::python::list valueTexts;
+                for (const auto& valueText : info.valueTexts)
+                    valueTexts.append (boost::python::make_tuple (valueText.first,
+                                                                  valueText.second.toStdString()));
+
+                boost::python::dict parameter;
+                parameter["index"] = info.index;
+                parameter["name"] = info.name.toStdString();
+                parameter["label"] = info.label.toStdString();
+                parameter["default"] = info.defaultValue;
+                parameter["num_steps"] = info.numSteps;
+                parameter["is_discrete"] = info.isDiscrete;
+                parameter["is_boolean"] = info.isBoolean;
+                parameter["steps_are_inferred"] = info.stepsAreInferred;
+                parameter["is_automatable"] = info.isAutomatable;
+                parameter["is_meta"] = info.isMeta;
+                parameter["value_texts"] = valueTexts;
+                list.append (parameter);
+            }
+            return list;
+        }
+
+        std::string wrapperGetProgramName (int index)
+        {
+            return RenderEngine::getProgramName (index).toStdString();
+        }
+
+        boost::python::object wrapperGetState()
+        {
+            const MemoryBlock state = RenderEngine::getState();
+            return boost::python::object (boost::python::handle<> (
+                PyBytes_FromStringAndSize (static_cast<const char*> (state.getData()), Py_ssize_t (state.getSize()))));
+        }
+
+        // Anything with the buffer protocol, usually the bytes get_state gave.
+        bool wrapperSetState (boost::python::object state)
+        {
+            Py_buffer view;
+            if (! PyObject_CheckBuffer (state.ptr())
+                 || PyObject_GetBuffer (state.ptr(), &view, PyBUF_C_CONTIGUOUS) != 0)
+            {
+                PyErr_Clear();
+                std::cout << "RenderEngine::set_state error: The state has to be bytes." << std::endl;
+                return false;
+            }
+
+            const MemoryBlock block (view.buf, size_t (view.len));
+            PyBuffer_Release (&view);
+            return RenderEngine::setState (block);
+        }
+
         boost::python::list wrapperGetAudioFrames()
         {
             return vectorToList (RenderEngine::getAudioFrames());
@@ -162,49 +524,1789 @@ namespace wrap
         {
             return vectorToList (RenderEngine::getRMSFrames());
         }
+
+        void wrapperSetNormalisation (NormalisationMode mode,
+                                      double            target,
+                                      double            peakCeiling)
+        {
+            RenderEngine::setNormalisation (mode, target, peakCeiling);
+        }
+
+        bool wrapperWriteToFile (std::string     path,
+                                 AudioFileFormat format,
+                                 int             flacCompression)
+        {
+            return RenderEngine::writeToFile (path, format, flacCompression);
+        }
+
+        boost::python::list wrapperGetAudioChannels()
+        {
+            boost::python::list list;
+            for (int i = 0; i < RenderEngine::getNumAudioChannels(); ++i)
+                list.append (vectorToList (RenderEngine::getChannelAudioFrames (i)));
+            return list;
+        }
+
+        void wrapperSetDiskCache (DiskCacheWrapper& cache)
+        {
+            RenderEngine::setDiskCache (cache.cache);
+        }
+
+        void wrapperRemoveDiskCache()
+        {
+            RenderEngine::setDiskCache (nullptr);
+        }
+
+        void wrapperSetMemoryCache (MemoryCacheWrapper& cache)
+        {
+            RenderEngine::setMemoryCache (cache.cache);
+        }
+
+        void wrapperRemoveMemoryCache()
+        {
+            RenderEngine::setMemoryCache (nullptr);
+        }
+
+        std::string wrapperGetRenderKey (int    midiNote,
+                                         int    midiVelocity,
+                                         double noteLength,
+                                         double renderLength)
+        {
+            return RenderEngine::getRenderKey (uint8 (jlimit (0, 255, midiNote)),
+                                               uint8 (jlimit (0, 255, midiVelocity)),
+                                               noteLength,
+                                               renderLength).toStdString();
+        }
     };
 
     //==========================================================================
-    class PatchGeneratorWrapper : public PatchGenerator
+    class AudioWriterWrapper : public BackgroundAudioWriter
     {
     public:
-        PatchGeneratorWrapper (RenderEngine& engine) :
-            PatchGenerator (engine)
+        AudioWriterWrapper (int maxQueuedRenders, AudioFileFormat format, int flacCompression) :
+            BackgroundAudioWriter (size_t (std::max (1, maxQueuedRenders)), format, flacCompression)
         { }
 
-        boost::python::tuple wrapperGetRandomParameter (int index)
+        void wrapperWrite (RenderResultWrapper& result, std::string path)
         {
-            return parameterToTuple (PatchGenerator::getRandomParameter (index));
+            BackgroundAudioWriter::push (result.result, path);
         }
+    };
 
-        boost::python::list wrapperGetRandomPatch()
+    //==========================================================================
+    // Encodes a list of results into the list of paths in parallel and gives
+    // back a list of the byte counts, -1 for any file that failed.
+    boost::python::list wrapperWriteAudioFiles (boost::python::list results,
+                                                boost::python::list paths,
+                                                AudioFileFormat     format,
+                                                int                 flacCompression,
+                                                int                 numThreads)
+    {
+        const int size = boost::python::len (results);
+        std::vector<const RenderStorage*> renders;
+        std::vector<std::string> filePaths;
+        renders.reserve (size);
+        filePaths.reserve (size);
+        for (int i = 0; i < size; ++i)
         {
-            return pluginPatchToListOfTuples (PatchGenerator::getRandomPatch());
+            RenderResultWrapper& result = boost::python::extract<RenderResultWrapper&> (results[i]);
+            renders.push_back (result.result->isValid() ? &**result.result : nullptr);
+        }
+        for (int i = 0; i < boost::python::len (paths); ++i)
+            filePaths.push_back (boost::python::extract<std::string> (paths[i]));
+
+        return vectorToList (writeAudioFiles (renders, filePaths, format, flacCompression, numThreads));
+    }
+
+    //==========================================================================
+    // The values come back as a memoryview into the matrix, which it keeps
+    // alive.
+    class PatchMatrixWrapper
+    {
+    public:
+        // The Python object of the matrix, which its views hold on to.
+        typedef boost::python::back_reference<PatchMatrixWrapper&> SelfReference;
+
+        PatchMatrixWrapper (PatchMatrix&& patchMatrix) :
+            matrix (std::move (patchMatrix))
+        { }
+
+        static boost::python::object wrapperGetValues (SelfReference self)
+        {
+            const PatchMatrix& matrix = self.get().matrix;
+            const Py_ssize_t shape[] = { Py_ssize_t (matrix.getNumPatches()), Py_ssize_t (matrix.getNumParameters()) };
+            return memoryView (self.source(), matrix.values.data(), "f", sizeof (float), 2, shape);
+        }
+
+        int wrapperGetNumPatches()
+        {
+            return int (matrix.getNumPatches());
+        }
+
+        int wrapperGetNumParameters()
+        {
+            return int (matrix.getNumParameters());
+        }
+
+        boost::python::list wrapperGetParameterIndices()
+        {
+            return vectorToList (matrix.parameterIndices);
+        }
+
+        boost::python::list wrapperGetPatches()
+        {
+            boost::python::list list;
+            for (size_t i = 0; i < matrix.getNumPatches(); ++i)
+                list.append (pluginPatchToListOfTuples (matrix.getPatch (i)));
+            return list;
         }
+
+        PatchMatrix matrix;
     };
-}
 
-//==============================================================================
-BOOST_PYTHON_MODULE(librenderman)
-{
-    using namespace boost::python;
-    using namespace wrap;
+    // Batches are a list of patches or a PatchMatrix, which skips the
+    // conversion from Python.
+    std::vector<PluginPatch> objectToPluginPatches (boost::python::object patches)
+    {
+        boost::python::extract<PatchMatrixWrapper&> matrix (patches);
+        if (matrix.check())
+            return matrix().matrix.getPatches();
+        return listOfPatchesToPluginPatches (boost::python::extract<boost::python::list> (patches));
+    }
 
-    class_<RenderEngineWrapper>("RenderEngine", init<int, int, int>())
-    .def("load_plugin", &RenderEngineWrapper::loadPlugin)
-    .def("set_patch", &RenderEngineWrapper::wrapperSetPatch)
-    .def("get_patch", &RenderEngineWrapper::wrapperGetPatch)
-    .def("render_patch", &RenderEngineWrapper::wrapperRenderPatch)
-    .def("get_mfcc_frames", &RenderEngineWrapper::wrapperGetMFCCFrames)
-    .def("get_plugin_parameter_size", &RenderEngineWrapper::wrapperGetPluginParameterSize)
-    .def("get_plugin_parameters_description", &RenderEngineWrapper::wrapperGetPluginParametersDescription)
-    .def("override_plugin_parameter", &RenderEngineWrapper::overridePluginParameter)
-    .def("remove_overriden_plugin_parameter", &RenderEngineWrapper::removeOverridenParameter)
-    .def("get_audio_frames", &RenderEngineWrapper::wrapperGetAudioFrames)
-    .def("get_rms_frames", &RenderEngineWrapper::wrapperGetRMSFrames)
-    .def("write_to_wav", &RenderEngineWrapper::writeToWav);
+    //==========================================================================
+    // The audio comes back as a memoryview into the grid, which it keeps
+    // alive.
+    class RenderGridWrapper
+    {
+    public:
+        // The Python object of the grid, which its views hold on to.
+        typedef boost::python::back_reference<RenderGridWrapper&> SelfReference;
 
-    class_<PatchGeneratorWrapper>("PatchGenerator", init<RenderEngineWrapper&>())
-    .def("get_random_parameter", &PatchGeneratorWrapper::wrapperGetRandomParameter)
-    .def("get_random_patch", &PatchGeneratorWrapper::wrapperGetRandomPatch);
+        RenderGridWrapper (RenderGrid&& renderGrid) :
+            grid (std::move (renderGrid))
+        { }
+
+        static boost::python::object wrapperGetAudio (SelfReference self)
+        {
+            const RenderGrid& grid = self.get().grid;
+            const Py_ssize_t shape[] = { Py_ssize_t (grid.notes.size()), Py_ssize_t (grid.velocities.size()),
+                                         Py_ssize_t (grid.numSamples) };
+            return memoryView (self.source(), grid.audio.data(), "f", sizeof (float), 3, shape);
+        }
+
+        boost::python::list wrapperGetNotes()
+        {
+            return vectorToList (std::vector<int> (grid.notes.begin(), grid.notes.end()));
+        }
+
+        boost::python::list wrapperGetVelocities()
+        {
+            return vectorToList (std::vector<int> (grid.velocities.begin(), grid.velocities.end()));
+        }
+
+        int wrapperGetNumSamples()
+        {
+            return int (grid.numSamples);
+        }
+
+    private:
+        RenderGrid grid;
+    };
+
+    //==========================================================================
+    // Writers and Python share the filter, like the caches.
+    class DuplicateFilterWrapper
+    {
+    public:
+        DuplicateFilterWrapper (int maxDistance) :
+            filter (std::make_shared<DuplicateFilter> (maxDistance))
+        { }
+
+        bool wrapperInsertIfUnique (unsigned long long fingerprint)
+        {
+            return filter->insertIfUnique (uint64 (fingerprint));
+        }
+
+        bool wrapperContainsNearDuplicate (unsigned long long fingerprint)
+        {
+            return filter->containsNearDuplicate (uint64 (fingerprint));
+        }
+
+        void wrapperClear()
+        {
+            filter->clear();
+        }
+
+        size_t wrapperSize()
+        {
+            return filter->size();
+        }
+
+        int wrapperGetMaxDistance()
+        {
+            return filter->getMaxDistance();
+        }
+
+        std::shared_ptr<DuplicateFilter> filter;
+    };
+
+    //==========================================================================
+    class DatasetWriterWrapper : public DatasetWriter
+    {
+    public:
+        DatasetWriterWrapper (std::string directory, std::string prefix, int recordsPerShard) :
+            DatasetWriter (directory, prefix, size_t (std::max (1, recordsPerShard)))
+        { }
+
+        bool wrapperAdd (unsigned long long   recordId,
+                         boost::python::list  patch,
+                         RenderResultWrapper& result)
+        {
+            return DatasetWriter::add (uint64 (recordId), listOfTuplesToPluginPatch (patch), result.result);
+        }
+
+        void wrapperSetDuplicateFilter (DuplicateFilterWrapper& filter)
+        {
+            DatasetWriter::setDuplicateFilter (filter.filter);
+        }
+
+        void wrapperRemoveDuplicateFilter()
+        {
+            DatasetWriter::setDuplicateFilter (nullptr);
+        }
+    };
+
+    //==========================================================================
+    class RenderPoolWrapper : public RenderPool
+    {
+    public:
+        RenderPoolWrapper (int numEngines, int sr, int bs, int ffts) :
+            RenderPool (numEngines, sr, bs, ffts)
+        { }
+
+        void wrapperSetNormalisation (NormalisationMode mode,
+                                      double            target,
+                                      double            peakCeiling)
+        {
+            RenderPool::forEachEngine ([&] (RenderEngine& engine)
+            {
+                engine.setNormalisation (mode, target, peakCeiling);
+            });
+        }
+
+        void wrapperSetAudioPrecision (AudioPrecision precision)
+        {
+            RenderPool::forEachEngine ([&] (RenderEngine& engine)
+            {
+                engine.setAudioPrecision (precision);
+            });
+        }
+
+        void wrapperSetDiskCache (DiskCacheWrapper& cache)
+        {
+            RenderPool::forEachEngine ([&] (RenderEngine& engine)
+            {
+                engine.setDiskCache (cache.cache);
+            });
+        }
+
+        void wrapperSetMemoryCache (MemoryCacheWrapper& cache)
+        {
+            RenderPool::forEachEngine ([&] (RenderEngine& engine)
+            {
+                engine.setMemoryCache (cache.cache);
+            });
+        }
+
+        boost::python::list wrapperRenderPatches (boost::python::object patches,
+                                                  int                   midiNote,
+                                                  int                   midiVelocity,
+                                                  double                noteLength,
+                                                  double                renderLength)
+        {
+            const RenderSettings settings = makeSettings (midiNote, midiVelocity,
+                                                          noteLength, renderLength);
+            std::vector<RenderResult> results =
+                RenderPool::renderPatches (objectToPluginPatches (patches), settings);
+
+            boost::python::list list;
+            for (auto& result : results)
+                list.append (RenderResultWrapper (std::move (result)));
+            return list;
+        }
+
+        // Renders straight into a dataset, record i gets the id firstRecordId + i.
+        void wrapperRenderToDataset (boost::python::object patches,
+                                     int                   midiNote,
+                                     int                   midiVelocity,
+                                     double                noteLength,
+                                     double                renderLength,
+                                     DatasetWriterWrapper& writer,
+                                     unsigned long long    firstRecordId)
+        {
+            const RenderSettings settings = makeSettings (midiNote, midiVelocity,
+                                                          noteLength, renderLength);
+            const std::vector<PluginPatch> pluginPatches = objectToPluginPatches (patches);
+            RenderPool::renderPatches (pluginPatches, settings, [&] (size_t index, RenderResult&& result)
+            {
+                writer.add (uint64 (firstRecordId + index), pluginPatches[index], std::move (result));
+            });
+        }
+
+        RenderGridWrapper* wrapperRenderGrid (boost::python::list patch,
+                                              boost::python::list notes,
+                                              boost::python::list velocities,
+                                              double              noteLength,
+                                              double              renderLength)
+        {
+            return new RenderGridWrapper (RenderPool::renderGrid (listOfTuplesToPluginPatch (patch),
+                                                                  listToMidiBytes (notes),
+                                                                  listToMidiBytes (velocities),
+                                                                  noteLength, renderLength));
+        }
+
+        bool wrapperLoadPresetFile (std::string path)
+        {
+            return RenderPool::loadPresetFile (path);
+        }
+
+        // Pairs of patch and RenderResult, one per program in program order.
+        boost::python::list wrapperRenderPrograms (int    midiNote,
+                                                   int    midiVelocity,
+                                                   double noteLength,
+                                                   double renderLength)
+        {
+            const RenderSettings settings = makeSettings (midiNote, midiVelocity,
+                                                          noteLength, renderLength);
+            return presetsToList ([&] (const PresetCallback& callback)
+            {
+                RenderPool::renderPrograms (settings, callback);
+            });
+        }
+
+        // Program i gets the record id firstRecordId + i.
+        void wrapperRenderProgramsToDataset (int                   midiNote,
+                                             int                   midiVelocity,
+                                             double                noteLength,
+                                             double                renderLength,
+                                             DatasetWriterWrapper& writer,
+                                             unsigned long long    firstRecordId)
+        {
+            const RenderSettings settings = makeSettings (midiNote, midiVelocity,
+                                                          noteLength, renderLength);
+            RenderPool::renderPrograms (settings, [&] (size_t index, const PluginPatch& patch, RenderResult&& result)
+            {
+                writer.add (uint64 (firstRecordId + index), patch, std::move (result));
+            });
+        }
+
+        boost::python::list wrapperRenderPresetFiles (boost::python::list paths,
+                                                      int                 midiNote,
+                                                      int                 midiVelocity,
+                                                      double              noteLength,
+                                                      double              renderLength)
+        {
+            const RenderSettings settings = makeSettings (midiNote, midiVelocity,
+                                                          noteLength, renderLength);
+            const std::vector<std::string> files = listToPaths (paths);
+            return presetsToList ([&] (const PresetCallback& callback)
+            {
+                RenderPool::renderPresetFiles (files, settings, callback);
+            });
+        }
+
+        // File i gets the record id firstRecordId + i, files that don't
+        // load are left out.
+        void wrapperRenderPresetFilesToDataset (boost::python::list   paths,
+                                                int                   midiNote,
+                                                int                   midiVelocity,
+                                                double                noteLength,
+                                                double                renderLength,
+                                                DatasetWriterWrapper& writer,
+                                                unsigned long long    firstRecordId)
+        {
+            const RenderSettings settings = makeSettings (midiNote, midiVelocity,
+                                                          noteLength, renderLength);
+            RenderPool::renderPresetFiles (listToPaths (paths), settings,
+                                           [&] (size_t index, const PluginPatch& patch, RenderResult&& result)
+                                           {
+                                               writer.add (uint64 (firstRecordId + index), patch, std::move (result));
+                                           });
+        }
+
+    private:
+        static std::vector<uint8> listToMidiBytes (boost::python::list values)
+        {
+            std::vector<uint8> bytes;
+            for (int i = 0; i < boost::python::len (values); ++i)
+                bytes.push_back (uint8 (jlimit (0, 127, int (boost::python::extract<int> (values[i])))));
+            return bytes;
+        }
+
+        static std::vector<std::string> listToPaths (boost::python::list paths)
+        {
+            std::vector<std::string> files;
+            for (int i = 0; i < boost::python::len (paths); ++i)
+                files.push_back (boost::python::extract<std::string> (paths[i]));
+            return files;
+        }
+
+        static boost::python::list presetsToList (const std::function<void (const PresetCallback&)>& render)
+        {
+            std::vector<PluginPatch> patches;
+            std::vector<RenderResult> results;
+            std::mutex lock;
+
+            render ([&] (size_t index, const PluginPatch& patch, RenderResult&& result)
+            {
+                std::lock_guard<std::mutex> guard (lock);
+                if (index >= patches.size())
+                {
+                    patches.resize (index + 1);
+                    results.resize (index + 1);
+                }
+                patches[index] = patch;
+                results[index] = std::move (result);
+            });
+
+            boost::python::list list;
+            for (size_t i = 0; i < patches.size(); ++i)
+                list.append (boost::python::make_tuple (pluginPatchToListOfTuples (patches[i]),
+                                                        RenderResultWrapper (std::move (results[i]))));
+            return list;
+        }
+
+        static RenderSettings makeSettings (int    midiNote,
+                                            int    midiVelocity,
+                                            double noteLength,
+                                            double renderLength)
+        {
+            RenderSettings settings;
+            settings.midiNote = uint8 (jlimit (0, 255, midiNote));
+            settings.midiVelocity = uint8 (jlimit (0, 255, midiVelocity));
+            settings.noteLength = noteLength;
+            settings.renderLength = renderLength;
+            return settings;
+        }
+    };
+
+    //==========================================================================
+    // Hands out the mapped columns as memoryviews. They point into the shards,
+    // and every view keeps the reader alive so the shards stay mapped.
+    class DatasetReaderWrapper : public DatasetReader
+    {
+    public:
+        // The Python object of the reader, which its views hold on to.
+        typedef boost::python::back_reference<DatasetReaderWrapper&> SelfReference;
+
+        DatasetReaderWrapper (std::string directory, std::string prefix) :
+            DatasetReader (directory, prefix)
+        {
+            shapes.resize (DatasetReader::getNumShards());
+            for (size_t i = 0; i < shapes.size(); ++i)
+            {
+                const DatasetShardHeader& header = DatasetReader::getHeader (i);
+                const Py_ssize_t numRecords = Py_ssize_t (header.numRecords);
+                std::array<ColumnShape, numColumns>& shard = shapes[i];
+                shard[recordIdsColumn]        = {{ numRecords, 0, 0 }};
+                shard[parameterIndicesColumn] = {{ Py_ssize_t (header.numParameters), 0, 0 }};
+                shard[patchesColumn]          = {{ numRecords, Py_ssize_t (header.numParameters), 0 }};
+                shard[audioColumn]            = {{ numRecords, Py_ssize_t (header.numSamples), 0 }};
+                shard[mfccColumn]             = {{ numRecords, Py_ssize_t (header.numMfccFrames),
+                                                   Py_ssize_t (header.numMfccCoefficients) }};
+                shard[rmsColumn]              = {{ numRecords, Py_ssize_t (header.numRmsFrames), 0 }};
+            }
+        }
+
+        int wrapperGetNumShards()
+        {
+            return int (DatasetReader::getNumShards());
+        }
+
+        unsigned long long wrapperGetNumRecords()
+        {
+            return DatasetReader::getNumRecords();
+        }
+
+        unsigned long long wrapperGetShardNumRecords (int shard)
+        {
+            return checkShard (shard) ? DatasetReader::getHeader (size_t (shard)).numRecords : 0;
+        }
+
+        std::string wrapperGetShardPath (int shard)
+        {
+            if (! checkShard (shard))
+                return std::string();
+            return DatasetReader::getShardFile (size_t (shard)).getFullPathName().toStdString();
+        }
+
+        static boost::python::object wrapperGetRecordIds (SelfReference self, int shard)
+        {
+            return view (self, shard, recordIdsColumn, &DatasetReader::getRecordIds, "Q", 1);
+        }
+
+        static boost::python::object wrapperGetParameterIndices (SelfReference self, int shard)
+        {
+            return view (self, shard, parameterIndicesColumn, &DatasetReader::getParameterIndices, "I", 1);
+        }
+
+        static boost::python::object wrapperGetPatches (SelfReference self, int shard)
+        {
+            return view (self, shard, patchesColumn, &DatasetReader::getPatches, "f", 2);
+        }
+
+        static boost::python::object wrapperGetAudio (SelfReference self, int shard)
+        {
+            return view (self, shard, audioColumn, &DatasetReader::getAudio, "f", 2);
+        }
+
+        static boost::python::object wrapperGetMFCC (SelfReference self, int shard)
+        {
+            return view (self, shard, mfccColumn, &DatasetReader::getMfcc, "f", 3);
+        }
+
+        static boost::python::object wrapperGetRMS (SelfReference self, int shard)
+        {
+            return view (self, shard, rmsColumn, &DatasetReader::getRms, "f", 2);
+        }
+
+    private:
+        enum Column
+        {
+            recordIdsColumn,
+            parameterIndicesColumn,
+            patchesColumn,
+            audioColumn,
+            mfccColumn,
+            rmsColumn,
+            numColumns
+        };
+
+        typedef std::array<Py_ssize_t, 3> ColumnShape;
+
+        bool checkShard (int shard) const
+        {
+            if (shard >= 0 && size_t (shard) < DatasetReader::getNumShards())
+                return true;
+
+            std::cout << "DatasetReader error: There is no shard " << shard << "." << std::endl;
+            return false;
+        }
+
+        // Reads a column of the reader self refers to, the view keeps self alive.
+        template <class T>
+        static boost::python::object view (SelfReference self,
+                                           int           shard,
+                                           Column        column,
+                                           const T*      (DatasetReader::*getColumn) (const size_t) const,
+                                           const char*   format,
+                                           int           numDimensions)
+        {
+            DatasetReaderWrapper& reader = self.get();
+            if (! reader.checkShard (shard))
+                return boost::python::object();
+
+            return memoryView (self.source(), (reader.*getColumn) (size_t (shard)), format, sizeof (T),
+                               numDimensions, reader.shapes[size_t (shard)][column].data());
+        }
+
+        std::vector<std::array<ColumnShape, numColumns>> shapes;
+    };
+
+    //==========================================================================
+    boost::python::list samplerGenerate (const PatchSampler& sampler,
+                                         unsigned long long  firstIndex,
+                                         int                 numPatches)
+    {
+        const size_t numParameters = size_t (sampler.getNumParameters());
+        const std::vector<float> values = sampler.generate (firstIndex, size_t (std::max (0, numPatches)));
+
+        boost::python::list list;
+        for (size_t i = 0; i + numParameters <= values.size() && numParameters > 0; i += numParameters)
+            list.append (vectorToList (std::vector<float> (values.begin() + i,
+                                                           values.begin() + i + numParameters)));
+        return list;
+    }
+
+    //==========================================================================
+    // Fills a writable float32 buffer, like a C contiguous numpy array of
+    // shape [N, P], in place and returns N.
+    int samplerGenerateInto (const PatchSampler&   sampler,
+                             unsigned long long    firstIndex,
+                             boost::python::object buffer)
+    {
+        Py_buffer view;
+        if (PyObject_GetBuffer (buffer.ptr(), &view, PyBUF_WRITABLE | PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0)
+        {
+            PyErr_Clear();
+            std::cout << "PatchSampler::generate_into error: " <<
+                         "Expected a writable, contiguous buffer." << std::endl;
+            return 0;
+        }
+
+        const String format (view.format != nullptr ? view.format : "B");
+        const Py_ssize_t rowSize = Py_ssize_t (sampler.getNumParameters()) * Py_ssize_t (sizeof (float));
+        int numPatches = 0;
+
+        if (view.itemsize != Py_ssize_t (sizeof (float)) || format.getLastCharacter() != 'f')
+            std::cout << "PatchSampler::generate_into error: " <<
+                         "The buffer has to hold float32 values." << std::endl;
+        else if (rowSize == 0 || view.len % rowSize != 0)
+            std::cout << "PatchSampler::generate_into error: " <<
+                         "The buffer size isn't a whole number of patches." << std::endl;
+        else
+        {
+            numPatches = int (view.len / rowSize);
+            sampler.generate (firstIndex, size_t (numPatches), static_cast<float*> (view.buf));
+        }
+
+        PyBuffer_Release (&view);
+        return numPatches;
+    }
+
+    //==========================================================================
+    // Feature sequences from Python: RenderResults and float64 buffers of
+    // shape [frames, coefficients] are read in place, float32 buffers and
+    // lists of lists are converted first.
+    class PythonFeatureSequences
+    {
+    public:
+        PythonFeatureSequences (boost::python::object items, const char* caller)
+        {
+            for (int i = 0; i < boost::python::len (items); ++i)
+            {
+                if (! add (items[i]))
+                {
+                    std::cout << caller << " error: Item " << i << " isn't a RenderResult, " <<
+                                 "a 2D float32 or float64 buffer or a list of lists." << std::endl;
+                    isValid = false;
+                    return;
+                }
+            }
+        }
+
+        ~PythonFeatureSequences()
+        {
+            for (auto& view : views)
+                PyBuffer_Release (&view);
+        }
+
+        std::vector<FeatureSequence<double>> sequences;
+        bool                                 isValid = true;
+
+    private:
+        bool add (boost::python::object item)
+        {
+            boost::python::extract<RenderResultWrapper&> result (item);
+            if (result.check())
+            {
+                sequences.push_back (FeatureDistance::fromMfcc ((*result().result)->mfccFeatures));
+                return true;
+            }
+
+            if (PyObject_CheckBuffer (item.ptr()))
+            {
+                views.emplace_back();
+                Py_buffer& view = views.back();
+                if (PyObject_GetBuffer (item.ptr(), &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) != 0)
+                {
+                    PyErr_Clear();
+                    views.pop_back();
+                    return false;
+                }
+
+                const char type = view.format != nullptr ? String (view.format).getLastCharacter() : 'B';
+                const size_t numFrames = view.ndim == 2 ? size_t (view.shape[0]) : 0;
+                const size_t numCoefficients = view.ndim == 2 ? size_t (view.shape[1]) : 0;
+
+                if (view.ndim != 2 || (type != 'd' && type != 'f'))
+                    return false;
+
+                if (type == 'd')
+                {
+                    sequences.push_back (FeatureSequence<double> (static_cast<const double*> (view.buf),
+                                                                  numFrames, numCoefficients));
+                    return true;
+                }
+
+                const float* values = static_cast<const float*> (view.buf);
+                converted.push_back (std::vector<double> (values, values + numFrames * numCoefficients));
+                sequences.push_back (FeatureSequence<double> (converted.back().data(), numFrames, numCoefficients));
+                return true;
+            }
+
+            boost::python::extract<boost::python::list> frames (item);
+            if (! frames.check())
+                return false;
+
+            const boost::python::list list = frames();
+            const size_t numFrames = size_t (boost::python::len (list));
+            const size_t numCoefficients = numFrames > 0 ? size_t (boost::python::len (list[0])) : 0;
+            converted.push_back (std::vector<double> (numFrames * numCoefficients, 0.0));
+            std::vector<double>& values = converted.back();
+
+            for (size_t frame = 0; frame < numFrames; ++frame)
+            {
+                const boost::python::object row = list[frame];
+                for (size_t i = 0; i < std::min (numCoefficients, size_t (boost::python::len (row))); ++i)
+                    values[frame * numCoefficients + i] = boost::python::extract<double> (row[i]);
+            }
+
+            sequences.push_back (FeatureSequence<double> (values.data(), numFrames, numCoefficients));
+            return true;
+        }
+
+        std::list<Py_buffer>           views;
+        std::list<std::vector<double>> converted;
+    };
+
+    double featureDistance (boost::python::object a,
+                            boost::python::object b,
+                            DistanceMetric        metric,
+                            int                   band)
+    {
+        PythonFeatureSequences sequences (boost::python::make_tuple (a, b), "feature_distance");
+        if (! sequences.isValid)
+            return 0.0;
+        return FeatureDistance::distance (sequences.sequences[0], sequences.sequences[1], metric, band);
+    }
+
+    boost::python::list featureDistances (boost::python::object target,
+                                          boost::python::list   candidates,
+                                          DistanceMetric        metric,
+                                          int                   band,
+                                          int                   numThreads)
+    {
+        PythonFeatureSequences targets (boost::python::make_tuple (target), "feature_distances");
+        PythonFeatureSequences sequences (candidates, "feature_distances");
+        if (! targets.isValid || ! sequences.isValid)
+            return boost::python::list();
+
+        return vectorToList (FeatureDistance::distances (targets.sequences[0], sequences.sequences,
+                                                         metric, band, numThreads));
+    }
+
+    boost::python::list featureDistanceMatrix (boost::python::list rows,
+                                               boost::python::list columns,
+                                               DistanceMetric      metric,
+                                               int                 band,
+                                               int                 numThreads)
+    {
+        boost::python::list list;
+        PythonFeatureSequences rowSequences (rows, "feature_distance_matrix");
+        PythonFeatureSequences columnSequences (columns, "feature_distance_matrix");
+        if (! rowSequences.isValid || ! columnSequences.isValid)
+            return list;
+
+        const std::vector<double> matrix = FeatureDistance::distanceMatrix (rowSequences.sequences,
+                                                                            columnSequences.sequences,
+                                                                            metric, band, numThreads);
+        const size_t numColumns = columnSequences.sequences.size();
+        for (size_t row = 0; row < rowSequences.sequences.size(); ++row)
+            list.append (vectorToList (std::vector<double> (matrix.begin() + long (row * numColumns),
+                                                            matrix.begin() + long ((row + 1) * numColumns))));
+        return list;
+    }
+
+    boost::python::list featureSummary (boost::python::object sequence)
+    {
+        PythonFeatureSequences sequences (boost::python::make_tuple (sequence), "feature_summary");
+        if (! sequences.isValid)
+            return boost::python::list();
+        return vectorToList (FeatureDistance::getSummary (sequences.sequences[0]));
+    }
+
+    unsigned long long featureFingerprint (boost::python::object sequence)
+    {
+        PythonFeatureSequences sequences (boost::python::make_tuple (sequence), "feature_fingerprint");
+        if (! sequences.isValid)
+            return 0;
+        return Fingerprint::compute (sequences.sequences[0]);
+    }
+
+    int fingerprintDistance (unsigned long long a, unsigned long long b)
+    {
+        return Fingerprint::getDistance (uint64 (a), uint64 (b));
+    }
+
+    //==========================================================================
+    // Queries and vectors are lists of floats, or RenderResults which stand
+    // for their MFCC summary. Batches are a 2D buffer or a list of lists.
+    class FeatureIndexWrapper
+    {
+    public:
+        FeatureIndexWrapper (int dimensions, int maxNeighbours, int efConstruction, unsigned long long seed) :
+            index (new FeatureIndex (size_t (jmax (1, dimensions)), maxNeighbours, efConstruction, seed))
+        { }
+
+        bool wrapperAdd (unsigned long long id, boost::python::object vector)
+        {
+            std::vector<float> values;
+            return toVector (vector, values, "FeatureIndex::add") && index->add (id, values.data());
+        }
+
+        size_t wrapperAddBatch (boost::python::list ids, boost::python::object vectors, int numThreads)
+        {
+            std::vector<uint64> recordIds;
+            std::vector<float> values;
+            if (! toVectors (vectors, values, "FeatureIndex::add_batch"))
+                return 0;
+
+            for (int i = 0; i < boost::python::len (ids); ++i)
+                recordIds.push_back (boost::python::extract<unsigned long long> (ids[i]));
+
+            if (recordIds.size() * index->getDimensions() != values.size())
+            {
+                std::cout << "FeatureIndex::add_batch error: There are " << recordIds.size() <<
+                             " ids for " << values.size() / index->getDimensions() << " vectors." << std::endl;
+                return 0;
+            }
+
+            return index->addBatch (recordIds.data(), values.data(), recordIds.size(), numThreads);
+        }
+
+        size_t wrapperAddShards (const DatasetReaderWrapper& reader, int numThreads)
+        {
+            return index->addShards (reader, numThreads);
+        }
+
+        size_t wrapperAddRenders (RenderPoolWrapper&    pool,
+                                  boost::python::list   patches,
+                                  const RenderSettings& settings,
+                                  unsigned long long    firstId)
+        {
+            return index->addRenders (pool, listOfPatchesToPluginPatches (patches), settings, firstId);
+        }
+
+        boost::python::list wrapperSearch (boost::python::object query, int k, int ef)
+        {
+            std::vector<float> values;
+            if (! toVector (query, values, "FeatureIndex::search"))
+                return boost::python::list();
+
+            return neighboursToList (index->search (values.data(), size_t (jmax (0, k)), ef));
+        }
+
+        boost::python::list wrapperSearchBatch (boost::python::object queries, int k, int ef, int numThreads)
+        {
+            boost::python::list list;
+            std::vector<float> values;
+            if (! toVectors (queries, values, "FeatureIndex::search_batch"))
+                return list;
+
+            const size_t numQueries = values.size() / index->getDimensions();
+            for (const auto& neighbours : index->searchBatch (values.data(), numQueries,
+                                                              size_t (jmax (0, k)), ef, numThreads))
+                list.append (neighboursToList (neighbours));
+            return list;
+        }
+
+        size_t wrapperSize()
+        {
+            return index->size();
+        }
+
+        size_t wrapperGetDimensions()
+        {
+            return index->getDimensions();
+        }
+
+        bool wrapperIsReadOnly()
+        {
+            return index->isReadOnly();
+        }
+
+        bool wrapperSave (const std::string& path)
+        {
+            return index->save (path);
+        }
+
+        // Replaces the index with the one in the file, keeping this one if
+        // the file can't be read.
+        bool wrapperLoad (const std::string& path, bool memoryMap)
+        {
+            std::unique_ptr<FeatureIndex> loaded = FeatureIndex::load (path, memoryMap);
+            if (loaded == nullptr)
+                return false;
+
+            index = std::move (loaded);
+            return true;
+        }
+
+    private:
+        bool toVector (boost::python::object item, std::vector<float>& values, const char* caller)
+        {
+            boost::python::extract<RenderResultWrapper&> result (item);
+            if (result.check())
+            {
+                values = FeatureDistance::getSummary (FeatureDistance::fromMfcc ((*result().result)->mfccFeatures));
+            }
+            else
+            {
+                for (int i = 0; i < boost::python::len (item); ++i)
+                    values.push_back (boost::python::extract<float> (item[i]));
+            }
+
+            if (values.size() != index->getDimensions())
+            {
+                std::cout << caller << " error: Expected " << index->getDimensions() <<
+                             " values, got " << values.size() << "." << std::endl;
+                return false;
+            }
+            return true;
+        }
+
+        bool toVectors (boost::python::object items, std::vector<float>& values, const char* caller)
+        {
+            PythonFeatureSequences sequences (boost::python::make_tuple (items), caller);
+            if (! sequences.isValid)
+                return false;
+
+            const FeatureSequence<double>& vectors = sequences.sequences[0];
+            if (vectors.numFrames > 0 && vectors.numCoefficients != index->getDimensions())
+            {
+                std::cout << caller << " error: Expected " << index->getDimensions() <<
+                             " values per vector, got " << vectors.numCoefficients << "." << std::endl;
+                return false;
+            }
+
+            values.assign (vectors.data, vectors.data + vectors.numFrames * vectors.numCoefficients);
+            return true;
+        }
+
+        static boost::python::list neighboursToList (const std::vector<FeatureIndex::Neighbour>& neighbours)
+        {
+            boost::python::list list;
+            for (const auto& neighbour : neighbours)
+                list.append (boost::python::make_tuple (neighbour.id, neighbour.distance));
+            return list;
+        }
+
+        std::unique_ptr<FeatureIndex> index;
+    };
+
+    //==========================================================================
+    // The id columns and centroids are handed out as memoryviews of the
+    // result, which they keep alive.
+    class ClusteringResultWrapper
+    {
+    public:
+        // The Python object of the result, which its views hold on to.
+        typedef boost::python::back_reference<ClusteringResultWrapper&> SelfReference;
+
+        ClusteringResultWrapper (ClusteringResult&& clusteringResult) :
+            result (std::move (clusteringResult))
+        { }
+
+        static boost::python::object wrapperGetRecordIds (SelfReference self)
+        {
+            const ClusteringResult& result = self.get().result;
+            const Py_ssize_t shape[] = { Py_ssize_t (result.recordIds.size()) };
+            return memoryView (self.source(), result.recordIds.data(), "Q", sizeof (uint64), 1, shape);
+        }
+
+        static boost::python::object wrapperGetClusterIds (SelfReference self)
+        {
+            const ClusteringResult& result = self.get().result;
+            const Py_ssize_t shape[] = { Py_ssize_t (result.clusterIds.size()) };
+            return memoryView (self.source(), result.clusterIds.data(), "i", sizeof (int), 1, shape);
+        }
+
+        static boost::python::object wrapperGetCentroids (SelfReference self)
+        {
+            const ClusteringResult& result = self.get().result;
+            const Py_ssize_t shape[] = { Py_ssize_t (result.clusterSizes.size()), Py_ssize_t (result.dimensions) };
+            return memoryView (self.source(), result.centroids.data(), "f", sizeof (float), 2, shape);
+        }
+
+        boost::python::list wrapperGetClusterSizes()
+        {
+            return vectorToList (result.clusterSizes);
+        }
+
+        double wrapperGetInertia()
+        {
+            return result.inertia;
+        }
+
+        int wrapperGetNumIterations()
+        {
+            return result.numIterations;
+        }
+
+        boost::python::list wrapperSampleClusters (int perCluster, unsigned long long seed)
+        {
+            return vectorToList (FeatureClustering::sampleClusters (result, size_t (jmax (0, perCluster)), seed));
+        }
+
+    private:
+        ClusteringResult result;
+    };
+
+    ClusteringResultWrapper* clusterDataset (const DatasetReaderWrapper& reader,
+                                             const ClusteringSettings&   settings)
+    {
+        return new ClusteringResultWrapper (FeatureClustering::cluster (reader, settings));
+    }
+
+    // A float32 buffer of shape [N, D] is read in place, anything else that
+    // feature_distance takes is read as float64.
+    ClusteringResultWrapper* clusterFeatures (boost::python::object     vectors,
+                                              boost::python::object     ids,
+                                              const ClusteringSettings& settings)
+    {
+        std::vector<uint64> recordIds;
+        if (! ids.is_none())
+            for (int i = 0; i < boost::python::len (ids); ++i)
+                recordIds.push_back (boost::python::extract<unsigned long long> (ids[i]));
+
+        auto run = [&] (const size_t numVectors, const size_t dimensions, const FeatureClustering::VectorSource& source)
+        {
+            if (recordIds.empty())
+                for (size_t i = 0; i < numVectors; ++i)
+                    recordIds.push_back (i);
+
+            if (recordIds.size() != numVectors)
+            {
+                std::cout << "cluster_features error: There are " << recordIds.size() <<
+                             " ids for " << numVectors << " vectors." << std::endl;
+                return new ClusteringResultWrapper (ClusteringResult());
+            }
+            return new ClusteringResultWrapper (FeatureClustering::cluster (source, recordIds, dimensions, settings));
+        };
+
+        Py_buffer view;
+        if (PyObject_CheckBuffer (vectors.ptr())
+             && PyObject_GetBuffer (vectors.ptr(), &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == 0)
+        {
+            const String format (view.format != nullptr ? view.format : "B");
+            if (view.ndim == 2 && format.getLastCharacter() == 'f')
+            {
+                const float* values = static_cast<const float*> (view.buf);
+                const size_t dimensions = size_t (view.shape[1]);
+                ClusteringResultWrapper* result = run (size_t (view.shape[0]), dimensions, [&] (size_t index, float* vector)
+                {
+                    std::copy (values + index * dimensions, values + (index + 1) * dimensions, vector);
+                });
+                PyBuffer_Release (&view);
+                return result;
+            }
+            PyBuffer_Release (&view);
+        }
+        PyErr_Clear();
+
+        PythonFeatureSequences sequences (boost::python::make_tuple (vectors), "cluster_features");
+        if (! sequences.isValid)
+            return new ClusteringResultWrapper (ClusteringResult());
+
+        const FeatureSequence<double>& values = sequences.sequences[0];
+        return run (values.numFrames, values.numCoefficients, [&] (size_t index, float* vector)
+        {
+            const double* row = values.data + index * values.numCoefficients;
+            std::copy (row, row + values.numCoefficients, vector);
+        });
+    }
+
+    //==========================================================================
+    boost::python::list constraintGetWeights (const ParameterConstraint& constraint)
+    {
+        boost::python::list list;
+        for (const float weight : constraint.weights)
+            list.append (weight);
+        return list;
+    }
+
+    void constraintSetWeights (ParameterConstraint& constraint, boost::python::list weights)
+    {
+        constraint.weights.clear();
+        for (int i = 0; i < boost::python::len (weights); ++i)
+            constraint.weights.push_back (boost::python::extract<float> (weights[i]));
+    }
+
+    float constraintsApply (const PatchConstraints& constraints, int index, float value)
+    {
+        return constraints.apply (index, value);
+    }
+
+    std::string constraintsToJSON (const PatchConstraints& constraints)
+    {
+        return constraints.toJSON().toStdString();
+    }
+
+    bool constraintsFromJSON (PatchConstraints& constraints, const std::string& json)
+    {
+        return constraints.fromJSON (String (json));
+    }
+
+    //==========================================================================
+    class SensitivityAnalysisWrapper : public SensitivityAnalysis
+    {
+    public:
+        SensitivityAnalysisWrapper (RenderPoolWrapper& pool, const RenderSettings& settings) :
+            SensitivityAnalysis (pool, settings)
+        { }
+
+        void wrapperSetBasePatch (boost::python::list patch)
+        {
+            SensitivityAnalysis::setBasePatch (listOfTuplesToPluginPatch (patch));
+        }
+
+        boost::python::list wrapperGetBasePatch()
+        {
+            return pluginPatchToListOfTuples (SensitivityAnalysis::getBasePatch());
+        }
+
+        boost::python::list wrapperAnalyse (boost::python::list parameterIndices,
+                                            int                 numTrajectories,
+                                            int                 numLevels,
+                                            unsigned long long  seed,
+                                            int                 numBootstrapSamples,
+                                            double              confidence)
+        {
+            std::vector<int> indices;
+            for (int i = 0; i < boost::python::len (parameterIndices); ++i)
+                indices.push_back (boost::python::extract<int> (parameterIndices[i]));
+
+            results = SensitivityAnalysis::analyse (indices, numTrajectories, numLevels, seed,
+                                                    numBootstrapSamples, confidence);
+
+            boost::python::list list;
+            for (const auto& result : results)
+            {
+                boost::python::dict sensitivity;
+                sensitivity["index"] = result.index;
+                sensitivity["mean_effect"] = result.meanEffect;
+                sensitivity["standard_deviation"] = result.standardDeviation;
+                sensitivity["lower_bound"] = result.lowerBound;
+                sensitivity["upper_bound"] = result.upperBound;
+                list.append (sensitivity);
+            }
+            return list;
+        }
+
+        PatchConstraints wrapperGetInertParameterConstraints (double threshold)
+        {
+            return SensitivityAnalysis::getInertParameterConstraints (results, threshold);
+        }
+
+    private:
+        std::vector<ParameterSensitivity> results;
+    };
+
+    //==========================================================================
+    class SoundMatcherWrapper : public SoundMatcher
+    {
+    public:
+        SoundMatcherWrapper (RenderPoolWrapper& pool, const RenderSettings& settings) :
+            SoundMatcher (pool, settings),
+            renderPool (pool)
+        { }
+
+        void wrapperSetTargetMFCC (boost::python::list frames)
+        {
+            MFCCFeatures features;
+            for (int i = 0; i < boost::python::len (frames); ++i)
+            {
+                boost::python::list frame = boost::python::extract<boost::python::list> (frames[i]);
+                std::array<double, 13> coefficients {};
+                for (int j = 0; j < std::min (13, int (boost::python::len (frame))); ++j)
+                    coefficients[size_t (j)] = boost::python::extract<double> (frame[j]);
+                features.push_back (coefficients);
+            }
+            SoundMatcher::setTarget (features);
+        }
+
+        bool wrapperSetTargetAudio (boost::python::list audio)
+        {
+            std::vector<float> samples;
+            samples.reserve (size_t (boost::python::len (audio)));
+            for (int i = 0; i < boost::python::len (audio); ++i)
+                samples.push_back (boost::python::extract<float> (audio[i]));
+            return SoundMatcher::setTargetAudio (samples);
+        }
+
+        void wrapperSetConstraints (const PatchConstraints& constraints)
+        {
+            SoundMatcher::getGenerator().setConstraints (constraints);
+        }
+
+        void wrapperConstrainToParameterSteps()
+        {
+            SoundMatcher::getGenerator().constrainToParameterSteps (renderPool.getEngine (0));
+        }
+
+        boost::python::list wrapperMatch (const MatchSettings& settings,
+                                          boost::python::object onGeneration)
+        {
+            ProgressCallback callback;
+            if (! onGeneration.is_none())
+            {
+                callback = [&] (int generation, double distance, const PluginPatch& patch)
+                {
+                    const ScopedGILAcquire gil;
+                    boost::python::object result = onGeneration (generation, distance,
+                                                                 pluginPatchToListOfTuples (patch));
+                    return result.is_none() || bool (boost::python::extract<bool> (result));
+                };
+            }
+
+            std::vector<MatchCandidate> candidates;
+            {
+                const ScopedGILRelease release;
+                candidates = SoundMatcher::match (settings, callback);
+            }
+
+            boost::python::list list;
+            for (const auto& candidate : candidates)
+                list.append (boost::python::make_tuple (pluginPatchToListOfTuples (candidate.patch),
+                                                        candidate.distance));
+            return list;
+        }
+
+    private:
+        RenderPool& renderPool;
+    };
+
+    //==========================================================================
+    class NoveltySearchWrapper : public NoveltySearch
+    {
+    public:
+        NoveltySearchWrapper (RenderPoolWrapper& pool, const RenderSettings& settings) :
+            NoveltySearch (pool, settings),
+            renderPool (pool)
+        { }
+
+        void wrapperSetConstraints (const PatchConstraints& constraints)
+        {
+            NoveltySearch::getGenerator().setConstraints (constraints);
+        }
+
+        void wrapperConstrainToParameterSteps()
+        {
+            NoveltySearch::getGenerator().constrainToParameterSteps (renderPool.getEngine (0));
+        }
+
+        // Pairs of patch and RenderResult, in the order the patches were made.
+        boost::python::list wrapperRun (int numPatches, const NoveltySettings& settings)
+        {
+            std::vector<RenderResult> results (size_t (std::max (0, numPatches)));
+            std::vector<PluginPatch> patches;
+            {
+                const ScopedGILRelease release;
+                patches = NoveltySearch::run (results.size(), settings, [&] (size_t index, const PluginPatch&, RenderResult&& result)
+                {
+                    results[index] = std::move (result);
+                });
+            }
+
+            boost::python::list list;
+            for (size_t i = 0; i < patches.size(); ++i)
+                list.append (boost::python::make_tuple (pluginPatchToListOfTuples (patches[i]),
+                                                        RenderResultWrapper (std::move (results[i]))));
+            return list;
+        }
+
+        // Renders straight into a dataset, record i gets the id firstRecordId + i.
+        int wrapperRunToDataset (int                    numPatches,
+                                 const NoveltySettings& settings,
+                                 DatasetWriterWrapper&  writer,
+                                 unsigned long long     firstRecordId)
+        {
+            const ScopedGILRelease release;
+            return int (NoveltySearch::run (size_t (std::max (0, numPatches)), settings,
+                                            [&] (size_t index, const PluginPatch& patch, RenderResult&& result)
+                                            {
+                                                writer.add (uint64 (firstRecordId + index), patch, std::move (result));
+                                            }).size());
+        }
+
+    private:
+        RenderPool& renderPool;
+    };
+
+    //==========================================================================
+    // Runs without the GIL, so stop() can be called from another thread.
+    bool runJob (JobRunner& runner)
+    {
+        const ScopedGILRelease release;
+        return runner.run();
+    }
+
+    //==========================================================================
+    class PatchGeneratorWrapper : public PatchGenerator
+    {
+    public:
+        PatchGeneratorWrapper (RenderEngine& engine) :
+            PatchGenerator (engine)
+        { }
+
+        PatchGeneratorWrapper (RenderEngine& engine, unsigned long long seed) :
+            PatchGenerator (engine, seed)
+        { }
+
+        void wrapperConstrainToParameterSteps (RenderEngineWrapper& engine)
+        {
+            PatchGenerator::constrainToParameterSteps (engine);
+        }
+
+        boost::python::tuple wrapperGetRandomParameter (int index)
+        {
+            return parameterToTuple (PatchGenerator::getRandomParameter (index));
+        }
+
+        boost::python::list wrapperGetRandomPatch()
+        {
+            return pluginPatchToListOfTuples (PatchGenerator::getRandomPatch());
+        }
+
+        boost::python::list wrapperGetSeededPatch (unsigned long long seed,
+                                                   unsigned long long index)
+        {
+            return pluginPatchToListOfTuples (PatchGenerator::getRandomPatch (seed, index));
+        }
+
+        boost::python::list wrapperGetRandomPatches (unsigned long long seed,
+                                                     unsigned long long firstIndex,
+                                                     int                numPatches)
+        {
+            boost::python::list list;
+            for (const auto& patch : PatchGenerator::getRandomPatches (seed, firstIndex,
+                                                                       size_t (std::max (0, numPatches))))
+                list.append (pluginPatchToListOfTuples (patch));
+            return list;
+        }
+
+        boost::python::list wrapperGetPatchFromValues (boost::python::list values)
+        {
+            std::vector<float> row (PatchGenerator::getNumParameters(), 0.0f);
+            for (int i = 0; i < std::min (int (row.size()), int (boost::python::len (values))); ++i)
+                row[size_t (i)] = boost::python::extract<float> (values[i]);
+            return pluginPatchToListOfTuples (PatchGenerator::getPatch (row.data()));
+        }
+
+        boost::python::list wrapperGetPatches (const PatchSampler& sampler,
+                                               unsigned long long  firstIndex,
+                                               int                 numPatches)
+        {
+            boost::python::list list;
+            if (size_t (sampler.getNumParameters()) != PatchGenerator::getNumParameters())
+            {
+                std::cout << "PatchGenerator::get_patches error: The sampler has " <<
+                             sampler.getNumParameters() << " parameters, the plugin " <<
+                             PatchGenerator::getNumParameters() << "." << std::endl;
+                return list;
+            }
+
+            for (const auto& patch : PatchGenerator::getPatches (sampler, firstIndex,
+                                                                 size_t (std::max (0, numPatches))))
+                list.append (pluginPatchToListOfTuples (patch));
+            return list;
+        }
+
+        // A list of patches, or a 2D float32 buffer of values in this
+        // generator's parameter order, read in place.
+        PatchMatrixWrapper* wrapperGetPatchMatrix (boost::python::object patches)
+        {
+            Py_buffer view;
+            if (PyObject_CheckBuffer (patches.ptr())
+                 && PyObject_GetBuffer (patches.ptr(), &view, PyBUF_C_CONTIGUOUS | PyBUF_FORMAT) == 0)
+            {
+                const String format (view.format != nullptr ? view.format : "B");
+                const bool isMatrix = view.ndim == 2 && format.getLastCharacter() == 'f'
+                                       && size_t (view.shape[1]) == PatchGenerator::getNumParameters();
+                PatchMatrix matrix;
+                if (isMatrix)
+                    matrix = PatchGenerator::getPatchMatrix (static_cast<const float*> (view.buf), size_t (view.shape[0]));
+                else
+                    std::cout << "PatchGenerator::get_patch_matrix error: Buffers have to be float32 with " <<
+                                 PatchGenerator::getNumParameters() << " columns." << std::endl;
+
+                PyBuffer_Release (&view);
+                return new PatchMatrixWrapper (std::move (matrix));
+            }
+            PyErr_Clear();
+
+            return new PatchMatrixWrapper (PatchGenerator::getPatchMatrix (objectToPluginPatches (patches)));
+        }
+
+        PatchMatrixWrapper* wrapperMutate (const PatchMatrixWrapper& parents,
+                                           int                       numChildren,
+                                           int                       numMutated,
+                                           float                     strength,
+                                           unsigned long long        seed)
+        {
+            return new PatchMatrixWrapper (PatchGenerator::mutate (parents.matrix, size_t (std::max (0, numChildren)),
+                                                                   numMutated, strength, seed));
+        }
+
+        PatchMatrixWrapper* wrapperCrossover (const PatchMatrixWrapper& mothers,
+                                              const PatchMatrixWrapper& fathers,
+                                              unsigned long long        seed)
+        {
+            return new PatchMatrixWrapper (PatchGenerator::crossover (mothers.matrix, fathers.matrix, seed));
+        }
+
+        PatchMatrixWrapper* wrapperInterpolate (boost::python::list from,
+                                                boost::python::list to,
+                                                int                 numSteps,
+                                                InterpolationMode   mode)
+        {
+            return new PatchMatrixWrapper (PatchGenerator::interpolate (listOfTuplesToPluginPatch (from),
+                                                                        listOfTuplesToPluginPatch (to),
+                                                                        size_t (std::max (0, numSteps)), mode));
+        }
+    };
+}
+
+//==============================================================================
+BOOST_PYTHON_MODULE(librenderman)
+{
+    using namespace boost::python;
+    using namespace wrap;
+
+    readyBufferExporterType();
+
+   #if PY_VERSION_HEX < 0x03070000
+    // Older interpreters only create the GIL once asked to.
+    PyEval_InitThreads();
+   #endif
+
+    enum_<NormalisationMode>("NormalisationMode")
+    .value("none", NormalisationMode::none)
+    .value("peak", NormalisationMode::peak)
+    .value("rms", NormalisationMode::rms)
+    .value("lufs", NormalisationMode::lufs);
+
+    enum_<AudioPrecision>("AudioPrecision")
+    .value("single_precision", AudioPrecision::singlePrecision)
+    .value("double_precision", AudioPrecision::doublePrecision);
+
+    enum_<AudioFileFormat>("AudioFileFormat")
+    .value("wav16", AudioFileFormat::wav16)
+    .value("wav24", AudioFileFormat::wav24)
+    .value("wav32_float", AudioFileFormat::wav32Float)
+    .value("flac16", AudioFileFormat::flac16)
+    .value("flac24", AudioFileFormat::flac24);
+
+    class_<RenderResultWrapper>("RenderResult", no_init)
+    .def("get_audio_frames", &RenderResultWrapper::wrapperGetAudioFrames)
+    .def("get_mfcc_frames", &RenderResultWrapper::wrapperGetMFCCFrames)
+    .def("get_rms_frames", &RenderResultWrapper::wrapperGetRMSFrames)
+    .def("get_applied_gain", &RenderResultWrapper::wrapperGetAppliedGain)
+    .def("get_fingerprint", &RenderResultWrapper::wrapperGetFingerprint)
+    .def("get_audio_channels", &RenderResultWrapper::wrapperGetAudioChannels);
+
+    class_<RenderEngineWrapper, boost::noncopyable>("RenderEngine", init<int, int, int>())
+    .def("load_plugin", &RenderEngineWrapper::loadPlugin)
+    .def("set_patch", &RenderEngineWrapper::wrapperSetPatch)
+    .def("get_patch", &RenderEngineWrapper::wrapperGetPatch)
+    .def("render_patch", &RenderEngineWrapper::wrapperRenderPatch)
+    .def("render_patch_to_result", &RenderEngineWrapper::wrapperRenderPatchToResult)
+    .def("get_mfcc_frames", &RenderEngineWrapper::wrapperGetMFCCFrames)
+    .def("get_plugin_parameter_size", &RenderEngineWrapper::wrapperGetPluginParameterSize)
+    .def("get_plugin_parameters_description", &RenderEngineWrapper::wrapperGetPluginParametersDescription)
+    .def("get_parameter_info", &RenderEngineWrapper::wrapperGetParameterInfo)
+    .def("get_num_programs", &RenderEngineWrapper::getNumPrograms)
+    .def("get_program_name", &RenderEngineWrapper::wrapperGetProgramName)
+    .def("set_program", &RenderEngineWrapper::setProgram)
+    .def("load_preset_file", &RenderEngineWrapper::loadPresetFile)
+    .def("get_state", &RenderEngineWrapper::wrapperGetState)
+    .def("set_state", &RenderEngineWrapper::wrapperSetState)
+    .def("override_plugin_parameter", &RenderEngineWrapper::overridePluginParameter)
+    .def("remove_overriden_plugin_parameter", &RenderEngineWrapper::removeOverridenParameter)
+    .def("get_audio_frames", &RenderEngineWrapper::wrapperGetAudioFrames)
+    .def("get_rms_frames", &RenderEngineWrapper::wrapperGetRMSFrames)
+    .def("write_to_wav", &RenderEngineWrapper::writeToWav)
+    .def("write_to_file", &RenderEngineWrapper::wrapperWriteToFile)
+    .def("set_normalisation", &RenderEngineWrapper::wrapperSetNormalisation,
+         (boost::python::arg("mode"), boost::python::arg("target"), boost::python::arg("peak_ceiling") = 0.0))
+    .def("get_applied_gain", &RenderEngineWrapper::getAppliedGain)
+    .def("get_fingerprint", &RenderEngineWrapper::getFingerprint)
+    .def("set_retain_channels", &RenderEngineWrapper::setRetainChannels)
+    .def("set_feature_channel", &RenderEngineWrapper::setFeatureChannel)
+    .def("get_audio_channels", &RenderEngineWrapper::wrapperGetAudioChannels)
+    .def("set_audio_precision", &RenderEngineWrapper::setAudioPrecision)
+    .def("set_disk_cache", &RenderEngineWrapper::wrapperSetDiskCache)
+    .def("remove_disk_cache", &RenderEngineWrapper::wrapperRemoveDiskCache)
+    .def("set_memory_cache", &RenderEngineWrapper::wrapperSetMemoryCache)
+    .def("remove_memory_cache", &RenderEngineWrapper::wrapperRemoveMemoryCache)
+    .def("get_render_key", &RenderEngineWrapper::wrapperGetRenderKey);
+
+    class_<DiskCacheWrapper>("DiskCache", init<std::string, long long>())
+    .def("get_size_in_bytes", &DiskCacheWrapper::wrapperGetSizeInBytes)
+    .def("get_num_hits", &DiskCacheWrapper::wrapperGetNumHits)
+    .def("get_num_misses", &DiskCacheWrapper::wrapperGetNumMisses)
+    .def("clear", &DiskCacheWrapper::wrapperClear);
+
+    class_<MemoryCacheWrapper>("MemoryCache", init<int, double, bool>())
+    .def("set_parameter_resolution", &MemoryCacheWrapper::wrapperSetParameterResolution)
+    .def("get_num_entries", &MemoryCacheWrapper::wrapperGetNumEntries)
+    .def("get_num_hits", &MemoryCacheWrapper::wrapperGetNumHits)
+    .def("get_num_misses", &MemoryCacheWrapper::wrapperGetNumMisses)
+    .def("get_hit_rate", &MemoryCacheWrapper::wrapperGetHitRate)
+    .def("reset_counters", &MemoryCacheWrapper::wrapperResetCounters)
+    .def("clear", &MemoryCacheWrapper::wrapperClear);
+
+    class_<AudioWriterWrapper, boost::noncopyable>("AudioWriter", init<int, AudioFileFormat, int>())
+    .def("write", &AudioWriterWrapper::wrapperWrite)
+    .def("wait_until_finished", &AudioWriterWrapper::waitUntilFinished)
+    .def("get_num_written", &AudioWriterWrapper::getNumWritten)
+    .def("get_num_failed", &AudioWriterWrapper::getNumFailed);
+
+    def("write_audio_files", &wrapperWriteAudioFiles);
+
+    class_<RenderPoolWrapper, boost::noncopyable>("RenderPool", init<int, int, int, int>())
+    .def("load_plugin", &RenderPoolWrapper::loadPlugin)
+    .def("get_num_engines", &RenderPoolWrapper::getNumEngines)
+    .def("set_normalisation", &RenderPoolWrapper::wrapperSetNormalisation,
+         (boost::python::arg("mode"), boost::python::arg("target"), boost::python::arg("peak_ceiling") = 0.0))
+    .def("set_audio_precision", &RenderPoolWrapper::wrapperSetAudioPrecision)
+    .def("set_disk_cache", &RenderPoolWrapper::wrapperSetDiskCache)
+    .def("set_memory_cache", &RenderPoolWrapper::wrapperSetMemoryCache)
+    .def("render_patches", &RenderPoolWrapper::wrapperRenderPatches)
+    .def("render_to_dataset", &RenderPoolWrapper::wrapperRenderToDataset)
+    .def("render_grid", &RenderPoolWrapper::wrapperRenderGrid,
+         return_value_policy<manage_new_object>())
+    .def("load_preset_file", &RenderPoolWrapper::wrapperLoadPresetFile)
+    .def("render_programs", &RenderPoolWrapper::wrapperRenderPrograms)
+    .def("render_programs_to_dataset", &RenderPoolWrapper::wrapperRenderProgramsToDataset)
+    .def("render_preset_files", &RenderPoolWrapper::wrapperRenderPresetFiles)
+    .def("render_preset_files_to_dataset", &RenderPoolWrapper::wrapperRenderPresetFilesToDataset);
+
+    class_<DuplicateFilterWrapper>("DuplicateFilter", init<int>())
+    .def("insert_if_unique", &DuplicateFilterWrapper::wrapperInsertIfUnique)
+    .def("contains_near_duplicate", &DuplicateFilterWrapper::wrapperContainsNearDuplicate)
+    .def("clear", &DuplicateFilterWrapper::wrapperClear)
+    .def("size", &DuplicateFilterWrapper::wrapperSize)
+    .def("get_max_distance", &DuplicateFilterWrapper::wrapperGetMaxDistance);
+
+    def("feature_fingerprint", &featureFingerprint);
+    def("fingerprint_distance", &fingerprintDistance);
+
+    class_<DatasetWriterWrapper, boost::noncopyable>("DatasetWriter", init<std::string, std::string, int>())
+    .def("add", &DatasetWriterWrapper::wrapperAdd)
+    .def("flush", &DatasetWriterWrapper::flush)
+    .def("set_duplicate_filter", &DatasetWriterWrapper::wrapperSetDuplicateFilter)
+    .def("remove_duplicate_filter", &DatasetWriterWrapper::wrapperRemoveDuplicateFilter)
+    .def("get_num_duplicates_rejected", &DatasetWriterWrapper::getNumDuplicatesRejected)
+    .def("get_num_records_written", &DatasetWriterWrapper::getNumRecordsWritten)
+    .def("get_num_shards_written", &DatasetWriterWrapper::getNumShardsWritten);
+
+    class_<DatasetReaderWrapper, boost::noncopyable>("DatasetReader", init<std::string, std::string>())
+    .def("get_num_shards", &DatasetReaderWrapper::wrapperGetNumShards)
+    .def("get_num_records", &DatasetReaderWrapper::wrapperGetNumRecords)
+    .def("get_shard_num_records", &DatasetReaderWrapper::wrapperGetShardNumRecords)
+    .def("get_shard_path", &DatasetReaderWrapper::wrapperGetShardPath)
+    .def("get_record_ids", &DatasetReaderWrapper::wrapperGetRecordIds)
+    .def("get_parameter_indices", &DatasetReaderWrapper::wrapperGetParameterIndices)
+    .def("get_patches", &DatasetReaderWrapper::wrapperGetPatches)
+    .def("get_audio", &DatasetReaderWrapper::wrapperGetAudio)
+    .def("get_mfcc", &DatasetReaderWrapper::wrapperGetMFCC)
+    .def("get_rms", &DatasetReaderWrapper::wrapperGetRMS);
+
+    enum_<PatchSource>("PatchSource")
+    .value("uniform", PatchSource::uniform)
+    .value("sobol", PatchSource::sobol)
+    .value("latin_hypercube", PatchSource::latinHypercube);
+
+    class_<RenderSettings>("RenderSettings")
+    .def_readwrite("midi_note", &RenderSettings::midiNote)
+    .def_readwrite("midi_velocity", &RenderSettings::midiVelocity)
+    .def_readwrite("note_length", &RenderSettings::noteLength)
+    .def_readwrite("render_length", &RenderSettings::renderLength);
+
+    class_<JobSpec>("JobSpec")
+    .def_readwrite("plugin_path", &JobSpec::pluginPath)
+    .def_readwrite("patch_source", &JobSpec::patchSource)
+    .def_readwrite("seed", &JobSpec::seed)
+    .def_readwrite("count", &JobSpec::count)
+    .def_readwrite("output_directory", &JobSpec::outputDirectory)
+    .def_readwrite("prefix", &JobSpec::prefix)
+    .def_readwrite("render", &JobSpec::render)
+    .def_readwrite("num_engines", &JobSpec::numEngines)
+    .def_readwrite("sample_rate", &JobSpec::sampleRate)
+    .def_readwrite("buffer_size", &JobSpec::bufferSize)
+    .def_readwrite("fft_size", &JobSpec::fftSize)
+    .def_readwrite("records_per_shard", &JobSpec::recordsPerShard)
+    .def_readwrite("journal_sync_interval", &JobSpec::journalSyncInterval)
+    .def_readwrite("constraints_path", &JobSpec::constraintsPath)
+    .def_readwrite("duplicate_threshold", &JobSpec::duplicateThreshold);
+
+    class_<SensitivityAnalysisWrapper, boost::noncopyable>("SensitivityAnalysis",
+                                                           init<RenderPoolWrapper&, RenderSettings>()[with_custodian_and_ward<1, 2>()])
+    .def("set_base_patch", &SensitivityAnalysisWrapper::wrapperSetBasePatch)
+    .def("get_base_patch", &SensitivityAnalysisWrapper::wrapperGetBasePatch)
+    .def("analyse", &SensitivityAnalysisWrapper::wrapperAnalyse)
+    .def("get_inert_parameter_constraints", &SensitivityAnalysisWrapper::wrapperGetInertParameterConstraints);
+
+    enum_<DistanceMetric>("DistanceMetric")
+    .value("euclidean", DistanceMetric::euclidean)
+    .value("cosine", DistanceMetric::cosine)
+    .value("dtw", DistanceMetric::dtw);
+
+    def("feature_distance", &featureDistance);
+    def("feature_distances", &featureDistances);
+    def("feature_distance_matrix", &featureDistanceMatrix);
+    def("feature_summary", &featureSummary);
+
+    class_<FeatureIndexWrapper, boost::noncopyable>("FeatureIndex", init<int, int, int, unsigned long long>())
+    .def("add", &FeatureIndexWrapper::wrapperAdd)
+    .def("add_batch", &FeatureIndexWrapper::wrapperAddBatch)
+    .def("add_shards", &FeatureIndexWrapper::wrapperAddShards)
+    .def("add_renders", &FeatureIndexWrapper::wrapperAddRenders)
+    .def("search", &FeatureIndexWrapper::wrapperSearch)
+    .def("search_batch", &FeatureIndexWrapper::wrapperSearchBatch)
+    .def("size", &FeatureIndexWrapper::wrapperSize)
+    .def("get_dimensions", &FeatureIndexWrapper::wrapperGetDimensions)
+    .def("is_read_only", &FeatureIndexWrapper::wrapperIsReadOnly)
+    .def("save", &FeatureIndexWrapper::wrapperSave)
+    .def("load", &FeatureIndexWrapper::wrapperLoad);
+
+    class_<ClusteringSettings>("ClusteringSettings")
+    .def_readwrite("num_clusters", &ClusteringSettings::numClusters)
+    .def_readwrite("batch_size", &ClusteringSettings::batchSize)
+    .def_readwrite("max_iterations", &ClusteringSettings::maxIterations)
+    .def_readwrite("tolerance", &ClusteringSettings::tolerance)
+    .def_readwrite("seed", &ClusteringSettings::seed)
+    .def_readwrite("num_threads", &ClusteringSettings::numThreads);
+
+    class_<ClusteringResultWrapper, boost::noncopyable>("ClusteringResult", no_init)
+    .def("get_record_ids", &ClusteringResultWrapper::wrapperGetRecordIds)
+    .def("get_cluster_ids", &ClusteringResultWrapper::wrapperGetClusterIds)
+    .def("get_centroids", &ClusteringResultWrapper::wrapperGetCentroids)
+    .def("get_cluster_sizes", &ClusteringResultWrapper::wrapperGetClusterSizes)
+    .def("get_inertia", &ClusteringResultWrapper::wrapperGetInertia)
+    .def("get_num_iterations", &ClusteringResultWrapper::wrapperGetNumIterations)
+    .def("sample_clusters", &ClusteringResultWrapper::wrapperSampleClusters);
+
+    def("cluster_dataset", &clusterDataset, return_value_policy<manage_new_object>());
+    def("cluster_features", &clusterFeatures, return_value_policy<manage_new_object>());
+
+    enum_<MatchAlgorithm>("MatchAlgorithm")
+    .value("cmaes", MatchAlgorithm::cmaes)
+    .value("genetic", MatchAlgorithm::genetic);
+
+    class_<MatchSettings>("MatchSettings")
+    .def_readwrite("algorithm", &MatchSettings::algorithm)
+    .def_readwrite("population_size", &MatchSettings::populationSize)
+    .def_readwrite("max_generations", &MatchSettings::maxGenerations)
+    .def_readwrite("seed", &MatchSettings::seed)
+    .def_readwrite("target_distance", &MatchSettings::targetDistance)
+    .def_readwrite("num_best", &MatchSettings::numBest)
+    .def_readwrite("metric", &MatchSettings::metric)
+    .def_readwrite("band", &MatchSettings::band)
+    .def_readwrite("step_size", &MatchSettings::stepSize)
+    .def_readwrite("num_elites", &MatchSettings::numElites)
+    .def_readwrite("tournament_size", &MatchSettings::tournamentSize)
+    .def_readwrite("crossover_rate", &MatchSettings::crossoverRate)
+    .def_readwrite("mutation_rate", &MatchSettings::mutationRate)
+    .def_readwrite("mutation_strength", &MatchSettings::mutationStrength);
+
+    class_<SoundMatcherWrapper, boost::noncopyable>("SoundMatcher",
+                                                    init<RenderPoolWrapper&, RenderSettings>()[with_custodian_and_ward<1, 2>()])
+    .def("set_target_mfcc", &SoundMatcherWrapper::wrapperSetTargetMFCC)
+    .def("set_target_audio", &SoundMatcherWrapper::wrapperSetTargetAudio)
+    .def("set_constraints", &SoundMatcherWrapper::wrapperSetConstraints)
+    .def("constrain_to_parameter_steps", &SoundMatcherWrapper::wrapperConstrainToParameterSteps)
+    .def("match", &SoundMatcherWrapper::wrapperMatch, (boost::python::arg("settings"), boost::python::arg("on_generation") = boost::python::object()))
+    .def("stop", &SoundMatcher::stop);
+
+    class_<NoveltySettings>("NoveltySettings")
+    .def_readwrite("batch_size", &NoveltySettings::batchSize)
+    .def_readwrite("num_neighbours", &NoveltySettings::numNeighbours)
+    .def_readwrite("tournament_size", &NoveltySettings::tournamentSize)
+    .def_readwrite("exploration_rate", &NoveltySettings::explorationRate)
+    .def_readwrite("num_mutated", &NoveltySettings::numMutated)
+    .def_readwrite("mutation_strength", &NoveltySettings::mutationStrength)
+    .def_readwrite("seed", &NoveltySettings::seed);
+
+    class_<NoveltySearchWrapper, boost::noncopyable>("NoveltySearch",
+                                                     init<RenderPoolWrapper&, RenderSettings>()[with_custodian_and_ward<1, 2>()])
+    .def("set_constraints", &NoveltySearchWrapper::wrapperSetConstraints)
+    .def("constrain_to_parameter_steps", &NoveltySearchWrapper::wrapperConstrainToParameterSteps)
+    .def("run", &NoveltySearchWrapper::wrapperRun)
+    .def("run_to_dataset", &NoveltySearchWrapper::wrapperRunToDataset)
+    .def("stop", &NoveltySearch::stop)
+    .def("get_archive_size", &NoveltySearch::getArchiveSize)
+    .def("clear_archive", &NoveltySearch::clearArchive);
+
+    class_<JobRunner, boost::noncopyable>("JobRunner", init<JobSpec>())
+    .def("run", &runJob)
+    .def("stop", &JobRunner::stop)
+    .def("get_num_completed", &JobRunner::getNumCompleted)
+    .def("get_num_rendered_this_run", &JobRunner::getNumRenderedThisRun)
+    .def("get_num_duplicates_this_run", &JobRunner::getNumDuplicatesThisRun);
+
+    class_<PatchGeneratorWrapper>("PatchGenerator", init<RenderEngineWrapper&>())
+    .def(init<RenderEngineWrapper&, unsigned long long>())
+    .def("get_random_parameter", &PatchGeneratorWrapper::wrapperGetRandomParameter)
+    .def("get_random_patch", &PatchGeneratorWrapper::wrapperGetRandomPatch)
+    .def("get_seeded_patch", &PatchGeneratorWrapper::wrapperGetSeededPatch)
+    .def("get_random_patches", &PatchGeneratorWrapper::wrapperGetRandomPatches)
+    .def("get_patch_from_values", &PatchGeneratorWrapper::wrapperGetPatchFromValues)
+    .def("get_patches", &PatchGeneratorWrapper::wrapperGetPatches)
+    .def("set_constraints", &PatchGeneratorWrapper::setConstraints)
+    .def("constrain_to_parameter_steps", &PatchGeneratorWrapper::wrapperConstrainToParameterSteps)
+    .def("get_patch_matrix", &PatchGeneratorWrapper::wrapperGetPatchMatrix, return_value_policy<manage_new_object>())
+    .def("mutate", &PatchGeneratorWrapper::wrapperMutate, return_value_policy<manage_new_object>())
+    .def("crossover", &PatchGeneratorWrapper::wrapperCrossover, return_value_policy<manage_new_object>())
+    .def("interpolate", &PatchGeneratorWrapper::wrapperInterpolate, return_value_policy<manage_new_object>());
+
+    enum_<InterpolationMode>("InterpolationMode")
+    .value("linear", InterpolationMode::linear)
+    .value("spherical", InterpolationMode::spherical);
+
+    class_<RenderGridWrapper, boost::noncopyable>("RenderGrid", no_init)
+    .def("get_audio", &RenderGridWrapper::wrapperGetAudio)
+    .def("get_notes", &RenderGridWrapper::wrapperGetNotes)
+    .def("get_velocities", &RenderGridWrapper::wrapperGetVelocities)
+    .def("get_num_samples", &RenderGridWrapper::wrapperGetNumSamples);
+
+    class_<PatchMatrixWrapper, boost::noncopyable>("PatchMatrix", no_init)
+    .def("get_values", &PatchMatrixWrapper::wrapperGetValues)
+    .def("get_num_patches", &PatchMatrixWrapper::wrapperGetNumPatches)
+    .def("get_num_parameters", &PatchMatrixWrapper::wrapperGetNumParameters)
+    .def("get_parameter_indices", &PatchMatrixWrapper::wrapperGetParameterIndices)
+    .def("get_patches", &PatchMatrixWrapper::wrapperGetPatches);
+
+    enum_<ParameterDistribution>("ParameterDistribution")
+    .value("uniform", ParameterDistribution::uniform)
+    .value("normal", ParameterDistribution::normal)
+    .value("logarithmic", ParameterDistribution::logarithmic)
+    .value("categorical", ParameterDistribution::categorical);
+
+    class_<ParameterConstraint>("ParameterConstraint")
+    .def_readwrite("minimum", &ParameterConstraint::minimum)
+    .def_readwrite("maximum", &ParameterConstraint::maximum)
+    .def_readwrite("num_steps", &ParameterConstraint::numSteps)
+    .def_readwrite("distribution", &ParameterConstraint::distribution)
+    .def_readwrite("mean", &ParameterConstraint::mean)
+    .def_readwrite("standard_deviation", &ParameterConstraint::standardDeviation)
+    .add_property("weights", &constraintGetWeights, &constraintSetWeights)
+    .def_readwrite("is_fixed", &ParameterConstraint::isFixed)
+    .def_readwrite("fixed_value", &ParameterConstraint::fixedValue);
+
+    class_<PatchConstraints>("PatchConstraints")
+    .def("set_constraint", &PatchConstraints::setConstraint)
+    .def("remove_constraint", &PatchConstraints::removeConstraint)
+    .def("clear", &PatchConstraints::clear)
+    .def("is_empty", &PatchConstraints::isEmpty)
+    .def("apply", &constraintsApply)
+    .def("to_json", &constraintsToJSON)
+    .def("from_json", &constraintsFromJSON)
+    .def("save", &PatchConstraints::save)
+    .def("load", &PatchConstraints::load);
+
+    class_<PatchSampler, boost::noncopyable>("PatchSampler", no_init)
+    .def("generate", &samplerGenerate)
+    .def("generate_into", &samplerGenerateInto)
+    .def("get_num_parameters", &PatchSampler::getNumParameters);
+
+    class_<UniformSampler, bases<PatchSampler>, boost::noncopyable>("UniformSampler", init<int, unsigned long long>());
+
+    class_<SobolSampler, bases<PatchSampler>, boost::noncopyable>("SobolSampler", init<int, unsigned long long, bool>());
+
+    class_<LatinHypercubeSampler, bases<PatchSampler>, boost::noncopyable>("LatinHypercubeSampler",
+                                                                           init<int, unsigned long long, unsigned long long>());
 }